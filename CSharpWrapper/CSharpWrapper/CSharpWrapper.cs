@@ -93,6 +93,7 @@ namespace CSharpWrapper
 		
 		// trajectory info
 		public int current_traj;
+		public int fifo_size;
 		
 		//button states
 		public bool power_button;
@@ -108,6 +109,17 @@ namespace CSharpWrapper
 		public double left_right;
 		public double rotate;
 		
+		// singularity information (GetSingularityVector)
+		public int singularity_count;
+		public int singularity_theta_count;
+		public double singularity_distance;
+		public double singularity_theta_distance;
+		public double repulsion_x;
+		public double repulsion_y;
+		public double repulsion_z;
+		public double repulsion_theta_x;
+		public double repulsion_theta_y;
+		public double repulsion_theta_z;
 	
     }
 	
@@ -119,11 +131,14 @@ namespace CSharpWrapper
 		private CVectorEuler setposevalue  = new CVectorEuler();
 		private float []addposevalue = new float[6];
 		private float []addjointvalue = new float[6];
+		private float []addfingervalue = new float[3];
 		private CTrajectoryInfo jointvaluetrajectory = new CTrajectoryInfo();
 		private CTrajectoryInfo posevaluetrajectory  = new CTrajectoryInfo();
 		private CPointsTrajectory m_JointsTrajectory = new CPointsTrajectory();
 		private CPointsTrajectory m_PoseTrajectory = new CPointsTrajectory();
 		private CPointsTrajectory m_fingerTrajectory = new CPointsTrajectory();
+		// the emergency stop of the driver erases and sends from another thread than the one streaming the trajectories
+		private readonly object m_TrajectoryLock = new object();
 		private CJoystickValue m_Cmd;
 		private CPosition positionLive = new CPosition();
 		//private CPosition positionError = new CPosition();
@@ -138,6 +153,11 @@ namespace CSharpWrapper
 		private CAngularInfo 		current_info;
 		private CCartesianInfo 		pose_info;
 		private CInfoFIFOTrajectory trajectory_info;
+		private CSingularityVector 	singularity_info;
+		
+		// speed limit of cartesian trajectories, 0 for the default of the arm
+		private float m_CartesianLinearSpeed = 0.0f;
+		private float m_CartesianAngularSpeed = 0.0f;
 		
 		
 		public MyJacoArm(string key)
@@ -283,6 +303,7 @@ namespace CSharpWrapper
 						current_info 		= m_Arm.ControlManager.GetCurrentAngularInfo();
 						pose_info 			= m_Arm.ControlManager.GetCommandCartesianInfo();
 						trajectory_info		= m_Arm.ControlManager.GetInfoFIFOTrajectory();
+						singularity_info	= m_Arm.ControlManager.GetSingularityVector();
 						positionLive = m_Arm.DiagnosticManager.DataManager.GetPositionLogLiveFromJaco();
 	
 				
@@ -301,23 +322,14 @@ namespace CSharpWrapper
 						m_State.rotate = positionLive.JoystickValue.Rotate;
 						
 											    
-						// Based on Observation of actual model	
 						// getting joints angles
-						// Normailising the joint angle (-180 to +180)
-						m_State.shoulder_yaw.angle 		= Normalize( ((joint_info.Joint1) - 180.0) * Constants.DTR );
-						m_State.shoulder_pitch.angle 	= Normalize( ((joint_info.Joint2) - 270.0) * Constants.DTR );
-						m_State.elbow_pitch.angle 		= Normalize( ((joint_info.Joint3) - 90.0 ) * Constants.DTR );	
-						m_State.elbow_roll.angle 		= Normalize( ((joint_info.Joint4) - 180.0) * Constants.DTR );
-						m_State.wrist_roll.angle 		= Normalize( ((joint_info.Joint5) - 180.0) * Constants.DTR );
-						m_State.hand_roll.angle 		= Normalize( ((joint_info.Joint6) - 260.0) * Constants.DTR );					
-					
-						// based on DH model provided by Kinova
-						/*m_State.shoulder_yaw.angle 		= (180.0 - (joint_info.Joint1)) * Constants.DTR;
-						m_State.shoulder_pitch.angle 	= ((joint_info.Joint2) - 270.0) * Constants.DTR;
-						m_State.elbow_pitch.angle 		= (90.0 - (joint_info.Joint3))  * Constants.DTR;
-						m_State.elbow_roll.angle 		= (180.0 - (joint_info.Joint4)) * Constants.DTR;
-						m_State.wrist_roll.angle 		= (180.0 - (joint_info.Joint5)) * Constants.DTR;
-						m_State.hand_roll.angle 		= (260.0 - (joint_info.Joint6)) * Constants.DTR;*/
+						// in actuator degrees, the joint model (offsets, directions, wrapping) is JacoCalibration on the C++ side
+						m_State.shoulder_yaw.angle 		= joint_info.Joint1;
+						m_State.shoulder_pitch.angle 	= joint_info.Joint2;
+						m_State.elbow_pitch.angle 		= joint_info.Joint3;
+						m_State.elbow_roll.angle 		= joint_info.Joint4;
+						m_State.wrist_roll.angle 		= joint_info.Joint5;
+						m_State.hand_roll.angle 		= joint_info.Joint6;
 					
 						// getting joint current	
 						current_info = m_Arm.ControlManager.GetCurrentAngularInfo();				
@@ -355,6 +367,19 @@ namespace CSharpWrapper
 											
 						// getting the trajectory info
 						m_State.current_traj = trajectory_info.StillInFIFO;							
+						m_State.fifo_size = trajectory_info.MaxSize;
+						
+						// getting the singularity info
+						m_State.singularity_count 			= singularity_info.NbSingularity;
+						m_State.singularity_theta_count 	= singularity_info.NbSingularityTheta;
+						m_State.singularity_distance 		= singularity_info.SingularityDistance;
+						m_State.singularity_theta_distance 	= singularity_info.SingularityThetaDistance;
+						m_State.repulsion_x 		= singularity_info.RepulsionVector.Position[CVectorEuler.COORDINATE_X];
+						m_State.repulsion_y 		= singularity_info.RepulsionVector.Position[CVectorEuler.COORDINATE_Y];
+						m_State.repulsion_z 		= singularity_info.RepulsionVector.Position[CVectorEuler.COORDINATE_Z];
+						m_State.repulsion_theta_x 	= singularity_info.RepulsionVector.Rotation[CVectorEuler.THETA_X];
+						m_State.repulsion_theta_y 	= singularity_info.RepulsionVector.Rotation[CVectorEuler.THETA_Y];
+						m_State.repulsion_theta_z 	= singularity_info.RepulsionVector.Rotation[CVectorEuler.THETA_Z];
     				//}					
 					
 				}
@@ -366,27 +391,7 @@ namespace CSharpWrapper
 				
 		}
 		
-		public double Normalize( double angle )
-		{
-			//Console.Write("angle_old : " + angle);
-			if( angle > Math.PI )
-			{
-				while( angle > Math.PI )
-				{
-					angle -= 2*Math.PI;
-				}
-			}
-			else if( angle < -Math.PI )
-			{
-				while( angle < -Math.PI )
-				{
-					angle += 2*Math.PI;
-				}
-			}			
-			return angle;	
-		}
-		
-		// The "JacoSetJointAngles" function receive all Joint angles in Radians, But robot need joint angles in degree
+		// The "JacoSetJointAngles" function receive all Joint angles in actuator degrees, see JacoCalibration on the C++ side
 		public void JacoSetJointAngles(double j1, double j2, double j3, double j4, double j5, double j6)
 		{	
 			try
@@ -394,29 +399,22 @@ namespace CSharpWrapper
 				//if (m_Arm.JacoIsReady())
 				//{	
 					
-					// Based on Observation of actual model
-					setjointvalue.Angle[0] = (float)(( j1 * Constants.RTD) + 180.0 );
-					setjointvalue.Angle[1] = (float)(( j2 * Constants.RTD) + 270.0 );
-					setjointvalue.Angle[2] = (float)(( j3 * Constants.RTD) + 90.0 ) ;
-					setjointvalue.Angle[3] = (float)(( j4 * Constants.RTD) + 180.0 );
-					setjointvalue.Angle[4] = (float)(( j5 * Constants.RTD) + 180.0 );
-					setjointvalue.Angle[5] = (float)(( j6 * Constants.RTD) + 260.0 ) ;
-					
-					// Based on DH model provided by Kinova
-					/*setjointvalue.Angle[0] = (float)(-j1 * Constants.RTD) + 180.0f ;
-					setjointvalue.Angle[1] = (float)( j2 * Constants.RTD) + 270.0f ;
-					setjointvalue.Angle[2] = (float)(-j3 * Constants.RTD) + 90.0f  ;
-					setjointvalue.Angle[3] = (float)(-j4 * Constants.RTD) + 180.0f ;
-					setjointvalue.Angle[4] = (float)(-j5 * Constants.RTD) + 180.0f ;
-					setjointvalue.Angle[5] = (float)(-j6 * Constants.RTD) + 260.0f ;*/		
-					
+					setjointvalue.Angle[0] = (float)j1;
+					setjointvalue.Angle[1] = (float)j2;
+					setjointvalue.Angle[2] = (float)j3;
+					setjointvalue.Angle[3] = (float)j4;
+					setjointvalue.Angle[4] = (float)j5;
+					setjointvalue.Angle[5] = (float)j6;
 										
 			        jointvaluetrajectory.UserPosition.AnglesJoints = setjointvalue;
 			        jointvaluetrajectory.UserPosition.PositionType = CJacoStructures.PositionType.AngularPosition;				       
 			
-			        m_JointsTrajectory.Add(jointvaluetrajectory);
+					lock (m_TrajectoryLock)
+					{
+			        	m_JointsTrajectory.Add(jointvaluetrajectory);
 			
-			        m_Arm.ControlManager.SendTrajectoryFunctionnality(m_JointsTrajectory); 					
+			        	m_Arm.ControlManager.SendTrajectoryFunctionnality(m_JointsTrajectory);
+					}
 					
 				//}
 			}
@@ -430,7 +428,7 @@ namespace CSharpWrapper
 		
 	
 		
-		public void JacoSetAbsPose(double X, double Y, double Z, double Rx, double Ry, double Rz)
+		public void JacoSetAbsPose(double X, double Y, double Z, double Rx, double Ry, double Rz, double f1, double f2, double f3)
 		{				  
 				try
 				{
@@ -445,10 +443,18 @@ namespace CSharpWrapper
 											
 						posevaluetrajectory.UserPosition.Position     = setposevalue;
 						posevaluetrajectory.UserPosition.PositionType = CJacoStructures.PositionType.CartesianPosition;
+						posevaluetrajectory.UserPosition.HandMode     = CJacoStructures.HandMode.PositionMode;
+						posevaluetrajectory.UserPosition.FingerPosition[0] = (float)f1;
+						posevaluetrajectory.UserPosition.FingerPosition[1] = (float)f2;
+						posevaluetrajectory.UserPosition.FingerPosition[2] = (float)f3;
+						ApplyCartesianSpeedLimit(posevaluetrajectory);
 			        
-						m_PoseTrajectory.Add(posevaluetrajectory);
+						// only this pose, the driver sends it again with a new speed limit near singularities
+						CPointsTrajectory absPoseTrajectory = new CPointsTrajectory();
+						absPoseTrajectory.Add(posevaluetrajectory);
 			
-			        	m_Arm.ControlManager.SendTrajectoryFunctionnality(m_PoseTrajectory);  
+						lock (m_TrajectoryLock)
+			        		m_Arm.ControlManager.SendTrajectoryFunctionnality(absPoseTrajectory);
 					
     				}					
 				}
@@ -456,7 +462,47 @@ namespace CSharpWrapper
 				{
 	    			System.Console.WriteLine("EXCEPTION in JacoSetPose");
 					System.Console.WriteLine(ex.ToString());
-				}					        	
+				}
+		}
+
+		// The "JacoSendJointVelocity" function receive the actuator speeds in deg/s, see JacoCalibration on the C++ side,
+		// and the speeds of the fingers. The arm only keeps a velocity for a short moment, so it has to be sent again every cycle.
+		public void JacoSendJointVelocity(double j1, double j2, double j3, double j4, double j5, double j6, double f1, double f2, double f3)
+		{
+				try
+				{
+					if (m_Arm.JacoIsReady())
+					{
+						CTrajectoryInfo velocityTrajectory = new CTrajectoryInfo();
+						CVectorAngle velocity = new CVectorAngle();
+
+						velocity.Angle[0] = (float)j1;
+						velocity.Angle[1] = (float)j2;
+						velocity.Angle[2] = (float)j3;
+						velocity.Angle[3] = (float)j4;
+						velocity.Angle[4] = (float)j5;
+						velocity.Angle[5] = (float)j6;
+
+						velocityTrajectory.LimitationActive = false;
+						velocityTrajectory.UserPosition.AnglesJoints = velocity;
+						velocityTrajectory.UserPosition.PositionType = CJacoStructures.PositionType.AngularSpeed;
+						velocityTrajectory.UserPosition.HandMode = CJacoStructures.HandMode.VelocityMode;
+						velocityTrajectory.UserPosition.FingerPosition[0] = (float)f1;
+						velocityTrajectory.UserPosition.FingerPosition[1] = (float)f2;
+						velocityTrajectory.UserPosition.FingerPosition[2] = (float)f3;
+
+						CPointsTrajectory velocityPoints = new CPointsTrajectory();
+						velocityPoints.Add(velocityTrajectory);
+
+						lock (m_TrajectoryLock)
+							m_Arm.ControlManager.SendTrajectoryFunctionnality(velocityPoints);
+					}
+				}
+				catch (Exception ex)
+				{
+					System.Console.WriteLine("EXCEPTION in JacoSendJointVelocity");
+					System.Console.WriteLine(ex.ToString());
+				}
 		}
 				
 		public void JacoSetRelPosition(double X, double Y, double Z)
@@ -617,7 +663,8 @@ namespace CSharpWrapper
 		
 		}
 		
-		public void JacoAddJointSpaceTrajectory(double j1, double j2, double j3, double j4, double j5, double j6)
+		// the fingers are moved along with the joints, so a gripper command never has to erase the trajectory
+		public void JacoAddJointSpaceTrajectory(double j1, double j2, double j3, double j4, double j5, double j6, double f1, double f2, double f3)
 		{	
 			try
 			{
@@ -625,15 +672,21 @@ namespace CSharpWrapper
 					
 				//{					
 					
-					// Based on Observation of actual model
-					addjointvalue[0] = (float)(( j1 * Constants.RTD) + 180.0 );
-					addjointvalue[1] = (float)(( j2 * Constants.RTD) + 270.0 );
-					addjointvalue[2] = (float)(( j3 * Constants.RTD) + 90.0 ) ;
-					addjointvalue[3] = (float)(( j4 * Constants.RTD) + 180.0 );
-					addjointvalue[4] = (float)(( j5 * Constants.RTD) + 180.0 );
-					addjointvalue[5] = (float)(( j6 * Constants.RTD) + 260.0 ) ;
-					
-					m_JointsTrajectory.Add(GenerateJointTrajectory(addjointvalue));
+					lock (m_TrajectoryLock)
+					{
+						// actuator degrees, see JacoCalibration on the C++ side
+						addjointvalue[0] = (float)j1;
+						addjointvalue[1] = (float)j2;
+						addjointvalue[2] = (float)j3;
+						addjointvalue[3] = (float)j4;
+						addjointvalue[4] = (float)j5;
+						addjointvalue[5] = (float)j6;
+						addfingervalue[0] = (float)f1;
+						addfingervalue[1] = (float)f2;
+						addfingervalue[2] = (float)f3;
+					
+						m_JointsTrajectory.Add(GenerateJointTrajectory(addjointvalue, addfingervalue));
+					}
 					
 				//}
 			}
@@ -650,7 +703,12 @@ namespace CSharpWrapper
 			{
 				//if (m_Arm.JacoIsReady())
 				//{					
-					m_Arm.ControlManager.SendBasicTrajectory(m_JointsTrajectory);
+					lock (m_TrajectoryLock)
+					{
+						m_Arm.ControlManager.SendBasicTrajectory(m_JointsTrajectory);
+						// the C++ side streams long trajectories in chunks, each chunk is sent only once
+						m_JointsTrajectory.Trajectory.Clear();
+					}
 					
 				//}
 			}
@@ -662,7 +720,7 @@ namespace CSharpWrapper
 			
 		}	
 		
-		private CTrajectoryInfo GenerateJointTrajectory(float []jointAngles)
+		private CTrajectoryInfo GenerateJointTrajectory(float []jointAngles, float []fingers)
 		{
 					CTrajectoryInfo jointTrajectory = new CTrajectoryInfo();  
                   
@@ -678,29 +736,35 @@ namespace CSharpWrapper
 					jointTrajectory.UserPosition.AnglesJoints.Angle[CVectorAngle.JOINT_6] = jointAngles[5];	
 						
 					
-					jointTrajectory.UserPosition.FingerPosition[0] = joint_info.Finger1;
-					jointTrajectory.UserPosition.FingerPosition[1] = joint_info.Finger2;
-					jointTrajectory.UserPosition.FingerPosition[2] = joint_info.Finger3;
+					jointTrajectory.UserPosition.FingerPosition[0] = fingers[0];
+					jointTrajectory.UserPosition.FingerPosition[1] = fingers[1];
+					jointTrajectory.UserPosition.FingerPosition[2] = fingers[2];
 						
                    
 					return jointTrajectory;
 		}
 		
-		public void JacoAddCartesianSpaceTrajectory(double X, double Y, double Z, double Rx, double Ry, double Rz)
+		public void JacoAddCartesianSpaceTrajectory(double X, double Y, double Z, double Rx, double Ry, double Rz, double f1, double f2, double f3)
 		{	
 			
 				try
 				{
 					if (m_Arm.JacoIsReady())
     				{   						
-						addposevalue[0] = (float)(X);
-						addposevalue[1] = (float)(Y);
-						addposevalue[2] = (float)(Z);
-						addposevalue[3] = (float)(Rx);
-						addposevalue[4] = (float)(Ry);
-						addposevalue[5] = (float)(Rz);	
+						lock (m_TrajectoryLock)
+						{
+							addposevalue[0] = (float)(X);
+							addposevalue[1] = (float)(Y);
+							addposevalue[2] = (float)(Z);
+							addposevalue[3] = (float)(Rx);
+							addposevalue[4] = (float)(Ry);
+							addposevalue[5] = (float)(Rz);
+							addfingervalue[0] = (float)f1;
+							addfingervalue[1] = (float)f2;
+							addfingervalue[2] = (float)f3;
 									        
-						m_PoseTrajectory.Add(GeneratePoseTrajectory(addposevalue));	
+							m_PoseTrajectory.Add(GeneratePoseTrajectory(addposevalue, addfingervalue));
+						}
 											
     				}					
 				}
@@ -717,7 +781,12 @@ namespace CSharpWrapper
 			{
 				if (m_Arm.JacoIsReady())
 				{
-			        m_Arm.ControlManager.SendTrajectoryFunctionnality(m_PoseTrajectory);	
+					lock (m_TrajectoryLock)
+					{
+			        	m_Arm.ControlManager.SendTrajectoryFunctionnality(m_PoseTrajectory);
+						// the C++ side streams long trajectories in chunks, each chunk is sent only once
+						m_PoseTrajectory.Trajectory.Clear();
+					}
 				}
 			}
 			catch (Exception ex)
@@ -729,7 +798,7 @@ namespace CSharpWrapper
 		}	
 
 		
-		private CTrajectoryInfo GeneratePoseTrajectory(float []pose)
+		private CTrajectoryInfo GeneratePoseTrajectory(float []pose, float []fingers)
 		{
 					CTrajectoryInfo poseTrajectory = new CTrajectoryInfo();  
                   
@@ -743,10 +812,33 @@ namespace CSharpWrapper
                     poseTrajectory.UserPosition.Position.Rotation[CVectorEuler.THETA_X] = pose[3];
                     poseTrajectory.UserPosition.Position.Rotation[CVectorEuler.THETA_Y] = pose[4];
                     poseTrajectory.UserPosition.Position.Rotation[CVectorEuler.THETA_Z] = pose[5];
+                    poseTrajectory.UserPosition.FingerPosition[0] = fingers[0];
+                    poseTrajectory.UserPosition.FingerPosition[1] = fingers[1];
+                    poseTrajectory.UserPosition.FingerPosition[2] = fingers[2];
+					ApplyCartesianSpeedLimit(poseTrajectory);
                    
 					return poseTrajectory;
 		}
 		
+		// The "JacoSetCartesianSpeedLimit" function receive the speeds in m/s and rad/s, 0 or less for the default of the arm
+		public void JacoSetCartesianSpeedLimit(double linear, double angular)
+		{
+			m_CartesianLinearSpeed = (float)Math.Max(linear, 0.0);
+			m_CartesianAngularSpeed = (float)Math.Max(angular, 0.0);
+		}
+		
+		private void ApplyCartesianSpeedLimit(CTrajectoryInfo poseTrajectory)
+		{
+			if (m_CartesianLinearSpeed > 0.0f || m_CartesianAngularSpeed > 0.0f)
+			{
+				poseTrajectory.LimitationActive = true;
+				poseTrajectory.ZoneLimitation.LinearSpeed = m_CartesianLinearSpeed;
+				poseTrajectory.ZoneLimitation.AngularSpeed = m_CartesianAngularSpeed;
+			}
+			else
+				poseTrajectory.LimitationActive = false;
+		}
+		
 		private CTrajectoryInfo GenerateFingerTrajectory(float finger_1, float finger_2, float finger_3)
 		{
 					CTrajectoryInfo fingerTrajectory = new CTrajectoryInfo();  
@@ -770,7 +862,8 @@ namespace CSharpWrapper
 				{
 					//if (m_Arm.JacoIsReady())					
 					//{
-						m_fingerTrajectory.Add(GenerateFingerTrajectory((float)finger_1, (float)finger_2, (float)finger_3));						
+						lock (m_TrajectoryLock)
+							m_fingerTrajectory.Add(GenerateFingerTrajectory((float)finger_1, (float)finger_2, (float)finger_3));
 					//}
 				}
 				catch (Exception ex)
@@ -787,7 +880,11 @@ namespace CSharpWrapper
 			{
 				//if (m_Arm.JacoIsReady())
 				//{					
-			        m_Arm.ControlManager.SendTrajectoryFunctionnality(m_fingerTrajectory);
+					lock (m_TrajectoryLock)
+					{
+			        	m_Arm.ControlManager.SendTrajectoryFunctionnality(m_fingerTrajectory);
+						m_fingerTrajectory.Trajectory.Clear();
+					}
 				//}
 			}
 			catch (Exception ex)
@@ -798,71 +895,20 @@ namespace CSharpWrapper
 			
 		}	
 		
-		public void JacoOpenFingers()
-		{	
-			try
-			{
-				//if (m_Arm.JacoIsReady())
-				//{		 
-					
-					JacoEraseTrajectories();
-					double []kk= new double [3];
-					
-					kk[0] = 0.1;
-					kk[1] = 0.1;
-					kk[2] = 0.1;
-					
-					JacoAddFingerPosition(kk[0], kk[1], kk[2]);
-					JacoSetFingersPosition();
-					
-				//}
-			}
-			catch (Exception ex)
-			{
-				System.Console.WriteLine("EXCEPTION in JacoOpenFinger");
-				System.Console.WriteLine(ex.ToString());
-			} 				
-			
-		}
-		
-		// arbitrary chosen 40.0  
-		public void JacoCloseFingers()
-		{	
-			try
-			{
-				//if (m_Arm.JacoIsReady())
-				//{	
-					JacoEraseTrajectories();
-					
-					double []finger_angle= new double [3];
-					
-					finger_angle[0] = 40.0;
-					finger_angle[1] = 40.0;
-					finger_angle[2] = 40.0;
-					
-					JacoAddFingerPosition(finger_angle[0], finger_angle[1], finger_angle[2]);
-					JacoSetFingersPosition();	
-				//}
-			}
-			catch (Exception ex)
-			{
-				System.Console.WriteLine("EXCEPTION in JacoCloseFinger");
-				System.Console.WriteLine(ex.ToString());
-			} 				
-			
-		}		
-		
-		
 		public void JacoEraseTrajectories()
 		{	
 			try
 			{
 				//if (m_Arm.JacoIsReady())
 				//{	
-					m_JointsTrajectory.Trajectory.Clear();
-					m_fingerTrajectory.Trajectory.Clear ();
-					// erasing any previous trajectories
-					m_Arm.ControlManager.EraseTrajectories();					
+					lock (m_TrajectoryLock)
+					{
+						m_JointsTrajectory.Trajectory.Clear();
+						m_PoseTrajectory.Trajectory.Clear();
+						m_fingerTrajectory.Trajectory.Clear ();
+						// erasing any previous trajectories
+						m_Arm.ControlManager.EraseTrajectories();
+					}
 					
 				//}
 			}
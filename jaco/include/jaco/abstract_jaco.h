@@ -30,7 +30,17 @@
 
 #include <ros/ros.h>
 #include <ros/console.h>
+#include <boost/thread/mutex.hpp>
 #include <jaco/jaco_constants.h>
+#include <jaco/jaco_calibration.h>
+#include <jaco/jaco_singularity.h>
+#include <jaco/jaco_self_collision_guard.h>
+#include <jaco/jaco_workspace.h>
+#include <jaco/jaco_state_estimator.h>
+#include <jaco/jaco_trajectory_feeder.h>
+#include <jaco/jaco_state_snapshot.h>
+#include <jaco/message_pool.h>
+#include <jaco/state_shm.h>
 #include <jaco/JacoPoseTrajectory.h>
 
 
@@ -46,12 +56,17 @@ namespace kinova
 			virtual void readJacoStatus()=0;
 			virtual void setJointAngles(double jointangles[])=0;
 			virtual bool setJointSpaceTrajectory(std::vector<double> jointtrajectory)=0;
+			// continues the current joint trajectory with jointtrajectory instead of stopping for it, false if the
+			// new one does not pass within tolerances [rad] through the points already in the FIFO of the arm
+			virtual bool spliceJointSpaceTrajectory(std::vector<double> jointtrajectory, const double tolerances[])=0;
 			virtual bool setCartesianSpaceTrajectory(jaco::JacoPoseTrajectory cartesiantrajectory)=0;
 			virtual bool setAbsPose(double pose[])=0;
 			virtual bool setRelPosition(double position[])=0;
 			virtual bool openFingers()=0;
 			virtual bool closeFingers()=0;
             		virtual bool setFingersValues(double fingers[])=0;
+			// holds the fingers where they are, the arm keeps moving
+			bool stopFingers();
 			virtual bool startApiCtrl()=0;
 			virtual bool stopApiCtrl()=0;
             virtual void stop()=0;
@@ -61,16 +76,68 @@ namespace kinova
                         virtual bool setActuatorPIDGain(int jointnum, float P, float I, float D)=0;
                         virtual bool restoreFactorySetting()=0;
                         virtual bool retract()=0;
+                        virtual bool eraseTrajectories()=0;
+                        // speed limit of the following cartesian commands [m/s, rad/s], <= 0 for the default speed of the arm
+                        virtual bool setCartesianSpeedLimit(double linear, double angular)=0;
+                        // joint velocities [rad/s] the arm keeps only for a short moment, to be streamed every cycle in angular mode
+                        virtual bool setJointVelocities(double velocities[])=0;
+                        // erases the FIFO and, with velocities, stops streamed joint velocities without waiting for a command
+                        // of another thread to return, for the watchdog; the arm stays stopped until eraseTrajectories()
+                        virtual bool emergencyStop(bool velocities)=0;
 
-                        std::vector<std::string> getJointNames();
-                        std::vector<std::string> getFingersJointName();
-			std::vector<std::string> getLinkNames();
-			std::vector<double> getJointAngles();
-                        std::vector<double> getJointsCurrent();
-			std::vector<double> getFingersJointAngle();
-			std::vector<double> getFingersCurrent();
-			std::vector<double> getPose();
-			int getCurrentTrajectoryNumber();
+                        // threads other than the one which created the arm, e.g. the watchdog of jaco_node.h, have to be
+                        // attached before their first command and detached before they end
+                        virtual void attachThread() {}
+                        virtual void detachThread() {}
+
+                        // the getters return references to the last read state, copy them if they have to outlive the next readJacoStatus()
+                        const std::vector<std::string>& getJointNames() const;
+                        const std::vector<std::string>& getFingersJointName() const;
+			const std::vector<std::string>& getLinkNames() const;
+			const std::vector<double>& getJointAngles() const;
+                        const std::vector<double>& getJointsCurrent() const;
+			const std::vector<double>& getFingersJointAngle() const;
+			const std::vector<double>& getFingersCurrent() const;
+			const std::vector<double>& getJointVelocities() const;		// filtered, see jaco_state_estimator.h
+			const std::vector<double>& getJointAccelerations() const;
+			const std::vector<double>& getFingersVelocity() const;
+			const std::vector<double>& getFingersAcceleration() const;
+			const std::vector<double>& getPose() const;		// jaco_gripper_tool_frame in jaco_base_link, from the joint angles
+			const std::vector<double>& getApiPose() const;		// hand pose as reported by the arm, in its base_jaco frame
+			int getCurrentTrajectoryNumber() const;		// points still in the FIFO of the arm
+			int getQueuedTrajectoryNumber() const;		// trajectory points not uploaded to the FIFO yet
+			int getTrajectoryFifoSize() const;		// as reported by the arm, 0 if unknown
+			const JacoSingularityState& getSingularityState() const;
+
+			// where JacoSingularityState::speed_scale starts to drop
+			void setSingularityLimits(const JacoSingularityLimits& limits);
+
+			// how actuator degrees map to joint angles, to be set before the first readJacoStatus()
+			void setJointCalibration(const JacoCalibration& calibration);
+			const JacoCalibration& getJointCalibration() const;
+
+			// samples the velocities and accelerations are fitted to, false if out of range
+			bool setVelocityEstimationWindow(size_t window);
+
+			// how close the links may get before joint commands are rejected and the arm is stopped
+			void setSelfCollisionLimits(const JacoSelfCollisionLimits& limits);
+			double getSelfCollisionClearance() const;	// of the last read state [m]
+
+			// fences in base_jaco the commands of the hand are checked against
+			void setWorkspace(const JacoWorkspace& workspace);
+			const JacoWorkspace& getWorkspace() const;
+
+			// joint trajectory points uploaded to the FIFO at once, 0 to fill it completely
+			void setTrajectoryChunkSize(size_t chunk);
+
+                        // coherent copy of the last read state, safe to keep and to read from other threads
+                        JacoStateSnapshotConstPtr getStateSnapshot() const;
+
+                        // when setJointVelocities() was last called, true if it did not send a stop, safe from other threads
+                        bool isStreamingJointVelocities(ros::Time& last_command) const;
+
+                        // additionally copy every acquisition into a shared memory ring buffer for local processes
+                        bool enableStateSharedMemory(const std::string& name, size_t capacity);
 
 			std::vector<bool> joystick_button_states_;
 			std::vector<double> joystick_axes_states_;
@@ -84,12 +151,72 @@ namespace kinova
             std::vector<double> fingers_jointangle_;
             std::vector<double> fingers_current_;
 			std::vector<double> pose_;
+			std::vector<double> api_pose_;
 			int trajnum_;
+			int trajfifo_size_;
+			JacoSingularityState singularity_;	// the implementation fills in what the arm reports
+			JacoCalibration calibration_;		// the implementation converts the joints of the arm with it
+			JacoSelfCollisionGuard self_collision_;
+			JacoWorkspace workspace_;
+			JacoTrajectoryFeeder trajectory_feeder_;	// the implementation uploads joint trajectories through it
+			JacoTrajectoryFeeder pose_trajectory_feeder_;	// and cartesian ones, as x y z thetax thetay thetaz
+
+
+
+
+			std::vector<double> joint_velocities_;		// estimated by publishStateSnapshot()
+			std::vector<double> joint_accelerations_;
+			std::vector<double> fingers_velocity_;
+			std::vector<double> fingers_acceleration_;
+
+                        // computes pose_ from joint_angles_, to be called whenever new joint angles were read
+                        void updateForwardKinematics();
+
+                        // computes the jacobian part of singularity_ and its speed scale from joint_angles_
+                        void updateSingularity();
+
+                        // whether the joint path from joint_angles_ through count waypoints (NUM_JOINTS each),
+                        // or the motion with the joint velocities, stays clear of self collisions
+                        bool jointPathClear(const double *waypoints, size_t count) const;
+                        bool jointVelocitiesClear(const double velocities[]) const;
+
+                        // checks joint_angles_, true if the links just came closer than the stop margin
+                        bool updateSelfCollision();
+
+                        // whether the hand stays in the workspace on the joint path from joint_angles_, or on the
+                        // cartesian path from api_pose_ through count poses (POSE_SIZE each)
+                        bool jointPathInWorkspace(const double *waypoints, size_t count) const;
+                        bool posePathInWorkspace(const double *poses, size_t count) const;
+
+                        // the position of pose, or the setRelPosition() direction, may be changed to keep the hand in
+                        bool poseInWorkspace(double pose[]) const;
+                        bool directionInWorkspace(double direction[]) const;
+
+                        // factor in [0, 1] the joint velocities are sent with
+                        double workspaceVelocityScale(const double velocities[]) const;
+
+                        // to be called by the implementation once all the state of an acquisition is read,
+                        // the velocities and accelerations are estimated with its time stamp
+                        void publishStateSnapshot();
 
+                        // to be called by the implementation with the joint velocities it sent to the arm
+                        void recordJointVelocities(const double velocities[]);
 
+		private:
+                        void writeSharedMemory(const JacoStateSnapshot& snapshot);
 
+                        typedef MessagePool<JacoStateSnapshot, CacheAlignedAllocator<JacoStateSnapshot> > SnapshotPool;
+                        boost::shared_ptr<SnapshotPool> snapshot_pool_;
+                        JacoStateSnapshotConstPtr latest_snapshot_;
+                        mutable boost::mutex snapshot_mutex_;
+                        unsigned long snapshot_sequence_;
+                        boost::shared_ptr<StateShmWriter> state_shm_;
+                        JacoSingularityLimits singularity_limits_;
+                        JacoStateEstimator state_estimator_;
 
-			std::vector<double> joint_velocities_;
+                        mutable boost::mutex command_mutex_;
+                        ros::Time velocity_command_time_;
+                        bool streaming_velocities_;
 	};
 }
 #endif	       /*ABSTRACTJACO_H_ */
@@ -44,7 +44,9 @@ namespace kinova
 	  typedef actionlib::ActionServer<control_msgs::GripperCommandAction> GAS;
 	  typedef GAS::GoalHandle GoalHandle;
 	public:
-	  GripperAction(boost::shared_ptr<AbstractJaco> jaco);
+	  // the watchdog timer runs on the callback queue of wn, see JacoActionController
+	  GripperAction(boost::shared_ptr<AbstractJaco> jaco, ros::NodeHandle nh = ros::NodeHandle(), ros::NodeHandle pn = ros::NodeHandle("~"),
+	                ros::NodeHandle wn = ros::NodeHandle("~"));
 	  ~GripperAction();
 
        void update();
@@ -57,6 +59,11 @@ namespace kinova
 	  ros::Publisher pub_controller_command_;
 	  ros::Subscriber sub_controller_state_;
 	  ros::Timer watchdog_timer_;
+	  boost::mutex watchdog_mutex_;
+	  double state_timeout_;		// [s] age of the state while the fingers move
+	  bool watchdog_armed_;		// a goal is moving the fingers
+	  bool watchdog_tripped_;		// the FIFO was erased, the goal is aborted by update()
+	  void publishWatchdog();
 
 	  bool has_active_goal_;
 	  GoalHandle active_goal_;
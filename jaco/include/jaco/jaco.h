@@ -33,6 +33,8 @@
 #include <glib-2.0/glib.h>
 #include <mono/jit/jit.h>
 #include <mono/metadata/assembly.h>
+#include <mono/metadata/threads.h>
+#include <boost/thread/recursive_mutex.hpp>
 #include <jaco/abstract_jaco.h>
 #include <jaco/JacoPoseTrajectory.h>
 #include <math.h>
@@ -44,7 +46,7 @@ namespace kinova
 	/// \brief The state of a single Jaco joint.
 	struct JacoJointState
 	{
-		double angle;
+		double angle;		// actuator degrees for the arm joints (see JacoCalibration), radians for the fingers
 		double velocity;	
 	};
 
@@ -59,10 +61,17 @@ namespace kinova
 		double hand_position[3];
 		double hand_orientation[3]; // Euler angles XYZ
 		int current_trajectory;
+		int trajectory_fifo_size;
 
 		bool joystick_button_states[7];
 		double joystick_axes_states[3];
 
+		// GetSingularityVector
+		int singularity_count;
+		int singularity_theta_count;
+		double singularity_distance;
+		double singularity_theta_distance;
+		double singularity_repulsion[6];
 	};
 
 	class Jaco : public AbstractJaco
@@ -87,6 +96,7 @@ namespace kinova
                         bool setAbsPose(double pose[]);
                         bool setRelPosition(double position[]);
                         bool setJointSpaceTrajectory(std::vector<double> jointtrajectory);
+                        bool spliceJointSpaceTrajectory(std::vector<double> jointtrajectory, const double tolerances[]);
                         bool setCartesianSpaceTrajectory(jaco::JacoPoseTrajectory cartesiantrajectory);
                         bool eraseTrajectories();
                         bool openFingers();
@@ -102,6 +112,11 @@ namespace kinova
                         bool setActuatorPIDGain(int jointnum, float P, float I, float D);
                         bool restoreFactorySetting();
                         bool retract();
+                        bool setCartesianSpeedLimit(double linear, double angular);
+                        bool emergencyStop(bool velocities);
+                        bool setJointVelocities(double velocities[]);
+                        void attachThread();
+                        void detachThread();
 		private:
                         /* Variables related to Mono */
                         // Domain that will contains our reference to the DLL
@@ -144,10 +159,6 @@ namespace kinova
                         MonoMethod *SetCartesianSpaceTrajectory;
                         // Erase Trajectories
                         MonoMethod *EraseTrajectories;
-                        // Open Fingers
-                        MonoMethod *OpenFingers;
-                        // Close Fingers
-                        MonoMethod *CloseFingers;
                         // Add the Figner Position
                         MonoMethod *AddFingerPosition;
                         // set Fingers Joint Angles
@@ -168,21 +179,56 @@ namespace kinova
                         MonoMethod *RestoreFactorySetting;
                         // Retract arm - DLL
                         MonoMethod *Retract;
+                        // Speed limit of cartesian trajectories - DLL
+                        MonoMethod *SetCartesianSpeedLimit;
+                        // Stream joint velocities - DLL
+                        MonoMethod *SendJointVelocity;
 
                         bool lastApiControlState;
 
+                        // adds count points (NUM_JOINTS joint angles each) to the FIFO of the arm, nothing is checked or erased
+                        bool uploadJointSpaceTrajectory(const double *waypoints, size_t count);
+
+                        // adds count poses (x y z thetax thetay thetaz each) to the FIFO of the arm, in cartesian mode
+                        bool uploadCartesianSpaceTrajectory(const double *waypoints, size_t count);
+
+                        // tops the FIFO up from trajectory_feeder_ or pose_trajectory_feeder_, to be called right after trajnum_ is read
+                        typedef bool (Jaco::*TrajectoryUpload)(const double *waypoints, size_t count);
+                        void feedTrajectory(JacoTrajectoryFeeder &feeder, TrajectoryUpload upload);
+                        void feedJointSpaceTrajectory();
+
+                        // The fingers are not a trajectory of their own, their target [API degrees] is carried by every
+                        // point added to the FIFO and every joint velocity streamed, so a finger command never stops the
+                        // arm. Without a target the points keep the fingers where they are.
+                        double finger_target_[3];
+                        bool has_finger_target_;
+                        bool fingers_pending_;		// to be sent once the FIFO ran empty, see readJacoStatus()
+                        JacoTrajectoryFeeder *fifo_tail_;	// fed the last point in the FIFO, NULL if unknown
+                        void fingerPositions(double fingers[3]) const;	// what the next point carries
+                        bool moveFingers(const double fingers[3]);
+                        bool sendFingerPoint();
+
+                        // set by emergencyStop() when a command of another thread held jaco_mutex, nothing is fed or
+                        // streamed any more until eraseTrajectories() clears it
+                        mutable boost::mutex stop_mutex_;
+                        bool stop_requested_;
+                        bool stopRequested() const;
+
 
 
 		public:
 			double ja[6];
 			double *tja[6];
 			void *get_params[6];
-			void *set_params[6];
+			void *set_params[9];
 			void *set_position[3];
                         void *set_pid_gain[4];
                         void *set_fingers_params[3];
+                        void *set_speed_limit[2];
+                        void *set_velocity_params[9];
 
-	                //boost::recursive_mutex jaco_mutex;	
+	                // every command holds it, the watchdog may stop the arm from its own thread
+	                boost::recursive_mutex jaco_mutex;	
 			JacoArmState jacostate;
 		
 					
@@ -24,8 +24,8 @@
  *                  - To move a trajectory in joint space
  *                  - To open or close the finger
  *                  - To move the jaco in relative cartesian space
- *                  - !!! jaco joints are controlled by P controller, so currently a "brutal/hack" controller is used on
- *                        top of jaco controller to rech a desired value !!!
+ *                  - interpolated joint trajectories are tracked on top of the jaco controller with
+ *                        velocity feedforward and PID, see jaco_tracking_controller.h
  */
 
 #ifndef JACO_ACTION_CONTROLLER_H_
@@ -34,11 +34,18 @@
 #include <ros/ros.h>
 #include <actionlib/server/action_server.h>
 #include <jaco/abstract_jaco.h>
+#include <jaco/jaco_compiled_trajectory.h>
+#include <jaco/jaco_trajectory_interpolator.h>
+#include <jaco/jaco_trajectory_retimer.h>
+#include <jaco/jaco_trajectory_simplifier.h>
+#include <jaco/jaco_tracking_controller.h>
+#include <jaco/jaco_trajectory_constraints.h>
 #include <trajectory_msgs/JointTrajectory.h>
 #include <control_msgs/FollowJointTrajectoryAction.h>
 #include <control_msgs/FollowJointTrajectoryFeedback.h>
 #include <jaco/FingerMovementAction.h>
 #include <jaco/CartesianMovementAction.h>
+#include <jaco/CartesianTrajectoryAction.h>
 #include <boost/thread/thread.hpp>
 
 
@@ -57,16 +64,21 @@ namespace kinova
 		typedef actionlib::ActionServer<jaco::CartesianMovementAction> CMAS;			
 		typedef CMAS::GoalHandle CartesianGoalHandle;		
 
+		typedef actionlib::ActionServer<jaco::CartesianTrajectoryAction> CTAS;
+		typedef CTAS::GoalHandle CartesianTrajectoryGoalHandle;
+
                 typedef actionlib::ActionServer<jaco::FingerMovementAction> FAS;
                 typedef FAS::GoalHandle FingerGoalHandle;
 
 
 		public:			
-			JacoActionController(boost::shared_ptr<AbstractJaco>);			
+			// the watchdog timer runs on the callback queue of wn, one of its own lets it stop the arm without waiting for update()
+			JacoActionController(boost::shared_ptr<AbstractJaco>, ros::NodeHandle nh = ros::NodeHandle(), ros::NodeHandle pn = ros::NodeHandle("~"),
+					     ros::NodeHandle wn = ros::NodeHandle("~"));
 			virtual ~JacoActionController();
+			// a joint, cartesian or cartesian trajectory goal owns the arm
+			bool hasActiveArmGoal() const;
 			bool suitableGoal(const std::vector<std::string> &goalNames);
-			bool is_jointSpaceTrajectory_finished(const std::vector<double> &currentvalue, const std::vector<double> &targetvalue);
-                        bool is_trajectory_finished();
                         void calculate_error_dervError(const std::vector<double> &currentvalue, const std::vector<double> &targetvalue);                        
 			bool is_cartesianSpaceTrajectory_finished(const std::vector<double> &currentvalue, const std::vector<double> &targetvalue);
                         bool simplecontroller_finger(const std::vector<double> &currentvalue, const double targetvalue);                        
@@ -92,10 +104,40 @@ namespace kinova
 			bool movejoint_done;
                         int num_jointTrajectory;
                         int num_activeTrajectory;       //active trajectory in jaco
-			std::map<std::string,double> goal_constraints;			
-			std::map<std::string,double> trajectory_constraints;
-			double goal_time_constraint;
-			double stopped_velocity_tolerance;
+			JacoTrajectoryConstraints default_constraints;	// of the parameters
+			JacoTrajectoryConstraints active_constraints;	// of the goal, with its own tolerances
+			bool loadConstraints(const control_msgs::FollowJointTrajectoryGoal &goal, JacoTrajectoryConstraints &constraints);
+			std::vector<double> fifo_start_jtangles;	// where the arm was when the fifo trajectory was sent
+			bool fifo_spliced;
+			ros::Time fifo_empty_time;
+			bool fifo_emptied;
+			void monitorFifoTrajectory();
+			bool simplify_trajectories;		// see jaco_trajectory_simplifier.h
+			double simplify_tolerances[NUM_JOINTS];
+			bool splice_trajectories;
+			bool sendJointTrajectory();
+
+			// the trajectory is interpolated here and followed with joint velocities, so its timing is kept
+			bool interpolate_trajectories;
+			JacoTrajectoryInterpolator interpolator;
+			JacoTrackingController tracking_controller;
+			ros::Time last_tracking_time;
+			ros::Time interpolation_start;
+			bool start_interpolation;
+			bool interpolating_joint;
+			bool stop_joint_velocities;
+			JacoCompiledTrajectory pending_trajectory;
+			boost::mutex interpolation_mutex;	// the goal callbacks run in the thread of the action server
+			bool loadInterpolator(const JacoCompiledTrajectory &trajectory);
+			bool retime_trajectories;		// see jaco_trajectory_retimer.h
+			double retime_slack;
+			JacoTrajectoryRetimer retimer;
+			double retime_max_acceleration[NUM_JOINTS];	// [rad/s^2] the retimer plans with
+			void retimeTrajectory(JacoCompiledTrajectory &trajectory);
+			void startInterpolation();
+			void updateInterpolation();
+			void stopInterpolation();
+
 			ros::Publisher pub_controller_command;
 			ros::Subscriber sub_controller_state;
 			JointGoalHandle joint_active_goal;
@@ -113,6 +155,32 @@ namespace kinova
 			bool movepose_done;
 			CartesianGoalHandle cartesian_active_goal;	
 
+			// the speed limit of cartesian goals follows JacoSingularityState::speed_scale
+			bool scale_cartesian_speed;
+			double max_linear_speed, max_angular_speed;
+			double rescale_step;		// the goal is sent again once the scale fell by more than this, or rose by twice
+			double rescale_interval;	// [s] at least between sending it again for a higher scale
+			double commanded_speed_scale;
+			ros::Time rescale_time;		// when commanded_speed_scale was sent
+			bool rescaleDue(double speed_scale) const;
+			bool sendCartesianGoal();
+
+			// cartesian trajectory actionlib variables, the poses are streamed into the FIFO of the arm
+			jaco::CartesianTrajectoryResult ctaction_res;
+			void cartesian_trajectory_goalCB(CartesianTrajectoryGoalHandle gh);
+			void cartesian_trajectory_cancelCB(CartesianTrajectoryGoalHandle gh);
+			CTAS ct_actionserver;
+
+			bool move_pose_trajectory;
+			bool moveposetrajectory_done;
+			jaco::JacoPoseTrajectory desired_pose_trajectory;
+			int num_poseTrajectory;
+			int pose_feedback_point;		// the last one reported
+			double trajectory_linear_speed, trajectory_angular_speed;	// needed by the timing of the goal, 0 for any
+			CartesianTrajectoryGoalHandle cartesian_trajectory_active_goal;
+			void limitCartesianTrajectorySpeed();
+			void monitorCartesianTrajectory();
+
 			// finger actionlib variables
 			boost::shared_ptr<kinova::AbstractJaco> FAC_jaco;
 			jaco::FingerMovementResult fingeraction_res;                      
@@ -125,7 +193,6 @@ namespace kinova
 
                         bool move_finger;
                         bool movefinger_done;
-                        int fingerTrajNumber;
                         std::string finger_action;
                         bool finger_open, finger_close;
                         FingerGoalHandle finger_active_goal;
@@ -134,14 +201,31 @@ namespace kinova
 						
 			// action lib variables			
 			boost::shared_ptr<kinova::AbstractJaco> jaco_apictrl;
-			ros::Timer watchdog_timer;					
 			bool stop_jaco;			
-			bool has_active_goal;	
-
-			// temporary outer control loop			
-			void outerloopcontroller_jointSpace(const std::vector<double> &currentvalue, const std::vector<double> &targetvalue, const double error_factor);
-			double error_factor;
-			int control_counter;
+			bool stop_fingers;		// holds the fingers, not the arm
+			// the arm (joint, cartesian and cartesian trajectory goals) and the fingers are arbitrated
+			// independently, a finger goal does not cancel or stop an arm goal and the other way round
+			bool has_active_arm_goal;	
+			bool has_active_finger_goal;
+			// cancels whichever arm goal is active for a new one, the arm stops unless a joint goal is
+			// continued by the new joint goal (keep_joint_motion), to be called with interpolation_mutex held
+			bool erase_arm_fifo;		// update() erases the FIFO before it sends the new goal
+			void preemptArmGoal(bool keep_joint_motion);
+
+			// the watchdog erases the FIFO and stops the streamed velocities once they are not sent any more,
+			// the state is not read any more or a joint goal still moves past its goal time. update() tells it
+			// what the goals are doing and aborts them after a stop.
+			ros::Timer watchdog_timer;					
+			boost::mutex watchdog_mutex;
+			double state_timeout;			// [s] age of the state while the arm is commanded
+			double command_timeout;			// [s] between streamed joint velocities
+			bool watchdog_armed;			// a goal is moving the arm
+			ros::Time watchdog_deadline;		// end of the goal time of the joint goal, zero for none
+			double watchdog_velocity_tolerance[NUM_JOINTS];	// the goal is settled below these [rad/s]
+			bool watchdog_tripped;
+			bool watchdog_goal_time;		// it stopped the arm for the goal time
+			void publishWatchdog();
+			void abortWatchdogGoals();
 
 			// graps			
 			bool object_grasped_process;
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_calibration.h
+ *
+ *  PURPOSE ---  Conversion between the actuator degrees of the arm and the joint angles of the urdf
+ */
+
+#ifndef JACO_CALIBRATION_H_
+#define JACO_CALIBRATION_H_
+
+#include <jaco/jaco_constants.h>
+
+namespace kinova
+{
+	// zero of the urdf joints in actuator degrees, based on observation of the actual model
+	const double DEFAULT_JOINT_OFFSETS[NUM_JOINTS] = { 180.0, 270.0, 90.0, 180.0, 180.0, 260.0 };
+
+	// direction of the urdf joints relative to the actuators
+	const double DEFAULT_JOINT_SIGNS[NUM_JOINTS] = { 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 };
+
+	/**
+	*  The joint model of the arm: angle [rad] = sign * (actuator [deg] - offset) in [-pi, pi].
+	*  The C# wrapper hands actuator degrees through unchanged, all conversions are done here.
+	*/
+	class JacoCalibration
+	{
+		public:
+			// DEFAULT_JOINT_OFFSETS and DEFAULT_JOINT_SIGNS
+			JacoCalibration();
+
+			// false if a sign is not +-1, the calibration is unchanged then
+			bool set(const double offsets[NUM_JOINTS], const double signs[NUM_JOINTS]);
+			const double* getOffsets() const { return offsets_; }
+			const double* getSigns() const { return signs_; }
+
+			// actuator positions [deg] to joint angles [rad] wrapped to [-pi, pi]
+			void toJointAngles(const double actuator[NUM_JOINTS], double angles[NUM_JOINTS]) const;
+
+			// joint angles [rad] to actuator positions [deg], not wrapped, the arm counts the turns
+			void toActuatorPositions(const double angles[NUM_JOINTS], double actuator[NUM_JOINTS]) const;
+
+			// joint velocities [rad/s] to actuator speeds [deg/s]
+			void toActuatorSpeeds(const double velocities[NUM_JOINTS], double actuator[NUM_JOINTS]) const;
+
+		private:
+			double offsets_[NUM_JOINTS];	// [deg]
+			double signs_[NUM_JOINTS];
+	};
+}
+
+#endif /* JACO_CALIBRATION_H_ */
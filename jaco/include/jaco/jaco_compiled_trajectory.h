@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_compiled_trajectory.h
+ *
+ *  PURPOSE ---  A joint trajectory goal compiled once into flat arrays in the joint order of the arm
+ */
+
+#ifndef JACO_COMPILED_TRAJECTORY_H_
+#define JACO_COMPILED_TRAJECTORY_H_
+
+#include <jaco/jaco_constants.h>
+#include <ros/ros.h>
+#include <trajectory_msgs/JointTrajectory.h>
+
+#include <string>
+#include <vector>
+
+namespace kinova
+{
+	/**
+	*  The points of a trajectory message as arrays of NUM_JOINTS values per point, permuted into the
+	*  joint order of the arm, so the control loop indexes them instead of walking the message.
+	*/
+	struct JacoCompiledTrajectory
+	{
+		std::vector<double> times;		// time_from_start of each point [s]
+		std::vector<double> positions;		// [rad]
+		std::vector<double> velocities;		// [rad/s], empty unless every point has them
+		std::vector<double> accelerations;	// [rad/s^2], empty unless every point has them and velocities
+		ros::Time stamp;			// when the trajectory starts
+
+		// false if a joint of the arm is missing or a point has not a value for every joint
+		bool compile(const trajectory_msgs::JointTrajectory& trajectory, const std::vector<std::string>& joint_names);
+		void clear();
+		// the continuous joints moved by whole turns to go on from start and from point to point the short way round
+		void unwrap(const double start[NUM_JOINTS]);
+
+		size_t size() const;				// points
+		const double* point(size_t index) const;	// positions of a point
+		double duration() const;			// time_from_start of the last point [s]
+	};
+}
+
+#endif /* JACO_COMPILED_TRAJECTORY_H_ */
@@ -26,6 +26,9 @@
 #ifndef JACO_CONSTANTS_H_
 #define JACO_CONSTANTS_H_
 
+#include <cmath>
+#include <cstddef>
+
 namespace kinova
 {
 	// degree of freedom
@@ -37,6 +40,24 @@ namespace kinova
 	// finger joint numbers
 	const size_t NUM_FINGER_JOINTS = 3;
 
+	// cartesian pose of the hand (x, y, z, theta x, theta y, theta z)
+	const size_t POSE_SIZE = 6;
+
+	// joystick buttons and axes reported by the arm
+	const size_t NUM_JOYSTICK_BUTTONS = 7;
+	const size_t NUM_JOYSTICK_AXES = 3;
+
+	// joints 1 to 5 turn without limit, their angles are reported in [-pi, pi]
+	const bool CONTINUOUS_JOINTS[NUM_JOINTS] = { true, true, true, true, true, false };
+
+	// to - from of a joint angle [rad], the short way round for the continuous joints
+	inline double jointAngleDifference(size_t joint, double to, double from)
+	{
+		double difference = to - from;
+		if (CONTINUOUS_JOINTS[joint])
+			difference -= 2.0 * M_PI * floor(difference / (2.0 * M_PI) + 0.5);
+		return difference;
+	}
 
 } // namespace kinova
 
@@ -28,6 +28,7 @@
 
 #include <vector>
 #include <jaco/abstract_jaco.h>
+#include <jaco/message_pool.h>
 
 #include "ros/ros.h"
 #include "sensor_msgs/JointState.h"
@@ -38,15 +39,14 @@ namespace kinova
 	class JacoJointPublisher
 	{
 		public:
-			JacoJointPublisher(boost::shared_ptr<AbstractJaco>);
+			JacoJointPublisher(boost::shared_ptr<AbstractJaco>, ros::NodeHandle nh = ros::NodeHandle());
 			virtual ~JacoJointPublisher();
 		  	void update();			
 		private:
-                        std::vector<double> jointangles, joints_current, fingers_jointangle, fingers_current;
-			std::vector<double> pose;
 			boost::shared_ptr<AbstractJaco> jaco;
-                        ros::Publisher jtang_pub;                        
-                        std::vector<std::string> jointNames, fingers_jointName;
+                        ros::Publisher jtang_pub;
+                        // joint state messages with names and array sizes already set up
+                        boost::shared_ptr<MessagePool<sensor_msgs::JointState> > jtang_pool;
 	};
 
 }
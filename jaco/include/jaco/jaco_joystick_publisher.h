@@ -32,6 +32,7 @@
 
 #include <vector>
 #include <jaco/abstract_jaco.h>
+#include <jaco/message_pool.h>
 
 #include "ros/ros.h"
 #include "sensor_msgs/Joy.h"
@@ -42,12 +43,14 @@ namespace kinova
 	class JacoJoystickPublisher
 	{
 		public:
-			JacoJoystickPublisher(boost::shared_ptr<AbstractJaco>);
+			JacoJoystickPublisher(boost::shared_ptr<AbstractJaco>, ros::NodeHandle nh = ros::NodeHandle());
 			virtual ~JacoJoystickPublisher();
 		  	void update();			
 		private:
 			boost::shared_ptr<AbstractJaco> jaco;
             ros::Publisher joystick_pub;
+            // joy messages with axes and buttons already sized
+            boost::shared_ptr<MessagePool<sensor_msgs::Joy> > joystick_pool;
 
 	};
 
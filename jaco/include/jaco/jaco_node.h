@@ -30,11 +30,17 @@
 #include <jaco/abstract_jaco.h>
 #include <jaco/jaco_joint_publisher.h>
 #include <jaco/jaco_joystick_publisher.h>
+#include <jaco/jaco_pose_publisher.h>
+#include <jaco/jaco_singularity_publisher.h>
+#include <jaco/jaco_wrench_publisher.h>
+#include <jaco/jaco_twist_servo.h>
 #include <jaco/jaco.h>
 #include <jaco/jaco_action_controller.h>
 #include <jaco/gripper_controller.h>
 #include <std_msgs/String.h>
 #include <geometry_msgs/Point.h>
+#include <ros/callback_queue.h>
+#include <boost/thread/thread.hpp>
 
 //#include <jaco/armpose.h>
 namespace kinova
@@ -42,13 +48,36 @@ namespace kinova
 	class JacoNode
 	{
 		public:
-			JacoNode(char *CSharpDLL_path);
+			JacoNode(const char *CSharpDLL_path, ros::NodeHandle nh = ros::NodeHandle(), ros::NodeHandle pn = ros::NodeHandle("~"));
 			virtual ~JacoNode();
-                        int loop();
+                        void start();   // creates the publishers and action controllers
+                        void update();  // one cycle: read the arm state, publish it and update the controllers
+                        int loop();     // standalone executable: start() and update() at loop_rate until shutdown
+                        double getLoopRate() const;
                         bool apistate;  // to check whether jaco api is properly initialised
+                        bool configured;        // false if a safety parameter (the workspace fences) did not parse, the node must not run
 
 		private:
+			ros::NodeHandle nh_, pn_;
 			boost::shared_ptr<kinova::AbstractJaco> jaco;
+			boost::shared_ptr<JacoJointPublisher> jacoJointPublisher;
+			boost::shared_ptr<JacoJoystickPublisher> jacoJoystickPublisher;
+			boost::shared_ptr<JacoPosePublisher> jacoPosePublisher;
+			boost::shared_ptr<JacoSingularityPublisher> jacoSingularityPublisher;
+			boost::shared_ptr<JacoWrenchPublisher> jacoWrenchPublisher;
+			boost::shared_ptr<JacoActionController> jacoActionController;
+			boost::shared_ptr<GripperAction> gripper_controller;
+			boost::shared_ptr<JacoTwistServo> jacoTwistServo;
+			double loop_rate;
+
+			// the watchdog timers of the controllers run in a thread of their own, so they can stop the arm
+			// while update() or the callbacks of the loop are stuck
+			ros::CallbackQueue watchdog_queue;
+			boost::shared_ptr<boost::thread> watchdog_thread;
+			bool watchdog_running;
+			boost::mutex watchdog_mutex;	// guards watchdog_running, it is set here and read by the thread
+			bool isWatchdogRunning();
+			void watchdogLoop();
 
 
 					
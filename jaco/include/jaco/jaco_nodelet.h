@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_nodelet.h
+ *
+ *  PURPOSE ---  Runs the JacoNode inside a nodelet manager, so co-located nodelets get the
+ *               joint and joystick states without serialization
+ */
+
+#ifndef JACO_NODELET_H_
+#define JACO_NODELET_H_
+
+#include <nodelet/nodelet.h>
+#include <ros/callback_queue.h>
+#include <boost/thread/thread.hpp>
+#include <jaco/jaco_node.h>
+
+namespace kinova
+{
+	class JacoNodelet : public nodelet::Nodelet
+	{
+		public:
+			JacoNodelet();
+			virtual ~JacoNodelet();
+
+		private:
+			virtual void onInit();
+			void run();
+
+			// the driver runs in its own thread and serves its callbacks from its own queue,
+			// so the controllers see the same single threaded loop as in the jaco executable
+			ros::CallbackQueue queue;
+			boost::shared_ptr<boost::thread> worker;
+			std::string dll_path;
+			volatile bool running;
+	};
+}
+
+#endif /* JACO_NODELET_H_ */
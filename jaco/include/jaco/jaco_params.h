@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_params.h
+ *
+ *  PURPOSE ---  Lists of numbers read from the parameter server, shared by the node and its publishers
+ */
+
+
+#ifndef JACO_PARAMS_H_
+#define JACO_PARAMS_H_
+
+#include <ros/ros.h>
+
+#include <string>
+
+namespace kinova
+{
+	// an int or a double, false for anything else
+	bool toNumber(XmlRpc::XmlRpcValue& value, double& number);
+
+	// a list of count numbers, values are only written if it is well formed, false with an error otherwise
+	bool toList(XmlRpc::XmlRpcValue& list, const std::string& name, double values[], size_t count);
+
+	// the parameter name as a list of count numbers, false if it is not set or malformed; the values are kept then
+	bool readList(const ros::NodeHandle& pn, const std::string& name, double values[], size_t count);
+}
+
+#endif /* JACO_PARAMS_H_ */
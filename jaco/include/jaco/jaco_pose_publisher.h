@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_pose_publisher.h
+ *
+ *  PURPOSE ---  Broadcast the pose of the hand computed from the joint angles as tf transform
+ */
+
+#ifndef JACO_POSE_PUBLISHER_H_
+#define JACO_POSE_PUBLISHER_H_
+
+#include <string>
+#include <jaco/abstract_jaco.h>
+
+#include "ros/ros.h"
+#include "tf/transform_broadcaster.h"
+
+
+namespace kinova
+{
+	/**
+	*  Broadcasts the tool frame computed by the driver for every new sample. robot_state_publisher
+	*  already publishes jaco_gripper_tool_frame from joint_states, so the transform goes to a frame
+	*  of its own (~fk_child_frame_id) which is available without waiting for the joint_states round trip.
+	*/
+	class JacoPosePublisher
+	{
+		public:
+			JacoPosePublisher(boost::shared_ptr<AbstractJaco>, ros::NodeHandle pn = ros::NodeHandle("~"));
+			virtual ~JacoPosePublisher();
+		  	void update();			
+		private:
+			boost::shared_ptr<AbstractJaco> jaco;
+			tf::TransformBroadcaster broadcaster;
+			std::string frame_id, child_frame_id;
+			unsigned long last_sequence;	// only new samples are broadcast
+	};
+
+}
+
+#endif /* JACO_POSE_PUBLISHER_H_ */
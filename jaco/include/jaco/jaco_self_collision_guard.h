@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_self_collision_guard.h
+ *
+ *  PURPOSE ---  Rejects joint commands and stops the arm before its links collide, see JacoSelfCollision
+ */
+
+#ifndef JACO_SELF_COLLISION_GUARD_H_
+#define JACO_SELF_COLLISION_GUARD_H_
+
+#include <jaco/jaco_constants.h>
+
+namespace kinova
+{
+	/// \brief How close the links may get, see AbstractJaco::setSelfCollisionLimits().
+	struct JacoSelfCollisionLimits
+	{
+		bool enabled;
+		double margin;			// joint commands may not bring two links closer [m]
+		double stop_margin;		// the arm is stopped once the measured links are closer [m]
+		double velocity_lookahead;	// joint velocities are checked for the motion over this time [s]
+
+		JacoSelfCollisionLimits();
+	};
+
+	/**
+	*  The safety net on the command path of the driver: joint targets, the segments of joint
+	*  trajectories and streamed joint velocities are checked against the capsule model before
+	*  they are sent, the measured configuration after every read. A configuration that already
+	*  is closer than margin may only be left, paths from it may not get any closer.
+	*/
+	class JacoSelfCollisionGuard
+	{
+		public:
+			JacoSelfCollisionGuard();
+
+			void setLimits(const JacoSelfCollisionLimits& limits);
+			const JacoSelfCollisionLimits& getLimits() const;
+
+			// straight joint motions from start through count waypoints of NUM_JOINTS angles each
+			bool pathClear(const double start[NUM_JOINTS], const double *waypoints, size_t count) const;
+
+			// the motion with velocities [rad/s] for velocity_lookahead
+			bool velocityClear(const double start[NUM_JOINTS], const double velocities[NUM_JOINTS]) const;
+
+			// true if the measured clearance just fell below stop_margin, the arm has to be stopped then
+			bool update(const double q[NUM_JOINTS]);
+
+			// of the last update() [m], and the names of the two closest links
+			double getClearance() const;
+			void getClosestLinks(const char *&first, const char *&second) const;
+
+		private:
+			JacoSelfCollisionLimits limits_;
+			double clearance_;
+			size_t closest_pair_;
+			bool stopped_;		// below stop_margin, not reported again until it is left
+	};
+}
+
+#endif /* JACO_SELF_COLLISION_GUARD_H_ */
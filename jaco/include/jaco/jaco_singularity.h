@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_singularity.h
+ *
+ *  PURPOSE ---  How close the arm is to a singular configuration, and how much cartesian motions are slowed down there
+ */
+
+#ifndef JACO_SINGULARITY_H_
+#define JACO_SINGULARITY_H_
+
+#include <jaco/jaco_constants.h>
+
+namespace kinova
+{
+	/// \brief Singularity proximity of one sample, see JacoKinematics::manipulability().
+	struct JacoSingularityState
+	{
+		double manipulability;			// |det J| of jaco_gripper_tool_frame [m^3]
+		double translational_manipulability;	// of the linear rows of J only [m^3]
+		double rotational_manipulability;	// of the angular rows of J only
+
+		// as reported by the arm (GetSingularityVector), in its units
+		int singularity_count;			// translational singularities close by
+		int singularity_theta_count;		// orientation singularities close by
+		double singularity_distance;
+		double singularity_theta_distance;
+		double repulsion[POSE_SIZE];		// direction away from them, x y z theta x y z
+
+		double speed_scale;			// 1 far from any singularity, down to JacoSingularityLimits::min_speed_scale
+	};
+
+	/// \brief Where cartesian motions start to slow down, see AbstractJaco::setSingularityLimits().
+	struct JacoSingularityLimits
+	{
+		double manipulability_slow;		// full speed above
+		double manipulability_stop;		// min_speed_scale below, linear in between
+		double distance_slow;			// same for singularity_distance of the arm (down to 0), <= 0 to ignore it
+		double theta_distance_slow;		// same for singularity_theta_distance
+		double min_speed_scale;			// never stop completely, the arm has to be able to leave
+
+		JacoSingularityLimits();
+
+		// speed_scale for the other fields of state
+		double speedScale(const JacoSingularityState& state) const;
+	};
+}
+
+#endif /* JACO_SINGULARITY_H_ */
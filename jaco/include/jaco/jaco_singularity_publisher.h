@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_singularity_publisher.h
+ *
+ *  PURPOSE ---  Publishes the singularity proximity of every sample on jaco_singularity
+ */
+
+#ifndef JACO_SINGULARITY_PUBLISHER_H_
+#define JACO_SINGULARITY_PUBLISHER_H_
+
+#include <jaco/abstract_jaco.h>
+#include <jaco/message_pool.h>
+#include <jaco/JacoSingularity.h>
+
+#include "ros/ros.h"
+
+
+namespace kinova
+{
+	class JacoSingularityPublisher
+	{
+		public:
+			JacoSingularityPublisher(boost::shared_ptr<AbstractJaco>, ros::NodeHandle nh = ros::NodeHandle());
+			virtual ~JacoSingularityPublisher();
+		  	void update();			
+		private:
+			boost::shared_ptr<AbstractJaco> jaco;
+			ros::Publisher singularity_pub;
+			boost::shared_ptr<MessagePool<jaco::JacoSingularity> > singularity_pool;
+			unsigned long last_sequence;	// only new samples are published
+	};
+
+}
+
+#endif /* JACO_SINGULARITY_PUBLISHER_H_ */
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_state_estimator.h
+ *
+ *  PURPOSE ---  Velocities and accelerations of the joints and fingers from the sampled positions
+ */
+
+#ifndef JACO_STATE_ESTIMATOR_H_
+#define JACO_STATE_ESTIMATOR_H_
+
+#include <jaco/jaco_constants.h>
+
+namespace kinova
+{
+	/**
+	*  Savitzky-Golay differentiation over the last samples: a parabola is fitted to the
+	*  positions of each channel by least squares and differentiated at the newest sample. The
+	*  samples are not equally spaced, so the weights are computed from the timestamps once per
+	*  sample and shared by all channels. The joint angles are unwrapped, the fingers are not.
+	*/
+	class JacoStateEstimator
+	{
+		public:
+			static const size_t NUM_CHANNELS = NUM_JOINTS + NUM_FINGER_JOINTS;	// the joints first
+			static const size_t MAX_WINDOW = 32;
+
+			// window of samples the parabola is fitted to, 3 .. MAX_WINDOW
+			explicit JacoStateEstimator(size_t window = 7);
+
+			bool setWindow(size_t window);
+			size_t getWindow() const;
+
+			// the estimates start from zero again
+			void reset();
+
+			// positions [rad] of one acquisition at time [s], the window starts over after a gap in the samples
+			void update(double time, const double positions[NUM_CHANNELS]);
+
+			const double* getVelocities() const { return velocities_; }		// [rad/s]
+			const double* getAccelerations() const { return accelerations_; }	// [rad/s^2]
+
+		private:
+			size_t window_;
+			size_t count_;			// samples in the ring buffer
+			size_t newest_;			// index of the newest one
+			double times_[MAX_WINDOW];
+			double positions_[MAX_WINDOW][NUM_CHANNELS];	// joints unwrapped
+			double last_raw_[NUM_JOINTS];			// the joint angles as read, to unwrap the next ones
+
+			double velocities_[NUM_CHANNELS];
+			double accelerations_[NUM_CHANNELS];
+	};
+}
+
+#endif /* JACO_STATE_ESTIMATOR_H_ */
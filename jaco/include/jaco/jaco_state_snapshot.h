@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_state_snapshot.h
+ *
+ *  PURPOSE ---  Immutable, fixed size copy of everything read from the arm in one acquisition
+ */
+
+#ifndef JACO_STATE_SNAPSHOT_H_
+#define JACO_STATE_SNAPSHOT_H_
+
+#include <stdlib.h>
+#include <new>
+#include <boost/array.hpp>
+#include <boost/shared_ptr.hpp>
+#include <ros/time.h>
+#include <jaco/jaco_constants.h>
+#include <jaco/jaco_singularity.h>
+
+// snapshots are handed to other threads, keep each one on its own cache lines
+#define JACO_CACHE_LINE_SIZE 64
+
+namespace kinova
+{
+	/// \brief The state of the arm as read by one call of readJacoStatus().
+	struct __attribute__((aligned(JACO_CACHE_LINE_SIZE))) JacoStateSnapshot
+	{
+		ros::Time stamp;				// time of the acquisition
+		unsigned long sequence;				// increased by one for every acquisition
+
+		boost::array<double, NUM_JOINTS> joint_angles;
+		boost::array<double, NUM_JOINTS> joints_current;
+		boost::array<double, NUM_JOINTS> joint_velocities;		// estimated, see JacoStateEstimator
+		boost::array<double, NUM_JOINTS> joint_accelerations;
+		boost::array<double, NUM_FINGER_JOINTS> fingers_jointangle;
+		boost::array<double, NUM_FINGER_JOINTS> fingers_current;
+		boost::array<double, NUM_FINGER_JOINTS> fingers_velocity;
+		boost::array<double, NUM_FINGER_JOINTS> fingers_acceleration;
+		boost::array<double, POSE_SIZE> pose;		// jaco_gripper_tool_frame in jaco_base_link, see JacoKinematics::toPose()
+		int trajectory_number;				// trajectories still in the FIFO of the arm
+		JacoSingularityState singularity;
+
+		boost::array<bool, NUM_JOYSTICK_BUTTONS> joystick_button_states;
+		boost::array<double, NUM_JOYSTICK_AXES> joystick_axes_states;
+	};
+
+	typedef boost::shared_ptr<JacoStateSnapshot> JacoStateSnapshotPtr;
+	typedef boost::shared_ptr<const JacoStateSnapshot> JacoStateSnapshotConstPtr;
+
+	/**
+	*  Pool allocator honouring the alignment of the snapshot, which operator new does not
+	*  guarantee for over-aligned types.
+	*/
+	template <class T>
+	struct CacheAlignedAllocator
+	{
+		static boost::shared_ptr<T> create(const T& prototype)
+		{
+			void *memory = NULL;
+			if (posix_memalign(&memory, JACO_CACHE_LINE_SIZE, sizeof(T)) != 0)
+				throw std::bad_alloc();
+
+			return boost::shared_ptr<T>(new (memory) T(prototype), &CacheAlignedAllocator<T>::destroy);
+		}
+
+		static void destroy(T *object)
+		{
+			object->~T();
+			free(object);
+		}
+	};
+}
+
+#endif /* JACO_STATE_SNAPSHOT_H_ */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_tracking_controller.h
+ *
+ *  PURPOSE ---  Joint velocities following a reference: velocity feedforward and PID on the joint error
+ */
+
+#ifndef JACO_TRACKING_CONTROLLER_H_
+#define JACO_TRACKING_CONTROLLER_H_
+
+#include <jaco/jaco_constants.h>
+
+namespace kinova
+{
+	/// \brief Gains of one joint, the output is a joint velocity [rad/s].
+	struct JacoTrackingGains
+	{
+		double p;		// [1/s] on the position error
+		double i;		// [1/s^2] on its integral
+		double d;		// [1] on the velocity error
+		double i_clamp;		// largest velocity the integral term may contribute [rad/s]
+
+		JacoTrackingGains();
+	};
+
+	/**
+	*  The arm runs its own position loop, so it is commanded joint velocities: the velocity of the
+	*  reference plus a PID on the error to it. The derivative uses the velocity of the reference and
+	*  the estimated one of the joint instead of differentiating the error. The integral is clamped,
+	*  and it stops growing while the command saturates in the direction it would push (anti-windup).
+	*/
+	class JacoTrackingController
+	{
+		public:
+			JacoTrackingController();
+
+			void setGains(size_t joint, const JacoTrackingGains& gains);
+			const JacoTrackingGains& getGains(size_t joint) const;
+
+			// largest commanded joint velocity [rad/s], <= 0 for no limit
+			void setMaxVelocity(double max_velocity);
+
+			// the integrals start from zero
+			void reset();
+
+			// joint velocities to command for the reference (positions, velocities) after dt [s]
+			void update(double dt, const double desired[NUM_JOINTS], const double desired_velocities[NUM_JOINTS],
+				    const double actual[NUM_JOINTS], const double actual_velocities[NUM_JOINTS], double command[NUM_JOINTS]);
+
+		private:
+			JacoTrackingGains gains_[NUM_JOINTS];
+			double integral_[NUM_JOINTS];		// of the position error [rad s]
+			double max_velocity_;
+	};
+}
+
+#endif /* JACO_TRACKING_CONTROLLER_H_ */
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_trajectory_constraints.h
+ *
+ *  PURPOSE ---  Path, goal and goal time tolerances a joint trajectory is monitored with every cycle
+ */
+
+#ifndef JACO_TRAJECTORY_CONSTRAINTS_H_
+#define JACO_TRAJECTORY_CONSTRAINTS_H_
+
+#include <jaco/jaco_constants.h>
+
+namespace kinova
+{
+	/// \brief The tolerances of one goal, per joint in the order of the joint names of the arm.
+	/// As in control_msgs/JointTolerance, a tolerance <= 0 is not checked.
+	struct JacoTrajectoryConstraints
+	{
+		double path[NUM_JOINTS];		// position error while moving [rad]
+		double goal[NUM_JOINTS];		// position error to the last point [rad]
+		double goal_velocity[NUM_JOINTS];	// the arm has settled below these joint velocities [rad/s]
+		double goal_time;			// the goal has to be reached this long after the end of the trajectory [s]
+
+		JacoTrajectoryConstraints();
+
+		// the first joint out of its path tolerance, -1 if none
+		int pathViolation(const double error[NUM_JOINTS]) const;
+
+		// the first joint out of its goal tolerance or still moving, -1 if the arm settled at the goal
+		int goalViolation(const double error[NUM_JOINTS], const double velocities[NUM_JOINTS]) const;
+
+		// the path tolerances for JacoTrajectorySimplifier::deviation(), huge for the joints not checked
+		void pathTolerances(double tolerances[NUM_JOINTS]) const;
+	};
+}
+
+#endif /* JACO_TRAJECTORY_CONSTRAINTS_H_ */
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_trajectory_feeder.h
+ *
+ *  PURPOSE ---  Host side buffer streaming joint trajectories into the trajectory FIFO of the arm
+ */
+
+#ifndef JACO_TRAJECTORY_FEEDER_H_
+#define JACO_TRAJECTORY_FEEDER_H_
+
+#include <jaco/jaco_constants.h>
+
+#include <vector>
+
+namespace kinova
+{
+	/**
+	*  The FIFO of the arm only holds a few trajectory points, so a trajectory is kept here and
+	*  handed out in chunks whenever the FIFO has room. Only the first chunk is uploaded when the
+	*  trajectory is set, the rest follows with every read of the state, so the length of a
+	*  trajectory is not limited and the arm starts to move right away. The FIFO can only be erased
+	*  as a whole, so a new trajectory that shares the points still in it is spliced onto them.
+	*/
+	class JacoTrajectoryFeeder
+	{
+		public:
+			// used as long as the arm did not report the size of its FIFO
+			static const int DEFAULT_FIFO_SIZE = 50;
+
+			// at most chunk points are handed out at once, 0 to fill the FIFO completely
+			explicit JacoTrajectoryFeeder(size_t chunk = 20);
+
+			void setChunkSize(size_t chunk);
+			size_t getChunkSize() const;
+
+			// replaces the buffered trajectory, NUM_JOINTS angles per point
+			void load(const std::vector<double>& jointtrajectory);
+			void clear();
+
+			// points not handed out yet
+			size_t queued() const;
+			bool empty() const;
+
+			// the points to upload now for in_fifo points still in a FIFO of fifo_size (<= 0 if unknown),
+			// points is set to the first of them, they count as uploaded from here on
+			size_t take(int in_fifo, int fifo_size, const double*& points);
+
+			// whether trajectory passes within the tolerances [rad] of every joint through the in_fifo points
+			// still in the FIFO, in their order, tail is set to its first point after the last of them
+			bool findSplice(const std::vector<double>& trajectory, int in_fifo, const double tolerances[NUM_JOINTS], size_t& tail) const;
+
+			// the uploaded points are kept, the ones after them are replaced by trajectory from tail on
+			void splice(const std::vector<double>& trajectory, size_t tail);
+
+			// the in_fifo points still in the FIFO, NUM_JOINTS angles each
+			void fifoPoints(int in_fifo, std::vector<double>& points) const;
+
+			// the last point handed out, false if none was
+			bool lastUploaded(const double*& point) const;
+
+		private:
+			std::vector<double> points_;
+			size_t next_;			// first point not handed out
+			size_t chunk_;
+	};
+}
+
+#endif /* JACO_TRAJECTORY_FEEDER_H_ */
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_trajectory_interpolator.h
+ *
+ *  PURPOSE ---  Joint setpoints of a timed trajectory at any time between its points
+ */
+
+#ifndef JACO_TRAJECTORY_INTERPOLATOR_H_
+#define JACO_TRAJECTORY_INTERPOLATOR_H_
+
+#include <jaco/jaco_constants.h>
+
+#include <vector>
+
+namespace kinova
+{
+	/**
+	*  Piecewise polynomials through the points of a joint trajectory, as the joint_trajectory_controller
+	*  of ros_control does it: quintic segments where the accelerations are given, cubic ones where
+	*  only the velocities are, and cubic ones with velocities from the neighbouring points otherwise.
+	*  The trajectory rests at its first and last point before and after it.
+	*/
+	class JacoTrajectoryInterpolator
+	{
+		public:
+			JacoTrajectoryInterpolator();
+
+			// times [s] strictly increasing, NUM_JOINTS values per point for the others,
+			// velocities and accelerations may be empty, false if the sizes or times do not fit
+			bool setTrajectory(const std::vector<double>& times, const std::vector<double>& positions,
+					   const std::vector<double>& velocities, const std::vector<double>& accelerations);
+			void clear();
+
+			size_t size() const;			// points
+			double getStartTime() const;		// of the first point [s]
+			double getEndTime() const;		// of the last point [s]
+
+			// setpoint at time [s], velocities and accelerations may be NULL
+			void sample(double time, double positions[NUM_JOINTS], double velocities[NUM_JOINTS], double accelerations[NUM_JOINTS]) const;
+
+			// index of the point the segment at time ends with, size() after the end,
+			// O(1) when the times of the calls increase as in the control loop
+			size_t segmentEnd(double time) const;
+
+		private:
+			std::vector<double> times_;
+			std::vector<double> coefficients_;	// per segment and joint, 6 of a0 + a1 t + .. + a5 t^5
+			mutable size_t cursor_;			// segmentEnd() of the last call
+	};
+}
+
+#endif /* JACO_TRAJECTORY_INTERPOLATOR_H_ */
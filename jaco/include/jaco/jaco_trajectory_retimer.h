@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_trajectory_retimer.h
+ *
+ *  PURPOSE ---  Time-optimal timing of a joint path under joint velocity and acceleration limits
+ */
+
+#ifndef JACO_TRAJECTORY_RETIMER_H_
+#define JACO_TRAJECTORY_RETIMER_H_
+
+#include <jaco/jaco_constants.h>
+
+#include <vector>
+
+namespace kinova
+{
+	/**
+	*  Reachability analysis along the path (TOPP-RA): the points are joined by a smooth curve over
+	*  their chord length s, which is cut into a grid. Going backward from the end at rest, each grid
+	*  point gets the largest s velocity from which the rest of the path can still be followed within
+	*  the joint velocity and acceleration limits. Going forward from the start at rest, the largest
+	*  acceleration that stays below them is taken. Each grid point has two unknowns, s'^2 and s'',
+	*  so its constraints are intersected directly instead of solving a linear program.
+	*/
+	class JacoTrajectoryRetimer
+	{
+		public:
+			JacoTrajectoryRetimer();
+
+			// [rad/s] and [rad/s^2] of a joint, both > 0
+			void setLimits(size_t joint, double max_velocity, double max_acceleration);
+
+			// spacing of the grid along the path [rad], finer is closer to the optimum and slower
+			void setResolution(double step);
+
+			// the path through positions (NUM_JOINTS values per point) at the grid points in retimed, with their
+			// times [s] from 0 and velocities [rad/s]; false if the limits cannot be kept
+			bool retime(const std::vector<double>& positions, std::vector<double>& retimed, std::vector<double>& times,
+				    std::vector<double>& velocities) const;
+
+		private:
+			double max_velocity_[NUM_JOINTS];
+			double max_acceleration_[NUM_JOINTS];
+			double step_;
+
+			// the s accelerations allowed at x = s'^2 over an interval of length delta by the joint accelerations,
+			// false if none; d = q' and dd = q'' at its start and end
+			bool accelerationRange(const double *d, const double *dd, const double *d_next, const double *dd_next,
+					       double delta, double x, double& lower, double& upper) const;
+	};
+}
+
+#endif /* JACO_TRAJECTORY_RETIMER_H_ */
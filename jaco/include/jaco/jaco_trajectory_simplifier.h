@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_trajectory_simplifier.h
+ *
+ *  PURPOSE ---  Drops joint trajectory points the path does not need before they are uploaded
+ */
+
+#ifndef JACO_TRAJECTORY_SIMPLIFIER_H_
+#define JACO_TRAJECTORY_SIMPLIFIER_H_
+
+#include <jaco/jaco_constants.h>
+
+#include <vector>
+
+namespace kinova
+{
+	/**
+	*  Douglas-Peucker in joint space: a point is dropped if it lies within the tolerance of every joint
+	*  to the straight line between the points kept around it. The arm slows down at every point of its
+	*  FIFO, so a dense and nearly straight path from a planner runs faster and smoother with fewer of them.
+	*  The first and the last point are always kept.
+	*/
+	class JacoTrajectorySimplifier
+	{
+		public:
+			// trajectory and simplified hold NUM_JOINTS angles per point, tolerances [rad] per joint,
+			// a tolerance <= 0 keeps every point that joint is not exactly on the line with
+			static void simplify(const std::vector<double>& trajectory, const double tolerances[NUM_JOINTS], std::vector<double>& simplified);
+
+			// largest deviation of point from the line between start and end, as a multiple of the tolerances,
+			// the continuous joints measured the short way round
+			static double deviation(const double *start, const double *end, const double *point, const double tolerances[NUM_JOINTS]);
+	};
+}
+
+#endif /* JACO_TRAJECTORY_SIMPLIFIER_H_ */
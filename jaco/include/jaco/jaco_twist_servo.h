@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_twist_servo.h
+ *
+ *  PURPOSE ---  Streams joint velocities to the arm that follow the twist commands on servo/twist
+ */
+
+#ifndef JACO_TWIST_SERVO_H_
+#define JACO_TWIST_SERVO_H_
+
+#include <jaco/abstract_jaco.h>
+#include <jaco/jaco_action_controller.h>
+#include <geometry_msgs/TwistStamped.h>
+
+#include "ros/ros.h"
+
+
+namespace kinova
+{
+	/**
+	*  Cartesian servo mode. Every twist of jaco_gripper_tool_frame (in jaco_base_link or in
+	*  jaco_gripper_tool_frame itself) is turned into joint velocities by the damped least squares
+	*  inverse of the jacobian, which are sent to the arm once per cycle. The damping grows as the
+	*  manipulability falls below manipulability_threshold, so the arm slows down in the direction
+	*  of a singularity instead of speeding up. Once no twist came for timeout the arm is stopped.
+	*  The goals of the action controller own the arm, twists are ignored while one is active.
+	*/
+	class JacoTwistServo
+	{
+		public:
+			JacoTwistServo(boost::shared_ptr<AbstractJaco>, ros::NodeHandle nh = ros::NodeHandle(), ros::NodeHandle pn = ros::NodeHandle("~"),
+				       boost::shared_ptr<JacoActionController> controller = boost::shared_ptr<JacoActionController>());
+			virtual ~JacoTwistServo();
+		  	void update();
+		private:
+			boost::shared_ptr<AbstractJaco> jaco;
+			boost::shared_ptr<JacoActionController> controller;
+			bool armBusy() const;		// an arm goal of the controller is active
+			ros::Subscriber twist_sub;
+			void twistCB(const geometry_msgs::TwistStampedConstPtr& msg);
+
+			double twist[6];		// last command in jaco_base_link, linear then angular
+			bool twist_in_tool_frame;	// rotated to jaco_base_link with the pose of each cycle
+			ros::Time twist_time;		// when it was received, the stamp of the sender may be off
+			bool active;			// velocities are being streamed
+
+			double timeout;			// [s]
+			double damping;			// largest damping of the least squares inverse [m]
+			double manipulability_threshold;	// no damping above [m^3]
+			double max_joint_velocity;	// [rad/s], all joints are scaled down together
+			double max_linear_velocity;	// [m/s]
+			double max_angular_velocity;	// [rad/s]
+
+			void sendStop();
+	};
+
+}
+
+#endif /* JACO_TWIST_SERVO_H_ */
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_workspace.h
+ *
+ *  PURPOSE ---  Workspace fences in base_jaco the commands of the hand are checked against
+ */
+
+#ifndef JACO_WORKSPACE_H_
+#define JACO_WORKSPACE_H_
+
+#include <jaco/jaco_constants.h>
+
+#include <string>
+#include <vector>
+
+namespace kinova
+{
+	/// \brief What happens to a command that would take the hand through a fence.
+	enum JacoWorkspaceAction
+	{
+		WORKSPACE_REJECT,	// the command is not sent, streamed velocities stop
+		WORKSPACE_CLAMP,	// targets are moved onto the fence, streamed velocities stop at it
+		WORKSPACE_SLOW		// as clamp, and streamed velocities slow down within slow_distance of it
+	};
+
+	/// \brief A box, half space or vertical cylinder in base_jaco.
+	struct JacoWorkspaceFence
+	{
+		enum Type { BOX, PLANE, CYLINDER };
+
+		std::string name;
+		Type type;
+		bool keep_out;		// box and cylinder: the hand has to stay outside instead of inside
+		double lower[3];	// box corners
+		double upper[3];
+		double point[3];	// plane: a point on it, cylinder: the center of its bottom
+		double normal[3];	// plane: towards the allowed side, need not be normalised
+		double radius;		// cylinder
+		double height;
+
+		JacoWorkspaceFence();
+
+		// how far p is on the allowed side [m], negative if it is on the wrong side
+		double distance(const double p[3]) const;
+
+		// the closest point to p at least offset on the allowed side, p itself if it is there already,
+		// the corners of keep out boxes are treated as square
+		void project(const double p[3], double offset, double out[3]) const;
+	};
+
+	/// \brief How the fences are enforced, see AbstractJaco::setWorkspace().
+	struct JacoWorkspaceLimits
+	{
+		JacoWorkspaceAction action;
+		double padding;			// the hand is a sphere of this radius around the tool point [m]
+		double slow_distance;		// WORKSPACE_SLOW starts to slow down this far from a fence [m]
+		double velocity_lookahead;	// joint velocities are checked for the motion over this time [s]
+		double direction_lookahead;	// setRelPosition() directions are checked for this distance [m]
+		double api_origin[4];		// jaco_base_link in base_jaco: x, y, z [m], yaw [rad]
+
+		JacoWorkspaceLimits();
+	};
+
+	/**
+	*  Fences around the hand, enforced on the commands of the driver instead of in a planner, so
+	*  teleoperation and streamed commands are covered without a planning round trip. Joint
+	*  commands are followed with forward kinematics, cartesian ones are in base_jaco already.
+	*  Only the tool point, padded to the size of the hand, is checked. A hand that already is
+	*  on the wrong side of a fence may only move back, never further in.
+	*/
+	class JacoWorkspace
+	{
+		public:
+			JacoWorkspace();
+
+			void setLimits(const JacoWorkspaceLimits& limits);
+			const JacoWorkspaceLimits& getLimits() const;
+
+			void addFence(const JacoWorkspaceFence& fence);
+			void clearFences();
+			size_t size() const;
+			const JacoWorkspaceFence& fence(size_t index) const;
+
+			// smallest distance of the padded hand at p to any fence [m], HUGE_VAL without fences
+			double distance(const double p[3], size_t *closest = NULL) const;
+
+			// position of the tool point in base_jaco for the joint angles q
+			void toolPosition(const double q[NUM_JOINTS], double p[3]) const;
+
+			// straight joint motions from start through count waypoints of NUM_JOINTS angles each, never altered
+			bool jointPathAllowed(const double start[NUM_JOINTS], const double *waypoints, size_t count) const;
+
+			// straight motions of the hand from start through count positions (x, y, z each), never altered
+			bool positionPathAllowed(const double start[3], const double *positions, size_t count) const;
+
+			// straight motion of the hand from start to target, target is moved onto the fences unless the action is reject
+			bool positionAllowed(const double start[3], double target[3]) const;
+
+			// setRelPosition() direction from start, the axes moving through a fence are zeroed unless the action is reject
+			bool directionAllowed(const double start[3], double direction[3]) const;
+
+			// factor in [0, 1] for the joint velocities [rad/s] at q
+			double velocityScale(const double q[NUM_JOINTS], const double velocities[NUM_JOINTS]) const;
+
+		private:
+			// a straight line of the hand stays at least min(0, distance at from) from the fences
+			bool lineAllowed(const double from[3], const double to[3]) const;
+
+			JacoWorkspaceLimits limits_;
+			std::vector<JacoWorkspaceFence> fences_;
+	};
+}
+
+#endif /* JACO_WORKSPACE_H_ */
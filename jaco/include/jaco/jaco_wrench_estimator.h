@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_wrench_estimator.h
+ *
+ *  PURPOSE ---  External joint torques and the wrench on the hand from the joint currents
+ */
+
+#ifndef JACO_WRENCH_ESTIMATOR_H_
+#define JACO_WRENCH_ESTIMATOR_H_
+
+#include <jaco/jaco_constants.h>
+
+namespace kinova
+{
+	/// \brief Mass of a body [kg] and its center of mass in the frame of the body [m].
+	struct JacoMass
+	{
+		double mass;
+		double com[3];
+	};
+
+	/// \brief Static model of the arm, see config/wrench.yaml.
+	struct JacoWrenchModel
+	{
+		JacoMass links[NUM_JOINTS];		// jaco_link_1 .. jaco_link_6, the hand is part of jaco_link_6
+		JacoMass payload;			// in jaco_gripper_tool_frame
+		double gravity[3];			// in jaco_base_link [m/s^2]
+		double torque_constants[NUM_JOINTS];	// joint torque per actuator current [Nm/A]
+
+		// rough masses of the datasheet, centers of mass of the collision meshes
+		JacoWrenchModel();
+	};
+
+	/**
+	*  The arm has no torque sensors, but it holds itself with the joint currents. What the
+	*  motors deliver beyond the gravity torques of the model is taken as external torque, and
+	*  the wrench on the tool frame is the one that balances it through the jacobian. The
+	*  estimate is only meaningful while the arm moves slowly (no inertia and friction model),
+	*  the torque offsets of the actuators are taken out with tare().
+	*/
+	class JacoWrenchEstimator
+	{
+		public:
+			JacoWrenchEstimator();
+
+			void setModel(const JacoWrenchModel& model);
+			const JacoWrenchModel& getModel() const;
+
+			// of the jacobian near singularities, see JacoKinematics::dampedWrench()
+			void setDamping(double damping);
+
+			// of the low pass on the external torques [s], 0 for none
+			void setTimeConstant(double time_constant);
+
+			// torques the motors need to hold the arm and the payload at q [Nm]
+			void gravityTorques(const double q[NUM_JOINTS], double torques[NUM_JOINTS]) const;
+
+			// nothing touches the arm in this sample, its external torques become the offsets
+			void tare(const double q[NUM_JOINTS], const double currents[NUM_JOINTS]);
+
+			// one sample at time [s], currents [A] along the urdf joints
+			void update(double time, const double q[NUM_JOINTS], const double currents[NUM_JOINTS]);
+
+			const double* getExternalTorques() const { return external_torques_; }	// [Nm]
+			const double* getWrench() const { return wrench_; }			// on the tool, in jaco_gripper_tool_frame [N, Nm]
+
+			// mass [kg] that would pull the tool down with the estimated force, for payload checks
+			double getPayloadMass() const { return payload_mass_; }
+
+		private:
+			// hold - motor torques
+			void rawExternalTorques(const double q[NUM_JOINTS], const double currents[NUM_JOINTS], double torques[NUM_JOINTS]) const;
+
+			JacoWrenchModel model_;
+			double damping_;
+			double time_constant_;
+			double offsets_[NUM_JOINTS];
+			double last_time_;
+			bool initialised_;
+
+			double external_torques_[NUM_JOINTS];
+			double wrench_[6];
+			double payload_mass_;
+	};
+}
+
+#endif /* JACO_WRENCH_ESTIMATOR_H_ */
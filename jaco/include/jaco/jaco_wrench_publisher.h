@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_wrench_publisher.h
+ *
+ *  PURPOSE ---  Publishes the wrench on the hand estimated from the joint currents
+ */
+
+#ifndef JACO_WRENCH_PUBLISHER_H_
+#define JACO_WRENCH_PUBLISHER_H_
+
+#include <jaco/abstract_jaco.h>
+#include <jaco/message_pool.h>
+#include <jaco/jaco_wrench_estimator.h>
+#include <geometry_msgs/WrenchStamped.h>
+#include <std_msgs/Empty.h>
+#include <std_msgs/Float64.h>
+
+#include "ros/ros.h"
+
+
+namespace kinova
+{
+	/**
+	*  Runs a JacoWrenchEstimator on every sample of the arm and publishes the wrench on
+	*  jaco_gripper_tool_frame (tool_wrench) and the payload it amounts to (estimated_payload).
+	*  The model is read from ~wrench (config/wrench.yaml). The first sample and every sample
+	*  after a message on wrench/tare are taken as free of contact.
+	*/
+	class JacoWrenchPublisher
+	{
+		public:
+			JacoWrenchPublisher(boost::shared_ptr<AbstractJaco>, ros::NodeHandle nh = ros::NodeHandle(), ros::NodeHandle pn = ros::NodeHandle("~"));
+			virtual ~JacoWrenchPublisher();
+		  	void update();
+		private:
+			boost::shared_ptr<AbstractJaco> jaco;
+			ros::Publisher wrench_pub;
+			ros::Publisher payload_pub;
+			ros::Subscriber tare_sub;
+			boost::shared_ptr<MessagePool<geometry_msgs::WrenchStamped> > wrench_pool;
+			unsigned long last_sequence;	// only new samples are estimated
+
+			JacoWrenchEstimator estimator;
+			bool tare_requested;		// on the next sample
+
+			void tareCB(const std_msgs::EmptyConstPtr& msg);
+	};
+
+}
+
+#endif /* JACO_WRENCH_PUBLISHER_H_ */
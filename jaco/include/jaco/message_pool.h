@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- message_pool.h
+ *
+ *  PURPOSE ---  Pool of preallocated, recycled messages for the publishers
+ */
+
+#ifndef MESSAGE_POOL_H_
+#define MESSAGE_POOL_H_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+
+namespace kinova
+{
+	/**
+	*  Default way for the pool to create its entries.
+	*/
+	template <class M>
+	struct MessageAllocator
+	{
+		static boost::shared_ptr<M> create(const M& prototype)
+		{
+			return boost::make_shared<M>(prototype);
+		}
+	};
+
+	/**
+	*  Keeps a small ring of messages which are copied once from a prototype (so names and
+	*  array sizes are set up front) and handed out again as soon as nobody else holds them.
+	*  roscpp serializes a message for remote subscribers inside publish(), so a message is
+	*  only kept alive afterwards by intra-process subscribers, which keeps the ring small.
+	*/
+	template <class M, class Allocator = MessageAllocator<M> >
+	class MessagePool
+	{
+		public:
+			typedef boost::shared_ptr<M> MessagePtr;
+
+			/**
+			* @param prototype message every pool entry is copied from.
+			* @param size number of messages allocated up front.
+			* @param max_size upper bound the pool may grow to if all entries are still in use.
+			*/
+			MessagePool(const M& prototype, size_t size, size_t max_size) : prototype_(Allocator::create(prototype)), max_size_(max_size), next_(0)
+			{
+				pool_.reserve(max_size_);
+				for (size_t i = 0; i < size && i < max_size_; i++)
+					pool_.push_back(Allocator::create(*prototype_));
+			}
+
+			/**
+			* Returns a message nobody else references. Its content is the one of the last time it
+			* was used, so callers overwrite every field they publish.
+			*/
+			MessagePtr acquire()
+			{
+				for (size_t i = 0; i < pool_.size(); i++)
+				{
+					MessagePtr& msg = pool_[next_];
+					next_ = (next_ + 1) % pool_.size();
+
+					if (msg.unique())
+						return msg;
+				}
+
+				// every message is still queued somewhere, grow the pool up to its limit
+				MessagePtr msg = Allocator::create(*prototype_);
+				if (pool_.size() < max_size_)
+					pool_.push_back(msg);
+
+				return msg;
+			}
+
+		private:
+			// kept behind a pointer so the pool itself never needs the alignment of M
+			MessagePtr prototype_;
+			std::vector<MessagePtr> pool_;
+			size_t max_size_;
+			size_t next_;
+	};
+}
+
+#endif /* MESSAGE_POOL_H_ */
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- state_shm.h
+ *
+ *  PURPOSE ---  Shared memory ring buffer of arm states for local processes, writer and reader side.
+ *               Does not depend on ROS, so monitors and loggers only link against jaco_state_shm.
+ */
+
+#ifndef STATE_SHM_H_
+#define STATE_SHM_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include <jaco/jaco_constants.h>
+
+namespace boost { namespace interprocess { class mapped_region; } }
+
+namespace kinova
+{
+	// default name of the segment (/dev/shm/jaco_state) and number of samples kept in it
+	const char * const STATE_SHM_DEFAULT_NAME = "jaco_state";
+	const size_t STATE_SHM_DEFAULT_CAPACITY = 1024;
+
+	/// \brief One sample of the arm state as stored in shared memory. Plain data only.
+	struct JacoShmSample
+	{
+		uint32_t stamp_sec;				// ros::Time of the acquisition
+		uint32_t stamp_nsec;
+		uint64_t sequence;				// sequence number of the acquisition, starts at 1
+
+		double joint_angles[NUM_JOINTS];
+		double joints_current[NUM_JOINTS];
+		double fingers_jointangle[NUM_FINGER_JOINTS];
+		double fingers_current[NUM_FINGER_JOINTS];
+		double pose[POSE_SIZE];				// x, y, z, euler angles Rx * Ry * Rz of the tool frame in jaco_base_link
+		int32_t trajectory_number;			// trajectories still in the FIFO of the arm
+
+		uint8_t joystick_button_states[NUM_JOYSTICK_BUTTONS];
+		double joystick_axes_states[NUM_JOYSTICK_AXES];
+	};
+
+	struct JacoShmHeader;
+	struct JacoShmSlot;
+
+	/**
+	*  Creates the segment and appends samples to it. There must be only one writer per segment.
+	*  Each slot is guarded by a sequence lock, so the writer never waits for readers.
+	*/
+	class StateShmWriter
+	{
+		public:
+			StateShmWriter(const std::string& name = STATE_SHM_DEFAULT_NAME, size_t capacity = STATE_SHM_DEFAULT_CAPACITY);
+			~StateShmWriter();		// removes the segment, readers which have it mapped keep their copy
+
+			bool isOpen() const;
+			void write(const JacoShmSample& sample);
+
+		private:
+			std::string name_;
+			boost::shared_ptr<boost::interprocess::mapped_region> region_;
+			JacoShmHeader *header_;
+			JacoShmSlot *slots_;
+	};
+
+	/**
+	*  Maps an existing segment read only. Readers never block the writer; a read which
+	*  overlaps with the writer is retried, a sample overwritten meanwhile is skipped.
+	*/
+	class StateShmReader
+	{
+		public:
+			StateShmReader(const std::string& name = STATE_SHM_DEFAULT_NAME);
+
+			bool open();			// retries to map the segment, e.g. if the driver was started later
+			bool isOpen() const;
+			size_t capacity() const;
+
+			// total number of samples written since the segment was created
+			uint64_t writeCount() const;
+
+			// latest sample, false if nothing was written yet
+			bool readLatest(JacoShmSample& sample) const;
+
+			// up to max_samples most recent samples, oldest first
+			size_t readHistory(std::vector<JacoShmSample>& samples, size_t max_samples) const;
+
+			// appends the samples written since position (a previous writeCount()) and advances it,
+			// samples already overwritten by the writer are skipped. For loggers which poll.
+			size_t readNew(uint64_t& position, std::vector<JacoShmSample>& samples) const;
+
+		private:
+			bool readSlot(uint64_t index, JacoShmSample& sample) const;
+
+			std::string name_;
+			boost::shared_ptr<boost::interprocess::mapped_region> region_;
+			const JacoShmHeader *header_;
+			const JacoShmSlot *slots_;
+	};
+}
+
+#endif /* STATE_SHM_H_ */
@@ -24,9 +24,16 @@
  */
 
 #include <jaco/abstract_jaco.h>
+#include <jaco_kinematics/jaco_kinematics.h>
+
+#include <math.h>
 
 namespace kinova
 {
+	// snapshots allocated up front / maximum the pool grows to while readers keep old snapshots
+	const size_t SNAPSHOT_POOL_SIZE = 4;
+	const size_t SNAPSHOT_POOL_MAX_SIZE = 64;
+
 	AbstractJaco::AbstractJaco()
 	{
 		// joint names
@@ -42,16 +49,32 @@ namespace kinova
                 joints_current_.resize(NUM_JOINTS, 0.0);
                 fingers_jointangle_.resize(NUM_FINGER_JOINTS, 0.0);
                 fingers_current_.resize(NUM_FINGER_JOINTS, 0.0);
-		pose_.resize(6, 0.0);
+		pose_.resize(POSE_SIZE, 0.0);
+		api_pose_.resize(POSE_SIZE, 0.0);
 
-		joystick_button_states_.resize(7, false);
-		joystick_axes_states_.resize(3, 0.0);
+		joystick_button_states_.resize(NUM_JOYSTICK_BUTTONS, false);
+		joystick_axes_states_.resize(NUM_JOYSTICK_AXES, 0.0);
 
 		trajnum_ = 0;
+		trajfifo_size_ = 0;
+
+		singularity_.manipulability = 0.0;
+		singularity_.translational_manipulability = 0.0;
+		singularity_.rotational_manipulability = 0.0;
+		singularity_.singularity_count = 0;
+		singularity_.singularity_theta_count = 0;
+		singularity_.singularity_distance = 0.0;
+		singularity_.singularity_theta_distance = 0.0;
+		for (size_t i = 0; i < POSE_SIZE; i++)
+			singularity_.repulsion[i] = 0.0;
+		singularity_.speed_scale = 1.0;
 
 
 
-		joint_velocities_.resize(NUM_JOINTS);
+		joint_velocities_.resize(NUM_JOINTS, 0.0);
+		joint_accelerations_.resize(NUM_JOINTS, 0.0);
+		fingers_velocity_.resize(NUM_FINGER_JOINTS, 0.0);
+		fingers_acceleration_.resize(NUM_FINGER_JOINTS, 0.0);
 	 
 		/* ********* get parameters ********* */	  	
 	  	ros::NodeHandle n;	
@@ -74,6 +97,28 @@ namespace kinova
 		link_names_.at(4) = "jaco_link_5";
 		link_names_.at(5) = "jaco_link_6";
 
+		// state snapshots, readers get an all zero state until the first acquisition
+		JacoStateSnapshot prototype;
+		prototype.stamp = ros::Time(0);
+		prototype.sequence = 0;
+		prototype.joint_angles.assign(0.0);
+		prototype.joints_current.assign(0.0);
+		prototype.joint_velocities.assign(0.0);
+		prototype.joint_accelerations.assign(0.0);
+		prototype.fingers_jointangle.assign(0.0);
+		prototype.fingers_current.assign(0.0);
+		prototype.fingers_velocity.assign(0.0);
+		prototype.fingers_acceleration.assign(0.0);
+		prototype.pose.assign(0.0);
+		prototype.trajectory_number = 0;
+		prototype.singularity = singularity_;
+		prototype.joystick_button_states.assign(false);
+		prototype.joystick_axes_states.assign(0.0);
+
+		snapshot_pool_.reset(new SnapshotPool(prototype, SNAPSHOT_POOL_SIZE, SNAPSHOT_POOL_MAX_SIZE));
+		latest_snapshot_ = snapshot_pool_->acquire();
+		snapshot_sequence_ = 0;
+		streaming_velocities_ = false;
 	  	
 
 	  }
@@ -82,49 +127,365 @@ namespace kinova
 	{
 	}	
 
-	std::vector<double> AbstractJaco::getJointAngles()
+	const std::vector<double>& AbstractJaco::getJointAngles() const
 	{
 		return joint_angles_;
 	}
-        std::vector<double> AbstractJaco::getJointsCurrent()
+        const std::vector<double>& AbstractJaco::getJointsCurrent() const
         {
                 return joints_current_;
         }
 
-	std::vector<double> AbstractJaco::getFingersJointAngle()
+	const std::vector<double>& AbstractJaco::getFingersJointAngle() const
 	{
                 return fingers_jointangle_;
 	}
 	
-	std::vector<double> AbstractJaco::getFingersCurrent()
+	const std::vector<double>& AbstractJaco::getFingersCurrent() const
 	{
                 return fingers_current_;
 	}
 
-	std::vector<double> AbstractJaco::getPose()
+	const std::vector<double>& AbstractJaco::getJointVelocities() const
+	{
+		return joint_velocities_;
+	}
+
+	const std::vector<double>& AbstractJaco::getJointAccelerations() const
+	{
+		return joint_accelerations_;
+	}
+
+	const std::vector<double>& AbstractJaco::getFingersVelocity() const
+	{
+		return fingers_velocity_;
+	}
+
+	const std::vector<double>& AbstractJaco::getFingersAcceleration() const
+	{
+		return fingers_acceleration_;
+	}
+
+	const std::vector<double>& AbstractJaco::getPose() const
 	{
 		return pose_;
 	}
 
-	int AbstractJaco::getCurrentTrajectoryNumber()
+	const std::vector<double>& AbstractJaco::getApiPose() const
+	{
+		return api_pose_;
+	}
+
+	int AbstractJaco::getCurrentTrajectoryNumber() const
 	{
 		return trajnum_;
 	}
 
-	std::vector<std::string> AbstractJaco::getJointNames()
+	int AbstractJaco::getQueuedTrajectoryNumber() const
+	{
+		return trajectory_feeder_.queued() + pose_trajectory_feeder_.queued();
+	}
+
+	int AbstractJaco::getTrajectoryFifoSize() const
+	{
+		return trajfifo_size_;
+	}
+
+	const JacoSingularityState& AbstractJaco::getSingularityState() const
+	{
+		return singularity_;
+	}
+
+	void AbstractJaco::setSingularityLimits(const JacoSingularityLimits& limits)
+	{
+		singularity_limits_ = limits;
+	}
+
+	bool AbstractJaco::setVelocityEstimationWindow(size_t window)
+	{
+		return state_estimator_.setWindow(window);
+	}
+
+	void AbstractJaco::setJointCalibration(const JacoCalibration& calibration)
+	{
+		calibration_ = calibration;
+	}
+
+	const JacoCalibration& AbstractJaco::getJointCalibration() const
+	{
+		return calibration_;
+	}
+
+	void AbstractJaco::setSelfCollisionLimits(const JacoSelfCollisionLimits& limits)
+	{
+		self_collision_.setLimits(limits);
+	}
+
+	double AbstractJaco::getSelfCollisionClearance() const
+	{
+		return self_collision_.getClearance();
+	}
+
+	void AbstractJaco::setWorkspace(const JacoWorkspace& workspace)
+	{
+		workspace_ = workspace;
+	}
+
+	const JacoWorkspace& AbstractJaco::getWorkspace() const
+	{
+		return workspace_;
+	}
+
+	void AbstractJaco::setTrajectoryChunkSize(size_t chunk)
+	{
+		trajectory_feeder_.setChunkSize(chunk);
+		pose_trajectory_feeder_.setChunkSize(chunk);
+	}
+
+	const std::vector<std::string>& AbstractJaco::getJointNames() const
 	{
                 return joints_name_;
 	}
 
-        std::vector<std::string> AbstractJaco::getFingersJointName()
+        const std::vector<std::string>& AbstractJaco::getFingersJointName() const
 	{
                 return fingers_jointname_;
 	}
 
 
-	std::vector<std::string> AbstractJaco::getLinkNames()
+	const std::vector<std::string>& AbstractJaco::getLinkNames() const
 	{
 	  	return link_names_;
 	}	
+
+	JacoStateSnapshotConstPtr AbstractJaco::getStateSnapshot() const
+	{
+		boost::mutex::scoped_lock lock(snapshot_mutex_);
+		return latest_snapshot_;
+	}
+
+	bool AbstractJaco::stopFingers()
+	{
+		// the state is in radians, finger commands are in degrees
+		double fingers[NUM_FINGER_JOINTS];
+		for (size_t j = 0; j < NUM_FINGER_JOINTS; j++)
+			fingers[j] = fingers_jointangle_[j] * 180.0 / M_PI;
+		return setFingersValues(fingers);
+	}
+
+	bool AbstractJaco::isStreamingJointVelocities(ros::Time& last_command) const
+	{
+		boost::mutex::scoped_lock lock(command_mutex_);
+		last_command = velocity_command_time_;
+		return streaming_velocities_;
+	}
+
+	void AbstractJaco::recordJointVelocities(const double velocities[])
+	{
+		bool moving = false;
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			if (velocities[i] != 0.0)
+				moving = true;
+
+		boost::mutex::scoped_lock lock(command_mutex_);
+		velocity_command_time_ = ros::Time::now();
+		streaming_velocities_ = moving;
+	}
+
+	void AbstractJaco::updateForwardKinematics()
+	{
+		double q[NUM_JOINTS];
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			q[i] = joint_angles_[i];
+
+		JacoFrame tool;
+		JacoKinematics::forward(q, tool);
+		JacoKinematics::toPose(tool, &pose_[0]);
+	}
+
+	void AbstractJaco::updateSingularity()
+	{
+		double q[NUM_JOINTS], J[6 * NUM_JOINTS];
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			q[i] = joint_angles_[i];
+
+		JacoKinematics::jacobian(q, J);
+		singularity_.manipulability = JacoKinematics::manipulability(J, singularity_.translational_manipulability, singularity_.rotational_manipulability);
+		singularity_.speed_scale = singularity_limits_.speedScale(singularity_);
+	}
+
+	bool AbstractJaco::jointPathClear(const double *waypoints, size_t count) const
+	{
+		double q[NUM_JOINTS];
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			q[i] = joint_angles_[i];
+
+		return self_collision_.pathClear(q, waypoints, count);
+	}
+
+	bool AbstractJaco::jointVelocitiesClear(const double velocities[]) const
+	{
+		double q[NUM_JOINTS];
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			q[i] = joint_angles_[i];
+
+		return self_collision_.velocityClear(q, velocities);
+	}
+
+	bool AbstractJaco::updateSelfCollision()
+	{
+		double q[NUM_JOINTS];
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			q[i] = joint_angles_[i];
+
+		return self_collision_.update(q);
+	}
+
+	bool AbstractJaco::jointPathInWorkspace(const double *waypoints, size_t count) const
+	{
+		double q[NUM_JOINTS];
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			q[i] = joint_angles_[i];
+
+		return workspace_.jointPathAllowed(q, waypoints, count);
+	}
+
+	bool AbstractJaco::posePathInWorkspace(const double *poses, size_t count) const
+	{
+		std::vector<double> positions(3 * count);
+		for (size_t i = 0; i < count; i++)
+			for (size_t k = 0; k < 3; k++)
+				positions[3 * i + k] = poses[POSE_SIZE * i + k];
+
+		return count == 0 || workspace_.positionPathAllowed(&api_pose_[0], &positions[0], count);
+	}
+
+	bool AbstractJaco::poseInWorkspace(double pose[]) const
+	{
+		return workspace_.positionAllowed(&api_pose_[0], pose);
+	}
+
+	bool AbstractJaco::directionInWorkspace(double direction[]) const
+	{
+		return workspace_.directionAllowed(&api_pose_[0], direction);
+	}
+
+	double AbstractJaco::workspaceVelocityScale(const double velocities[]) const
+	{
+		double q[NUM_JOINTS];
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			q[i] = joint_angles_[i];
+
+		return workspace_.velocityScale(q, velocities);
+	}
+
+	void AbstractJaco::publishStateSnapshot()
+	{
+		// the entry we get is referenced by the pool only, so it can be filled without the lock
+		JacoStateSnapshotPtr snapshot = snapshot_pool_->acquire();
+
+		snapshot->stamp = ros::Time::now();
+		snapshot->sequence = ++snapshot_sequence_;
+
+		// differentiated over the acquisition times, the arm does not report velocities
+		double positions[JacoStateEstimator::NUM_CHANNELS];
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			positions[i] = joint_angles_[i];
+		for (size_t i = 0; i < NUM_FINGER_JOINTS; i++)
+			positions[NUM_JOINTS + i] = fingers_jointangle_[i];
+		state_estimator_.update(snapshot->stamp.toSec(), positions);
+
+		const double *velocities = state_estimator_.getVelocities();
+		const double *accelerations = state_estimator_.getAccelerations();
+
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+		{
+			joint_velocities_[i] = velocities[i];
+			joint_accelerations_[i] = accelerations[i];
+
+			snapshot->joint_angles[i] = joint_angles_[i];
+			snapshot->joints_current[i] = joints_current_[i];
+			snapshot->joint_velocities[i] = joint_velocities_[i];
+			snapshot->joint_accelerations[i] = joint_accelerations_[i];
+		}
+
+		for (size_t i = 0; i < NUM_FINGER_JOINTS; i++)
+		{
+			fingers_velocity_[i] = velocities[NUM_JOINTS + i];
+			fingers_acceleration_[i] = accelerations[NUM_JOINTS + i];
+
+			snapshot->fingers_jointangle[i] = fingers_jointangle_[i];
+			snapshot->fingers_current[i] = fingers_current_[i];
+			snapshot->fingers_velocity[i] = fingers_velocity_[i];
+			snapshot->fingers_acceleration[i] = fingers_acceleration_[i];
+		}
+
+		for (size_t i = 0; i < POSE_SIZE; i++)
+			snapshot->pose[i] = pose_[i];
+
+		snapshot->trajectory_number = trajnum_;
+		snapshot->singularity = singularity_;
+
+		for (size_t i = 0; i < NUM_JOYSTICK_BUTTONS; i++)
+			snapshot->joystick_button_states[i] = joystick_button_states_[i];
+
+		for (size_t i = 0; i < NUM_JOYSTICK_AXES; i++)
+			snapshot->joystick_axes_states[i] = joystick_axes_states_[i];
+
+		{
+			boost::mutex::scoped_lock lock(snapshot_mutex_);
+			latest_snapshot_ = snapshot;
+		}
+
+		if (state_shm_)
+			writeSharedMemory(*snapshot);
+	}
+
+	bool AbstractJaco::enableStateSharedMemory(const std::string& name, size_t capacity)
+	{
+		state_shm_.reset(new StateShmWriter(name, capacity));
+		if (!state_shm_->isOpen())
+		{
+			state_shm_.reset();
+			return false;
+		}
+
+		ROS_INFO("Publishing the arm state to shared memory segment %s (%lu samples)", name.c_str(), (unsigned long)capacity);
+		return true;
+	}
+
+	void AbstractJaco::writeSharedMemory(const JacoStateSnapshot& snapshot)
+	{
+		JacoShmSample sample;
+
+		sample.stamp_sec = snapshot.stamp.sec;
+		sample.stamp_nsec = snapshot.stamp.nsec;
+		sample.sequence = snapshot.sequence;
+
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+		{
+			sample.joint_angles[i] = snapshot.joint_angles[i];
+			sample.joints_current[i] = snapshot.joints_current[i];
+		}
+
+		for (size_t i = 0; i < NUM_FINGER_JOINTS; i++)
+		{
+			sample.fingers_jointangle[i] = snapshot.fingers_jointangle[i];
+			sample.fingers_current[i] = snapshot.fingers_current[i];
+		}
+
+		for (size_t i = 0; i < POSE_SIZE; i++)
+			sample.pose[i] = snapshot.pose[i];
+
+		sample.trajectory_number = snapshot.trajectory_number;
+
+		for (size_t i = 0; i < NUM_JOYSTICK_BUTTONS; i++)
+			sample.joystick_button_states[i] = snapshot.joystick_button_states[i];
+
+		for (size_t i = 0; i < NUM_JOYSTICK_AXES; i++)
+			sample.joystick_axes_states[i] = snapshot.joystick_axes_states[i];
+
+		state_shm_->write(sample);
+	}
 }
 
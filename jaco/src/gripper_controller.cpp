@@ -32,31 +32,40 @@
 // Purpose: Interface from moveit gripper_command to jaco api.
 
 #include "jaco/gripper_controller.h"
+#include <algorithm>
 
 namespace kinova
 {
 
- GripperAction::GripperAction(boost::shared_ptr<AbstractJaco> jaco) :
-    node_(ros::NodeHandle()),
+ GripperAction::GripperAction(boost::shared_ptr<AbstractJaco> jaco, ros::NodeHandle nh, ros::NodeHandle pn, ros::NodeHandle wn) :
+    node_(nh),
     jaco_(jaco),
     action_server_(node_, "jaco_gripper_controller/gripper_command",
                    boost::bind(&GripperAction::goalCB, this, _1),
                    boost::bind(&GripperAction::cancelCB, this, _1), true),
-    has_active_goal_(false)
+    has_active_goal_(false),
+    watchdog_armed_(false),
+    watchdog_tripped_(false)
   {
-	 ros::NodeHandle pn("~");
-
 
      pn.param("goal_position_threshold", goal_position_threshold_, 0.1);
      pn.param("goal_effort_threshold", goal_effort_threshold_, 0.05);
-     pn.param("stall_velocity_threshold", stall_velocity_threshold_, 1e-6);
+     pn.param("stall_velocity_threshold", stall_velocity_threshold_, 0.02);
      pn.param("stall_timeout", stall_timeout_, 5.0);
 
+     // the fingers move through the FIFO of the arm, which the watchdog erases once the state is not read any more
+     double watchdog_period;
+     pn.param("watchdog/period", watchdog_period, 0.005);
+     pn.param("watchdog/state_timeout", state_timeout_, 0.05);
+     if (watchdog_period > 0.0 && state_timeout_ > 0.0)
+         watchdog_timer_ = wn.createTimer(ros::Duration(watchdog_period), &GripperAction::watchdog, this);
+
      ROS_INFO("Gripper Controller started");
   }
 
   GripperAction::~GripperAction()
   {
+     watchdog_timer_.stop();
 	 pub_controller_command_.shutdown();
      sub_controller_state_.shutdown();
 
@@ -85,7 +94,8 @@ namespace kinova
 
       ROS_INFO("setFingersValues");
     
-      std::vector<double> fingerPositionsRadian = jaco_->getFingersJointAngle();
+      JacoStateSnapshotConstPtr state = jaco_->getStateSnapshot();
+      std::vector<double> fingerPositionsRadian(state->fingers_jointangle.begin(), state->fingers_jointangle.end());
 
       std::cout << "current fingerpositions: " << fingerPositionsRadian[0] << " " << fingerPositionsRadian[1] << " " << fingerPositionsRadian[2] << std::endl;
 
@@ -93,7 +103,7 @@ namespace kinova
         target_effort = active_goal_.getGoal()->command.max_effort;
 
         //determine if the gripper is supposed to be opened or closed
-        double current_position = jaco_->getFingersJointAngle()[0];
+        double current_position = state->fingers_jointangle[0];
         if(current_position > target_position){
             opening = true;
             std::cout << "Opening gripper" << std::endl;
@@ -123,6 +133,7 @@ namespace kinova
       }
 
       last_movement_time_ = ros::Time::now();
+      publishWatchdog();
   }
 
   void GripperAction::cancelCB(GoalHandle gh)
@@ -134,8 +145,30 @@ namespace kinova
 		  active_goal_.setCanceled();
 		  has_active_goal_ = false;
 
-          jaco_->stop();
+          jaco_->stopFingers();
       }
+      publishWatchdog();
+  }
+
+  void GripperAction::watchdog(const ros::TimerEvent &e)
+  {
+      // runs in the thread of the timer, the arm and its state are safe to use from there
+      double state_age = (ros::Time::now() - jaco_->getStateSnapshot()->stamp).toSec();
+
+      boost::mutex::scoped_lock lock(watchdog_mutex_);
+      if (!watchdog_armed_ || watchdog_tripped_ || state_age <= state_timeout_)
+          return;
+
+      ROS_ERROR("Gripper watchdog: the state of the arm is %.3f s old, stopping the fingers", state_age);
+      // the arm has a watchdog of its own, the fingers are held by update() so this timer never waits for
+      // the driver and cannot hold up the one of the arm on the same thread
+      watchdog_tripped_ = true;
+  }
+
+  void GripperAction::publishWatchdog()
+  {
+      boost::mutex::scoped_lock lock(watchdog_mutex_);
+      watchdog_armed_ = has_active_goal_;
   }
 
   double GripperAction::radToDeg(double rad)
@@ -145,14 +178,33 @@ namespace kinova
 
   void GripperAction::update()
   {
+        bool tripped;
+        {
+            boost::mutex::scoped_lock lock(watchdog_mutex_);
+            tripped = watchdog_tripped_;
+            watchdog_tripped_ = false;
+        }
+        if(tripped && has_active_goal_){
+            jaco_->stopFingers();
+
+            control_msgs::GripperCommandResult result;
+            result.reached_goal = false;
+            result.stalled = false;
+            active_goal_.setAborted(result);
+            has_active_goal_ = false;
+            std::cout << "Gripper command aborted after the watchdog stopped the fingers" << std::endl;
+        }
+        publishWatchdog();
 
         if(has_active_goal_){
 
+            JacoStateSnapshotConstPtr state = jaco_->getStateSnapshot();
+
             //here only the position of finger one is used            
-            double current_position = jaco_->getFingersJointAngle()[0];
+            double current_position = state->fingers_jointangle[0];
 
             //add the currents of all fingers together to form the current effort
-            double current_effort = jaco_->getFingersCurrent()[0] + jaco_->getFingersCurrent()[1] + jaco_->getFingersCurrent()[2];
+            double current_effort = state->fingers_current[0] + state->fingers_current[1] + state->fingers_current[2];
 
                 control_msgs::GripperCommandResult result;
               result.position = current_position;
@@ -166,7 +218,7 @@ namespace kinova
 
                 if(fabs(current_position - target_position) < goal_position_threshold_){
                     
-                      jaco_->stop();
+                      jaco_->stopFingers();
 
                       result.reached_goal = true;
                       active_goal_.setSucceeded(result);
@@ -186,7 +238,7 @@ namespace kinova
  
                       //TODO: Add check for no object
 
-                      jaco_->stop();
+                      jaco_->stopFingers();
 
                       result.reached_goal = true;
                       active_goal_.setSucceeded(result);
@@ -199,6 +251,13 @@ namespace kinova
 
             }
                 
+            // the grasp is only stalled once the fingers stopped moving for stall_timeout_
+            double finger_speed = 0.0;
+            for (size_t i = 0; i < NUM_FINGER_JOINTS; i++)
+                finger_speed = std::max(finger_speed, fabs(state->fingers_velocity[i]));
+            if (finger_speed > stall_velocity_threshold_)
+                last_movement_time_ = ros::Time::now();
+
             if((ros::Time::now() - last_movement_time_).toSec() > stall_timeout_){
 
     		  result.stalled = true;
@@ -25,8 +25,25 @@
 
 #include <jaco/jaco.h>
 
+#include <math.h>
+#include <algorithm>
+
 namespace kinova
 {
+	namespace
+	{
+		// finger positions [API degrees], arbitrary chosen 40.0 is closed
+		const double FINGERS_OPEN = 0.1;
+		const double FINGERS_CLOSED = 40.0;
+
+		// while joint velocities are streamed the fingers follow their target with this gain [1/s] ...
+		const double FINGER_GAIN = 4.0;
+		// ... at most this fast [API degrees/s]
+		const double MAX_FINGER_VELOCITY = 30.0;
+		// and count as there within [API degrees]
+		const double FINGER_TOLERANCE = 1.0;
+	}
+
 	Jaco::Jaco(const char* dll, const char* API_password) : kinova::AbstractJaco()
 	{
 		jaco_domain = mono_jit_init_version ("C++Wrapper","v2.0.50727");
@@ -89,10 +106,6 @@ namespace kinova
                                 SetCartesianSpaceTrajectory  = tempMethod;
                         else if (strcmp(mono_method_get_name(tempMethod), "JacoEraseTrajectories") == 0)
                                 EraseTrajectories  = tempMethod;
-                        else if (strcmp(mono_method_get_name(tempMethod), "JacoOpenFingers") == 0)
-                                OpenFingers  = tempMethod;
-                        else if (strcmp(mono_method_get_name(tempMethod), "JacoCloseFingers") == 0)
-                                CloseFingers  = tempMethod;
                         else if (strcmp(mono_method_get_name(tempMethod), "JacoAddFingerPosition") == 0)
                                 AddFingerPosition  = tempMethod;
                         else if (strcmp(mono_method_get_name(tempMethod), "JacoSetFingersPosition") == 0)
@@ -113,6 +126,10 @@ namespace kinova
                                 RestoreFactorySetting  = tempMethod;
                         else if (strcmp(mono_method_get_name(tempMethod), "JacoRetract") == 0)
                         	    Retract  = tempMethod;
+                        else if (strcmp(mono_method_get_name(tempMethod), "JacoSetCartesianSpeedLimit") == 0)
+                                SetCartesianSpeedLimit  = tempMethod;
+                        else if (strcmp(mono_method_get_name(tempMethod), "JacoSendJointVelocity") == 0)
+                                SendJointVelocity  = tempMethod;
 
 
 
@@ -141,10 +158,6 @@ namespace kinova
                         std::cout << "Cannot find method JacoSetCartesianSpaceTrajectory!" << std::endl;
                 if (!EraseTrajectories)
                         std::cout << "Cannot find method JacoEraseTrajectories!" << std::endl;
-                if (!OpenFingers)
-                        std::cout << "Cannot find method JacoOpenFingers!" << std::endl;
-                if (!CloseFingers)
-                        std::cout << "Cannot find method JacoCloseFingers!" << std::endl;
                 if (!AddFingerPosition)
                         std::cout << "Cannot find method JacoAddFingerPosition" << std::endl;
                 if (!SetFingersPosition)
@@ -165,6 +178,10 @@ namespace kinova
                         std::cout << "Cannot find method JacoFactoryRestore!" << std::endl;
                 if (!Retract)
                         std::cout << "Cannot find method JacoRetract!" << std::endl;
+                if (!SetCartesianSpeedLimit)
+                        std::cout << "Cannot find method JacoSetCartesianSpeedLimit!" << std::endl;
+                if (!SendJointVelocity)
+                        std::cout << "Cannot find method JacoSendJointVelocity!" << std::endl;
 
 
 
@@ -176,6 +193,10 @@ namespace kinova
 
             //retract();
 
+            has_finger_target_ = false;
+            fingers_pending_ = false;
+            fifo_tail_ = NULL;
+            stop_requested_ = false;
             closeFingers();
 
             lastApiControlState = false;
@@ -198,6 +219,7 @@ namespace kinova
 
         bool Jaco::checkApiInitialised()
         {
+                boost::recursive_mutex::scoped_lock lock(jaco_mutex);
                 bool apistate = false;
                 MonoObject *jacoapistate_obj = mono_runtime_invoke(CheckAPI, jaco_classobject, NULL, NULL);
                 apistate = *((MonoBoolean*)mono_object_unbox(jacoapistate_obj));
@@ -207,6 +229,7 @@ namespace kinova
 	
 	void Jaco::readJacoStatus()
 	{	
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
         //setCartesianModeAfterApiControlLost();
 
 
@@ -223,10 +246,15 @@ namespace kinova
 			//return false;
                 }
 		
-		// joint angles		
+		// joint angles, the arm reports actuator degrees
+		double actuator[6], angles[6];
+		for(int i = 0; i< 6; i++)
+			actuator[i] = jacostate.joints[i].angle;
+		calibration_.toJointAngles(actuator, angles);
+
 		for(int i = 0; i< 6; i++)
                 {
-			joint_angles_.at(i) = jacostate.joints[i].angle;
+			joint_angles_.at(i) = angles[i];
                         joints_current_.at(i) = jacostate.joints_current[i];
                 }
 
@@ -239,21 +267,46 @@ namespace kinova
 		
 			
                 // pose
-		// !!!  CAUTION !!!!
-		// Jaco arm API is calculating the forward kinematics not fast enough or its not
-		// calculating at all...
-		//
-		// todo: need to replace by jaco_arm_kinematics FK
-
-		pose_.at(0) = jacostate.hand_position[0];		
-		pose_.at(1) = jacostate.hand_position[1];
-		pose_.at(2) = jacostate.hand_position[2];
-		pose_.at(3) = jacostate.hand_orientation[0];
-		pose_.at(4) = jacostate.hand_orientation[1];
-		pose_.at(5) = jacostate.hand_orientation[2];
+		// The pose reported by the arm lags behind the joint angles (or is not updated at all),
+		// so the pose of the hand is computed from the joint angles of this sample.
+		updateForwardKinematics();
+
+		// the pose of the arm is kept, cartesian commands are given in its frame
+		api_pose_.at(0) = jacostate.hand_position[0];
+		api_pose_.at(1) = jacostate.hand_position[1];
+		api_pose_.at(2) = jacostate.hand_position[2];
+		api_pose_.at(3) = jacostate.hand_orientation[0];
+		api_pose_.at(4) = jacostate.hand_orientation[1];
+		api_pose_.at(5) = jacostate.hand_orientation[2];
+
+		// singularities as seen by the arm, and from the jacobian of the joint angles
+		singularity_.singularity_count = jacostate.singularity_count;
+		singularity_.singularity_theta_count = jacostate.singularity_theta_count;
+		singularity_.singularity_distance = jacostate.singularity_distance;
+		singularity_.singularity_theta_distance = jacostate.singularity_theta_distance;
+		for(int i = 0; i < 6; i++)
+			singularity_.repulsion[i] = jacostate.singularity_repulsion[i];
+		updateSingularity();
+
+		// cartesian and joystick motions are planned by the arm, they can only be stopped here
+		if(updateSelfCollision())
+		{
+			const char *first, *second;
+			self_collision_.getClosestLinks(first, second);
+			ROS_WARN_NAMED("jaco", "Self collision: %s and %s are %f m apart, trajectories erased", first, second, self_collision_.getClearance());
+			eraseTrajectories();
+		}
 
 		// current number of trajectory
 		trajnum_ = jacostate.current_trajectory;	
+		trajfifo_size_ = jacostate.trajectory_fifo_size;
+		feedJointSpaceTrajectory();
+		feedTrajectory(pose_trajectory_feeder_, &Jaco::uploadCartesianSpaceTrajectory);
+
+		// a finger target nothing could carry so far
+		ros::Time last_command;
+		if(fingers_pending_ && trajnum_ == 0 && !isStreamingJointVelocities(last_command))
+			sendFingerPoint();
 		
 
 		joystick_button_states_.at(0) = jacostate.joystick_button_states[0];
@@ -267,6 +320,7 @@ namespace kinova
 		joystick_axes_states_.at(1) = jacostate.joystick_axes_states[1];
 		joystick_axes_states_.at(2) = jacostate.joystick_axes_states[2];
 
+		publishStateSnapshot();
 
 		//listen to joystick buttons
 		if(joystick_button_states_.at(3) == 1){
@@ -286,6 +340,7 @@ namespace kinova
 
 	void Jaco::readJointStatus()
 	{	
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
 
 		//getJointAngles(ja);		
             	
@@ -303,16 +358,32 @@ namespace kinova
 	
 	void Jaco::setJointAngles(double jointangles[])
 	{	
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
+
+		if(!jointPathClear(jointangles, 1))
+		{
+			std::cout<< "!!!!!!!  Joint angles rejected, the arm would collide with itself" <<std::endl;
+			return;
+		}
+
+		if(!jointPathInWorkspace(jointangles, 1))
+		{
+			std::cout<< "!!!!!!!  Joint angles rejected, the hand would leave the workspace" <<std::endl;
+			return;
+		}
 
 		setAngularMode();
 		
 		jaco_exc = NULL;
-		
+
+		double actuator[6];
+		calibration_.toActuatorPositions(jointangles, actuator);
 		for(int i = 0; i< 6; i++)					
-			set_params[i] = &jointangles[i];
+			set_params[i] = &actuator[i];
 
 
 		mono_runtime_invoke(SetJointAngles, jaco_classobject, set_params, &jaco_exc);
+		fifo_tail_ = NULL;
 
 
 		if (jaco_exc != NULL)	
@@ -328,16 +399,28 @@ namespace kinova
 
 	bool Jaco::setAbsPose(double pose[])
 	{
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
+		if(!poseInWorkspace(pose))
+		{
+			std::cout<< "!!!!!!!  Pose rejected, the hand would leave the workspace" <<std::endl;
+			return false;
+		}
+
 		if(!setCartesianMode())
 			return false;
 
 		jaco_exc = NULL;
 		
+		double fingers[3];
+		fingerPositions(fingers);
 		for(int i = 0; i< 6; i++)					
 			set_params[i] = &pose[i];
+		for(int i = 0; i< 3; i++)
+			set_params[6 + i] = &fingers[i];
 
 	
 		mono_runtime_invoke(SetAbsPose, jaco_classobject, set_params, &jaco_exc);
+		fifo_tail_ = NULL;
 				
 		if (jaco_exc != NULL)	
                 {
@@ -351,6 +434,13 @@ namespace kinova
 
 	bool Jaco::setRelPosition(double position[])
 	{
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
+		if(!directionInWorkspace(position))
+		{
+			std::cout<< "!!!!!!!  Relative position rejected, the hand would leave the workspace" <<std::endl;
+			return false;
+		}
+
 		if(!setCartesianMode())
 			return false;
 
@@ -373,26 +463,35 @@ namespace kinova
 
 	bool Jaco::setJointSpaceTrajectory(std::vector<double> jointtrajectory)
 	{	
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
 
 		if(!isApiInCtrl()){
 			std::cout<< "API is not in control. Press Button 3 on the Joystick to enable API control." <<std::endl;
 			return false;
 		}
 
-		if(!setAngularMode())
+		// a rejected trajectory leaves the running one alone
+		if ((jointtrajectory.size() % 6) != 0)
 		{
-			std::cout<< "Enable angular mode" <<std::endl;
+			std::cout<< "!!!!!!!  Trajectory value is woring" <<std::endl;
+			return false;
+		}
+		else if (!jointtrajectory.empty() && !jointPathClear(&jointtrajectory[0], jointtrajectory.size() / 6))
+		{
+			std::cout<< "!!!!!!!  Trajectory rejected, the arm would collide with itself" <<std::endl;
+			return false;
+		}
+		else if (!jointtrajectory.empty() && !jointPathInWorkspace(&jointtrajectory[0], jointtrajectory.size() / 6))
+		{
+			std::cout<< "!!!!!!!  Trajectory rejected, the hand would leave the workspace" <<std::endl;
 			return false;
 		}
-
-
 		// erasing any previous trajectory
-		if(!eraseTrajectories())
+		else if(!eraseTrajectories())
 			return false;
-		
-		if ((jointtrajectory.size() % 6) != 0)
+		else if(!setAngularMode())
 		{
-			std::cout<< "!!!!!!!  Trajectory value is woring" <<std::endl;
+			std::cout<< "Enable angular mode" <<std::endl;
 			return false;
 		}
 		else
@@ -401,53 +500,184 @@ namespace kinova
 
 			std::cerr<< "num of tra ="<<number_trajectory <<std::endl;			
 
-			for(int i = 0; i< number_trajectory; i++)
+			// only the first chunk is uploaded here, the FIFO is topped up by readJacoStatus()
+			pose_trajectory_feeder_.clear();
+			trajectory_feeder_.load(jointtrajectory);
+			const double *waypoints;
+			size_t count = trajectory_feeder_.take(0, trajfifo_size_, waypoints);
+			if (!uploadJointSpaceTrajectory(waypoints, count))
 			{
-				for(int j = 0; j< 6; j++)					
-					set_params[j] = &jointtrajectory.at(j+(i*6));
+				trajectory_feeder_.clear();
+				return false;
+			}
+
+			// so the trajectory is not taken as finished before the next read
+			trajnum_ = count;
+			return true;
+			
+		}
+	}
 
+	bool Jaco::spliceJointSpaceTrajectory(std::vector<double> jointtrajectory, const double tolerances[])
+	{
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
+		if(jointtrajectory.empty() || (jointtrajectory.size() % 6) != 0 || !isApiInCtrl())
+			return false;
 
-				mono_runtime_invoke(AddJointSpaceTrajectory, jaco_classobject, set_params, &jaco_exc);
+		// the FIFO cannot be changed, the new trajectory has to go through what is left in it
+		size_t tail;
+		if(!trajectory_feeder_.findSplice(jointtrajectory, trajnum_, tolerances, tail))
+			return false;
 
+		// the path the arm is going to take, the rest of the FIFO and then the new points
+		std::vector<double> path;
+		trajectory_feeder_.fifoPoints(trajnum_, path);
+		path.insert(path.end(), jointtrajectory.begin() + tail * 6, jointtrajectory.end());
+		if (!jointPathClear(&path[0], path.size() / 6))
+		{
+			std::cout<< "!!!!!!!  Trajectory rejected, the arm would collide with itself" <<std::endl;
+			return false;
+		}
+		if (!jointPathInWorkspace(&path[0], path.size() / 6))
+		{
+			std::cout<< "!!!!!!!  Trajectory rejected, the hand would leave the workspace" <<std::endl;
+			return false;
+		}
 
-				if (jaco_exc != NULL)	
-				{
-					std::cout<< "!!!!!!!  Error while calling the C#wrapper AddJointSpaceTrajectory" <<std::endl;
-					return false;
-				}				
-				
-			}
+		ROS_DEBUG_NAMED("jaco", "trajectory spliced after %d points in the FIFO, %lu new points", trajnum_, (unsigned long)(jointtrajectory.size() / 6 - tail));
+		trajectory_feeder_.splice(jointtrajectory, tail);
+		feedJointSpaceTrajectory();
+		return true;
+	}
 
-			mono_runtime_invoke(SetJointSpaceTrajectory, jaco_classobject, NULL, &jaco_exc);
+	bool Jaco::uploadJointSpaceTrajectory(const double *waypoints, size_t count)
+	{
+		jaco_exc = NULL;
+
+		double actuator[6];
+		double fingers[3];
+		fingerPositions(fingers);
+		for(int j = 0; j< 3; j++)
+			set_params[6 + j] = &fingers[j];
+		for(size_t i = 0; i< count; i++)
+		{
+			calibration_.toActuatorPositions(waypoints + i*6, actuator);
+			for(int j = 0; j< 6; j++)					
+				set_params[j] = &actuator[j];
+
+
+			mono_runtime_invoke(AddJointSpaceTrajectory, jaco_classobject, set_params, &jaco_exc);
 
 
 			if (jaco_exc != NULL)	
 			{
-				std::cout<< "!!!!!!!  Error while calling the C#wrapper SetJointSpaceTrajectory" <<std::endl;
+				std::cout<< "!!!!!!!  Error while calling the C#wrapper AddJointSpaceTrajectory" <<std::endl;
 				return false;
-			}
-
-			return true;			
+			}				
 			
 		}
+
+		mono_runtime_invoke(SetJointSpaceTrajectory, jaco_classobject, NULL, &jaco_exc);
+
+
+		if (jaco_exc != NULL)	
+		{
+			std::cout<< "!!!!!!!  Error while calling the C#wrapper SetJointSpaceTrajectory" <<std::endl;
+			return false;
+		}
+
+		fifo_tail_ = &trajectory_feeder_;
+		return true;			
+	}
+
+	void Jaco::feedJointSpaceTrajectory()
+	{
+		feedTrajectory(trajectory_feeder_, &Jaco::uploadJointSpaceTrajectory);
+	}
+
+	void Jaco::feedTrajectory(JacoTrajectoryFeeder &feeder, TrajectoryUpload upload)
+	{
+		if (feeder.empty() || stopRequested())
+			return;
+
+		// the arm drops the FIFO when the joystick takes over, the rest of the trajectory goes with it
+		if (!isApiInCtrl())
+		{
+			ROS_WARN_NAMED("jaco", "API control lost, %d trajectory points dropped", (int)feeder.queued());
+			feeder.clear();
+			return;
+		}
+
+		const double *waypoints;
+		size_t count = feeder.take(trajnum_, trajfifo_size_, waypoints);
+		if (count == 0)
+			return;
+
+		if (!(this->*upload)(waypoints, count))
+		{
+			ROS_ERROR_NAMED("jaco", "Streaming the trajectory failed, %d points dropped", (int)feeder.queued());
+			feeder.clear();
+			eraseTrajectories();
+			return;
+		}
+		trajnum_ += count;
 	}
 
 	bool Jaco::setCartesianSpaceTrajectory(jaco::JacoPoseTrajectory cartesiantrajectory)
 	{	
-		if(!setCartesianMode())
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
+		std::vector<double> poses;
+		for(size_t i = 0; i < cartesiantrajectory.points.size(); i++)
+		{
+			const jaco::JacoPose& point = cartesiantrajectory.points[i];
+			double pose[6] = { point.position.x, point.position.y, point.position.z, point.orientation.x, point.orientation.y, point.orientation.z };
+			poses.insert(poses.end(), pose, pose + 6);
+		}
+		if(poses.empty())
+			return false;
+		if(!posePathInWorkspace(&poses[0], cartesiantrajectory.points.size()))
+		{
+			std::cout<< "!!!!!!!  Cartesian trajectory rejected, the hand would leave the workspace" <<std::endl;
+			return false;
+		}
+
+		// whatever is left of the trajectory before, joint angles would not be taken as poses
+		if(!eraseTrajectories() || !setCartesianMode())
 			return false;
 		
-		jaco_exc = NULL;
 		std::cerr<< "num of tra ="<<cartesiantrajectory.points.size() <<std::endl;
-		
-		for(int i = 0; i< cartesiantrajectory.points.size(); i++)
+
+		// as joint trajectories, only the first chunk is uploaded here and the rest is streamed by readJacoStatus()
+		pose_trajectory_feeder_.load(poses);
+		const double *waypoints;
+		size_t count = pose_trajectory_feeder_.take(0, trajfifo_size_, waypoints);
+		if (!uploadCartesianSpaceTrajectory(waypoints, count))
 		{
-			set_params[0] = &cartesiantrajectory.points.at(i).position.x;
-			set_params[1] = &cartesiantrajectory.points.at(i).position.y;
-			set_params[2] = &cartesiantrajectory.points.at(i).position.z;
-			set_params[3] = &cartesiantrajectory.points.at(i).orientation.x;
-			set_params[4] = &cartesiantrajectory.points.at(i).orientation.y;
-			set_params[5] = &cartesiantrajectory.points.at(i).orientation.z;
+			pose_trajectory_feeder_.clear();
+			return false;
+		}
+
+		// so the trajectory is not taken as finished before the next read
+		trajnum_ = count;
+		return true;			
+	}
+
+	bool Jaco::uploadCartesianSpaceTrajectory(const double *waypoints, size_t count)
+	{
+		jaco_exc = NULL;
+
+		double pose[6];
+		double fingers[3];
+		fingerPositions(fingers);
+		for(int j = 0; j< 3; j++)
+			set_params[6 + j] = &fingers[j];
+		for(size_t i = 0; i< count; i++)
+		{
+			for(int j = 0; j< 6; j++)
+			{
+				pose[j] = waypoints[i*6 + j];
+				set_params[j] = &pose[j];
+			}
 
 			mono_runtime_invoke(AddCartesianSpaceTrajectory, jaco_classobject, set_params, &jaco_exc);
 
@@ -468,13 +698,22 @@ namespace kinova
 			std::cout<< "!!!!!!!  Error while calling the C#wrapper SetCartesianSpaceTrajectory" <<std::endl;
 			return false;
 		}
+		fifo_tail_ = &pose_trajectory_feeder_;
 		return true;			
-		
 	}
 
 	bool Jaco::eraseTrajectories()
 	{
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
 		jaco_exc = NULL;
+		trajectory_feeder_.clear();
+		pose_trajectory_feeder_.clear();
+		fifo_tail_ = NULL;
+		fingers_pending_ = false;
+		{
+			boost::mutex::scoped_lock stop_lock(stop_mutex_);
+			stop_requested_ = false;
+		}
 		
 		mono_runtime_invoke(EraseTrajectories, jaco_classobject, NULL, &jaco_exc);		
 		
@@ -493,106 +732,116 @@ namespace kinova
 	
 	bool Jaco::openFingers()
 	{
-		jaco_exc = NULL;
-
-		if(!setAngularMode())
-			return false;
-
-		// erasing any previous trajectory
-                if(!eraseTrajectories())
-                        return false;
-		
-                mono_runtime_invoke(OpenFingers, jaco_classobject, NULL, &jaco_exc);
-                std::cout<< "Open Fingers" <<std::endl;
-		
-		if (jaco_exc != NULL)	
-                {
-                	std::cout<< "!!!!!!!  Error while calling the C#wrapper openFingers" <<std::endl;
-                	return false;
-                }
-		else
-			return true;
-
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
+		double fingers[3] = { FINGERS_OPEN, FINGERS_OPEN, FINGERS_OPEN };
+		std::cout<< "Open Fingers" <<std::endl;
+		return moveFingers(fingers);
 	}
 
 	bool Jaco::closeFingers()
 	{
-		jaco_exc = NULL;
-
-		if(!setAngularMode())
-			return false;
-
-		// erasing any previous trajectory
-                if(!eraseTrajectories())
-                        return false;
-
-                mono_runtime_invoke(CloseFingers, jaco_classobject, NULL, &jaco_exc);
-
-		
-		if (jaco_exc != NULL)	
-                {
-                	std::cout<< "!!!!!!!  Error while calling the C#wrapper closeFingers" <<std::endl;
-                	return false;
-                }
-		else
-			return true;
-
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
+		double fingers[3] = { FINGERS_CLOSED, FINGERS_CLOSED, FINGERS_CLOSED };
+		return moveFingers(fingers);
 	}
 
 
         bool Jaco::setFingersValues(double fingers[])
         {
-
-                jaco_exc = NULL;
+                boost::recursive_mutex::scoped_lock lock(jaco_mutex);
 
             	if(!isApiInCtrl()){
             		std::cout<< "API is not in control. Press Button 3 on the Joystick to enable API control." <<std::endl;
             		return false;
             	}
 
-				if(!setAngularMode())
-				{
-					std::cout<< "Enable angular mode" <<std::endl;
-					return false;
-				}
+                return moveFingers(fingers);
+        }
 
+	void Jaco::fingerPositions(double fingers[3]) const
+	{
+		for(int j = 0; j< 3; j++)
+			fingers[j] = has_finger_target_ ? finger_target_[j] : jacostate.fingers[j].angle * 180.0 / M_PI;
+	}
 
-                // erasing any previous trajectory
-                if(!eraseTrajectories())
-                        return false;
+	bool Jaco::moveFingers(const double fingers[3])
+	{
+		for(int j = 0; j< 3; j++)
+			finger_target_[j] = fingers[j];
+		has_finger_target_ = true;
+		fingers_pending_ = false;
 
-                for(int i = 0; i< 3; i++)
-                        set_fingers_params[i] = &fingers[i];
+		// the velocities streamed and the points still to be fed carry the new target
+		ros::Time last_command;
+		if(isStreamingJointVelocities(last_command) || !trajectory_feeder_.empty() || !pose_trajectory_feeder_.empty())
+			return true;
 
-                mono_runtime_invoke(AddFingerPosition, jaco_classobject, set_fingers_params, &jaco_exc);
+		if(trajnum_ > 0)
+		{
+			// the arm is still on its way, one more point where it ends up brings the fingers along
+			const double *tail;
+			if(fifo_tail_ == NULL || !fifo_tail_->lastUploaded(tail))
+			{
+				fingers_pending_ = true;
+				return true;
+			}
 
+			bool ok = fifo_tail_ == &trajectory_feeder_ ? uploadJointSpaceTrajectory(tail, 1) : uploadCartesianSpaceTrajectory(tail, 1);
+			if(ok)
+				trajnum_ += 1;
+			return ok;
+		}
 
-                if (jaco_exc != NULL)
-                {
-                        std::cout<< "!!!!!!!  Error while calling the C#wrapper AddFingerPosition" <<std::endl;
-                        return false;
-                }
+		return sendFingerPoint();
+	}
+
+	bool Jaco::sendFingerPoint()
+	{
+		// the point is an angular one, a cartesian goal before it may have left the arm in cartesian mode
+		if(!setAngularMode())
+			return false;
+		jaco_exc = NULL;
+		fingers_pending_ = false;
 
-                mono_runtime_invoke(SetFingersPosition, jaco_classobject, NULL, &jaco_exc);
+		double fingers[3];
+		fingerPositions(fingers);
+		for(int i = 0; i< 3; i++)
+			set_fingers_params[i] = &fingers[i];
 
-                if (jaco_exc != NULL)
-                {
-                        std::cout<< "!!!!!!!  Error while calling the C#wrapper fingersvalues" <<std::endl;
-                        return false;
-                }
-                else
-                        return true;
+		// the point keeps the joints where they are
+		mono_runtime_invoke(AddFingerPosition, jaco_classobject, set_fingers_params, &jaco_exc);
 
-        }
+		if (jaco_exc != NULL)
+		{
+			std::cout<< "!!!!!!!  Error while calling the C#wrapper AddFingerPosition" <<std::endl;
+			return false;
+		}
+
+		mono_runtime_invoke(SetFingersPosition, jaco_classobject, NULL, &jaco_exc);
+		fifo_tail_ = NULL;
+
+		if (jaco_exc != NULL)
+		{
+			std::cout<< "!!!!!!!  Error while calling the C#wrapper fingersvalues" <<std::endl;
+			return false;
+		}
+		trajnum_ += 1;
+		return true;
+	}
 
 	bool Jaco::startApiCtrl()
 	{
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
 		jaco_exc = NULL;
 		
 		ROS_INFO_NAMED("jaco", "API control started");
 
 		std::cout<< "API control started" <<std::endl;
 
+		// the fingers stay where the joystick left them
+		has_finger_target_ = false;
+		fingers_pending_ = false;
+
 		mono_runtime_invoke(StartAPI, jaco_classobject, NULL, &jaco_exc);		
 		
 		if (jaco_exc != NULL)	
@@ -607,6 +856,7 @@ namespace kinova
 
 	bool Jaco::setAngularMode()
 	{
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
 		jaco_exc = NULL;
 		
 		mono_runtime_invoke(SetAngularMode, jaco_classobject, NULL, &jaco_exc);		
@@ -623,6 +873,7 @@ namespace kinova
 
 	bool Jaco::setCartesianMode()
 	{
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
 		jaco_exc = NULL;
 		
 		ROS_INFO_NAMED("jaco", "Cartesian mode enabled.");
@@ -643,6 +894,7 @@ namespace kinova
 
 	bool Jaco::setCartesianModeAfterApiControlLost()
 	{
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
 		bool apiControlState = isApiInCtrl();
 
 		//If API control was lost
@@ -668,16 +920,21 @@ namespace kinova
 
     //stops the currently running execution immediately
     void Jaco::stop(){
+        boost::recursive_mutex::scoped_lock lock(jaco_mutex);
 
     	std::cout<< "Execution stopped. Collision with something (Octomap, Object?)" <<std::endl;
     	ROS_WARN_NAMED("jaco", "Execution stopped. Collision with something (Octomap, Object?)");
 
         eraseTrajectories();
+
+        // only the arm is stopped, the fingers go on to their target once the FIFO is empty
+        fingers_pending_ = has_finger_target_;
     }
 
 
 	bool Jaco::stopApiCtrl()
 	{
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
 		jaco_exc = NULL;
 		
 		mono_runtime_invoke(StopAPI, jaco_classobject, NULL, &jaco_exc);		
@@ -694,6 +951,7 @@ namespace kinova
 
 	bool Jaco::isApiInCtrl()
 	{
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
 		jaco_exc = NULL;
 
 		MonoObject* apiState = mono_runtime_invoke(IsApiInCtrl, jaco_classobject, NULL, &jaco_exc);
@@ -710,6 +968,7 @@ namespace kinova
 
         bool Jaco::setActuatorPIDGain(int jointnum, float P, float I, float D)
         {
+                boost::recursive_mutex::scoped_lock lock(jaco_mutex);
                 jaco_exc = NULL;
 
                 set_pid_gain[0] = &jointnum;
@@ -732,6 +991,7 @@ namespace kinova
 
 	bool Jaco::restoreFactorySetting()
 	{
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
 		jaco_exc = NULL;
 		
 		mono_runtime_invoke(RestoreFactorySetting, jaco_classobject, NULL, &jaco_exc);		
@@ -747,6 +1007,7 @@ namespace kinova
 
 	bool Jaco::retract()
 	{
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
 		jaco_exc = NULL;
 
 		mono_runtime_invoke(Retract, jaco_classobject, NULL, &jaco_exc);
@@ -760,4 +1021,143 @@ namespace kinova
 			return true;
 	}
 
+	bool Jaco::setCartesianSpeedLimit(double linear, double angular)
+	{
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
+		jaco_exc = NULL;
+
+		set_speed_limit[0] = &linear;
+		set_speed_limit[1] = &angular;
+
+		mono_runtime_invoke(SetCartesianSpeedLimit, jaco_classobject, set_speed_limit, &jaco_exc);
+
+		if (jaco_exc != NULL)
+                {
+	               	std::cout<< "!!!!!!!  Error while calling the C#wrapper setCartesianSpeedLimit" <<std::endl;
+                	return false;
+                }
+		else
+			return true;
+	}
+
+	bool Jaco::setJointVelocities(double velocities[])
+	{
+		boost::recursive_mutex::scoped_lock lock(jaco_mutex);
+		jaco_exc = NULL;
+
+		// stopping is always allowed
+		double zero[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+		bool clear = jointVelocitiesClear(velocities);
+		if(!clear)
+			ROS_WARN_THROTTLE(1.0, "Joint velocities stopped, the arm would collide with itself");
+		if(stopRequested())
+		{
+			// the watchdog stopped the arm while this thread was busy
+			velocities = zero;
+			clear = false;
+		}
+
+		// slowed down or stopped at the workspace fences
+		double scaled[6];
+		double scale = clear ? workspaceVelocityScale(velocities) : 0.0;
+		if(clear && scale < 1.0)
+			ROS_WARN_THROTTLE(1.0, "Joint velocities scaled by %.2f at the workspace fences", scale);
+		for(int i = 0; i < 6; i++)
+			scaled[i] = scale * velocities[i];
+
+		double actuator[6];
+		calibration_.toActuatorSpeeds(clear ? scaled : zero, actuator);
+		for(int i = 0; i< 6; i++)
+			set_velocity_params[i] = &actuator[i];
+
+		// the fingers are driven to their target along with the joints, and stop with them
+		bool stopping = true;
+		for(int i = 0; i< 6; i++)
+			if(velocities[i] != 0.0)
+				stopping = false;
+		double finger_velocities[3] = { 0.0, 0.0, 0.0 };
+		bool fingers_there = true;
+		for(int j = 0; has_finger_target_ && j< 3; j++)
+		{
+			double error = finger_target_[j] - jacostate.fingers[j].angle * 180.0 / M_PI;
+			if(fabs(error) > FINGER_TOLERANCE)
+				fingers_there = false;
+			if(!stopping)
+				finger_velocities[j] = std::max(-MAX_FINGER_VELOCITY, std::min(FINGER_GAIN * error, MAX_FINGER_VELOCITY));
+		}
+		for(int j = 0; j< 3; j++)
+			set_velocity_params[6 + j] = &finger_velocities[j];
+		fingers_pending_ = stopping && !fingers_there;
+
+		mono_runtime_invoke(SendJointVelocity, jaco_classobject, set_velocity_params, &jaco_exc);
+
+		if (jaco_exc != NULL)
+                {
+	               	std::cout<< "!!!!!!!  Error while calling the C#wrapper setJointVelocities" <<std::endl;
+                	return false;
+                }
+
+		recordJointVelocities(clear ? scaled : zero);
+		return clear && scale > 0.0;
+	}
+
+	bool Jaco::emergencyStop(bool velocities)
+	{
+		boost::recursive_mutex::scoped_try_lock lock(jaco_mutex);
+		if(lock.owns_lock())
+		{
+			bool ok = eraseTrajectories();
+			if(velocities)
+			{
+				double zero[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+				ok = setJointVelocities(zero) && ok;
+			}
+			return ok;
+		}
+
+		// Another thread is stuck in a command, e.g. reading the state. The stop is sent next to it
+		// with arguments of its own, the C# wrapper locks its trajectory lists and the sends, so it waits
+		// for a send or list change running but not for the rest of that command. The other thread must
+		// not feed or stream again before eraseTrajectories().
+		{
+			boost::mutex::scoped_lock stop_lock(stop_mutex_);
+			stop_requested_ = true;
+		}
+		ROS_ERROR_NAMED("jaco", "Emergency stop while a command is running");
+
+		MonoObject *exc = NULL;
+		mono_runtime_invoke(EraseTrajectories, jaco_classobject, NULL, &exc);
+		bool ok = exc == NULL;
+		if(velocities)
+		{
+			double zero[9] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+			void *params[9];
+			for(int i = 0; i< 9; i++)
+				params[i] = &zero[i];
+			exc = NULL;
+			mono_runtime_invoke(SendJointVelocity, jaco_classobject, params, &exc);
+			ok = ok && exc == NULL;
+			recordJointVelocities(zero);
+		}
+		if(!ok)
+			ROS_ERROR_NAMED("jaco", "Error while calling the C# wrapper for the emergency stop");
+		return ok;
+	}
+
+	bool Jaco::stopRequested() const
+	{
+		boost::mutex::scoped_lock lock(stop_mutex_);
+		return stop_requested_;
+	}
+
+	void Jaco::attachThread()
+	{
+		mono_thread_attach(jaco_domain);
+	}
+
+	void Jaco::detachThread()
+	{
+		mono_thread_detach(mono_thread_current());
+	}
+
 }
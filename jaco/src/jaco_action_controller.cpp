@@ -28,20 +28,24 @@
 
 
 #include <jaco/jaco_action_controller.h>
+#include <actionlib_msgs/GoalStatus.h>
+
+#include <algorithm>
 
 
 
 namespace kinova
 {
-        JacoActionController::JacoActionController(boost::shared_ptr<AbstractJaco> jaco) :  jaco_apictrl(jaco), JTAC_jaco(jaco), jt_actionserver(jtacn,"jaco_arm_controller/joint_trajectory_action",
+        JacoActionController::JacoActionController(boost::shared_ptr<AbstractJaco> jaco, ros::NodeHandle nh, ros::NodeHandle pn, ros::NodeHandle wn) :  jaco_apictrl(jaco), JTAC_jaco(jaco), jtacn(nh), jt_actionserver(jtacn,"jaco_arm_controller/joint_trajectory_action",
                                                     boost::bind(&JacoActionController::joint_goalCB,  this, _1), boost::bind(&JacoActionController::joint_cancelCB, this, _1),false),
-                                                    CMAC_jaco(jaco), cm_actionserver(cmacn,"cartesian_action",
+                                                    CMAC_jaco(jaco), cmacn(nh), cm_actionserver(cmacn,"cartesian_action",
                                                     boost::bind(&JacoActionController::cartesian_goalCB,  this, _1), boost::bind(&JacoActionController::cartesian_cancelCB, this, _1),false),
-                                                    FAC_jaco(jaco), finger_actionserver(facn,"finger_action",
+                                                    ct_actionserver(cmacn,"cartesian_trajectory_action",
+                                                    boost::bind(&JacoActionController::cartesian_trajectory_goalCB,  this, _1), boost::bind(&JacoActionController::cartesian_trajectory_cancelCB, this, _1),false),
+                                                    FAC_jaco(jaco), facn(nh), finger_actionserver(facn,"finger_action",
                                                     boost::bind(&JacoActionController::finger_goalCB,  this, _1), boost::bind(&JacoActionController::finger_cancelCB, this, _1),false),
-                                                    has_active_goal(false)
+                                                    has_active_arm_goal(false), has_active_finger_goal(false)
         {
-                ros::NodeHandle pn("~");
                 joints_name.resize(NUM_JOINTS, "");
                 current_jtangles.resize(NUM_JOINTS, 0.0);
 		final_jtangles.resize(NUM_JOINTS, 0.0);               
@@ -63,34 +67,118 @@ namespace kinova
                 fingers_name    = jaco -> getFingersJointName();
 
                 stop_jaco       = false;
+                stop_fingers    = false;
+                erase_arm_fifo  = false;
                 // used for joint trajectory action
                 move_joint          = false;
                 movejoint_done      = false;
                 num_jointTrajectory = 0;
                 num_activeTrajectory = 0;
+                fifo_spliced        = false;
+                fifo_emptied        = false;
                 // used for cartesian action
                 move_pose           = false;
                 movepose_done 		= false;
+                // used for cartesian trajectory action
+                move_pose_trajectory    = false;
+                moveposetrajectory_done = false;
+                num_poseTrajectory      = 0;
+                pose_feedback_point     = -1;
+                trajectory_linear_speed = 0.0;
+                trajectory_angular_speed = 0.0;
                 // used for finger action
                 move_finger         = false;
                 movefinger_done     = false;
                 finger_open         = false;
                 finger_close        = false;
-                fingerTrajNumber    = 0;
 
 
-                pn.param("constraints/goal_time", goal_time_constraint, 0.0);
+                // the tolerances of goals that do not bring their own, see jaco_trajectory_constraints.h
+                pn.param("constraints/goal_time", default_constraints.goal_time, 0.0);
+                double stopped_velocity_tolerance;
+                pn.param("constraints/stopped_velocity_tolerance", stopped_velocity_tolerance, 0.01);
                 // Gets the constraints for each joint.
                 for (size_t i = 0; i < joints_name.size(); ++i)
                 {
                         std::string ns = std::string("constraints/") + joints_name[i];
-                        double g, t;
-                        pn.param(ns + "/goal", g, DEFAULT_GOAL_THRESHOLD);
-                        pn.param(ns + "/trajectory", t, -1.0);
-                        goal_constraints[joints_name.at(i)] = g;
-                        trajectory_constraints[joints_name.at(i)] = t;
+                        pn.param(ns + "/goal", default_constraints.goal[i], DEFAULT_GOAL_THRESHOLD);
+                        pn.param(ns + "/trajectory", default_constraints.path[i], -1.0);
+                        default_constraints.goal_velocity[i] = stopped_velocity_tolerance;
                 }
-                pn.param("constraints/stopped_velocity_tolerance", stopped_velocity_tolerance, 0.01);
+                active_constraints = default_constraints;
+
+                // points within the trajectory tolerance of each joint to the path are dropped before the upload,
+                // joints without one use simplify_tolerance [rad]
+                double simplify_tolerance;
+                pn.param("trajectory/simplify", simplify_trajectories, true);
+                pn.param("trajectory/simplify_tolerance", simplify_tolerance, 0.01);
+                // a goal replacing a running one continues its motion instead of stopping the arm, in the fifo
+                // mode if it passes within the same tolerances through the points already uploaded
+                pn.param("trajectory/splice", splice_trajectories, true);
+                for (size_t i = 0; i < NUM_JOINTS; ++i)
+                {
+                        double t = default_constraints.path[i];
+                        simplify_tolerances[i] = t > 0.0 ? t : simplify_tolerance;
+                }
+
+                // "fifo" uploads the points to the arm, which moves between them at its own speed,
+                // "interpolated" follows the timing of the trajectory with streamed joint velocities
+                std::string execution;
+                pn.param("trajectory/execution", execution, std::string("fifo"));
+                interpolate_trajectories = (execution == "interpolated");
+                if (!interpolate_trajectories && execution != "fifo")
+                        ROS_ERROR("trajectory/execution must be fifo or interpolated, using fifo");
+
+                // the interpolated trajectory is tracked with feedforward and PID, see jaco_tracking_controller.h
+                double max_joint_velocity;
+                pn.param("trajectory/max_joint_velocity", max_joint_velocity, 0.8);
+                tracking_controller.setMaxVelocity(max_joint_velocity);
+                for (size_t i = 0; i < joints_name.size(); ++i)
+                {
+                        std::string ns = std::string("trajectory/gains/") + joints_name[i];
+                        JacoTrackingGains gains;
+                        pn.param(ns + "/p", gains.p, gains.p);
+                        pn.param(ns + "/i", gains.i, gains.i);
+                        pn.param(ns + "/d", gains.d, gains.d);
+                        pn.param(ns + "/i_clamp", gains.i_clamp, gains.i_clamp);
+                        tracking_controller.setGains(i, gains);
+                }
+                start_interpolation = false;
+                interpolating_joint = false;
+                stop_joint_velocities = false;
+
+                // time-optimal retiming of interpolated goals with the limits of jaco_moveit_config/config/joint_limits.yaml,
+                // goals taking more than retime_slack times as long as needed are retimed as well
+                double retime_resolution;
+                pn.param("trajectory/retime", retime_trajectories, true);
+                pn.param("trajectory/retime_slack", retime_slack, 1.2);
+                pn.param("trajectory/retime_resolution", retime_resolution, 0.01);
+                retimer.setResolution(retime_resolution);
+                for (size_t i = 0; i < joints_name.size(); ++i)
+                {
+                        std::string ns = std::string("joint_limits/") + joints_name[i];
+                        bool has_velocity_limits, has_acceleration_limits;
+                        double max_velocity, max_acceleration;
+                        pn.param(ns + "/has_velocity_limits", has_velocity_limits, false);
+                        pn.param(ns + "/has_acceleration_limits", has_acceleration_limits, false);
+                        pn.param(ns + "/max_velocity", max_velocity, 0.2);
+                        pn.param(ns + "/max_acceleration", max_acceleration, 0.5);
+                        // the streamed joint velocities are limited anyway
+                        if (!has_velocity_limits || max_velocity <= 0.0)
+                                max_velocity = max_joint_velocity;
+                        if (!has_acceleration_limits || max_acceleration <= 0.0)
+                                max_acceleration = 0.5;
+                        retimer.setLimits(i, std::min(max_velocity, max_joint_velocity), max_acceleration);
+                        retime_max_acceleration[i] = max_acceleration;
+                }
+
+                // slowing down near singularities
+                pn.param("singularity/scale_cartesian_speed", scale_cartesian_speed, true);
+                pn.param("singularity/max_linear_speed", max_linear_speed, 0.15);
+                pn.param("singularity/max_angular_speed", max_angular_speed, 0.6);
+                pn.param("singularity/rescale_step", rescale_step, 0.1);
+                pn.param("singularity/rescale_interval", rescale_interval, 1.0);
+                commanded_speed_scale = 1.0;
 
 
                 pub_controller_command 	= jtacn.advertise<trajectory_msgs::JointTrajectory>("command", 1);
@@ -99,12 +187,9 @@ namespace kinova
                 // starting all the action server
                 jt_actionserver.start();
                 cm_actionserver.start();
+                ct_actionserver.start();
                 finger_actionserver.start();
 
-                // temporary outer control loop
-                error_factor = 1;
-                control_counter = 0;
-
                 // test thread
                 object_grasped = false;
                 object_grasped_process = false;
@@ -126,6 +211,17 @@ namespace kinova
                 time_diff = 0.001;
                 derv_counter = 0;           
 
+                // the watchdog, 0 disables a timeout
+                double watchdog_period;
+                pn.param("watchdog/period", watchdog_period, 0.005);
+                pn.param("watchdog/state_timeout", state_timeout, 0.05);
+                pn.param("watchdog/command_timeout", command_timeout, 0.05);
+                watchdog_armed = false;
+                watchdog_tripped = false;
+                watchdog_goal_time = false;
+                std::fill(watchdog_velocity_tolerance, watchdog_velocity_tolerance + NUM_JOINTS, 0.0);
+                if (watchdog_period > 0.0)
+                        watchdog_timer = wn.createTimer(ros::Duration(watchdog_period), &JacoActionController::watchdog, this);
 
         }
 
@@ -138,29 +234,34 @@ namespace kinova
 
         void JacoActionController::update()
         {
+                bool tripped;
+                {
+                        boost::mutex::scoped_lock lock(watchdog_mutex);
+                        tripped = watchdog_tripped;
+                }
+                if (tripped)
+                        abortWatchdogGoals();
 
+                // a goal canceled from outside is not followed any more, the one preempting it is sent below
+                if (movejoint_done && joint_active_goal.getGoalStatus().status != actionlib_msgs::GoalStatus::ACTIVE)
+                        movejoint_done = false;
 
                 if (movejoint_done)
                 {
                         current_jtangles = JTAC_jaco->getJointAngles();
 
-                        num_activeTrajectory = JTAC_jaco->getCurrentTrajectoryNumber();
+                        // long trajectories are streamed, the points not in the FIFO yet are still to come
+                        num_activeTrajectory = JTAC_jaco->getCurrentTrajectoryNumber() + JTAC_jaco->getQueuedTrajectoryNumber();
 
-                        //only for first trajectory point
-                        if(num_jointTrajectory == num_activeTrajectory){
+                        //only for first trajectory point, or while the points of a goal it was spliced onto are executed
+                        size_t next = 0;
+                        if(num_jointTrajectory <= num_activeTrajectory){
                             trajectory_start_time = old_time;
-                            for (int j = 0; j < 6; j++){                                
-                                nextTraj_jtangles.at(j) = joint_active_goal.getGoal()->trajectory.points.at(num_jointTrajectory-num_activeTrajectory).positions.at(j);
-                                        
-                            }
                         }else{//for all following points
-                        
-                    
-                            for (int j = 0; j < 6; j++){                                
-                                nextTraj_jtangles.at(j) = joint_active_goal.getGoal()->trajectory.points.at((num_jointTrajectory-num_activeTrajectory)-1).positions.at(j);
-                                            
-                            }
+                            next = (num_jointTrajectory-num_activeTrajectory)-1;
                         }
+                        // the compiled points of the goal, in the joint order of the arm
+                        std::copy(&desired_jtangles[next * NUM_JOINTS], &desired_jtangles[next * NUM_JOINTS] + NUM_JOINTS, nextTraj_jtangles.begin());
 
 			            calculate_error_dervError(current_jtangles, nextTraj_jtangles);
 
@@ -178,69 +279,67 @@ namespace kinova
 
                         joint_active_goal.publishFeedback(jtaction_fb);
 
-                        //if all trajectories have been executed
-                        if (num_activeTrajectory == 0)
-                        {
-                        	if (FAC_jaco->isApiInCtrl()){
-
-                                if(ros::Time::now().toSec() > (trajectory_start_time + trajectory_duration)){
-                                    jtaction_res.error_code = control_msgs::FollowJointTrajectoryResult::SUCCESSFUL;
-                                    movejoint_done = false;
-                                    joint_active_goal.setSucceeded(jtaction_res);
-
-                                    std::cout<<" Final angles in degree"<<std::endl;
-                                    for(int i = 0; i< 6; i++)
-                                    std::cout<<current_jtangles.at(i)*RTD<<"  ";
-                                    std::cout<<"---------------"<<std::endl;
-                                    std::cout<<" Final angles in Radian"<<std::endl;
-                                    for(int i = 0; i< 6; i++)
-                                    std::cout<<current_jtangles.at(i)<<"  "<<std::endl;
-
-                                    std::cerr<<"!!!!!!!!  finished !!!!!!!!!!!!"<<std::endl;
-                                    error_factor = 1;
-                                    control_counter = 0;
-                                    has_active_goal = false;
-                                }
-
-                     
-                        		
-
-                        	}else{
-
-                                std::cerr<<"No active trajectories but API is not in control. Aborted!"<<std::endl;
-                                jtaction_res.error_code = control_msgs::FollowJointTrajectoryResult::GOAL_TOLERANCE_VIOLATED;
-                                joint_active_goal.setAborted(jtaction_res);
+                        // the points of a new goal are checked once they are in the FIFO
+                        if (!move_joint)
+                                monitorFifoTrajectory();
+                }
 
-                            }
-                                
-                                
-                           
-                               
+                {
+                        boost::mutex::scoped_lock lock(interpolation_mutex);
+                        // what is left of a preempted goal, before the new one is sent below
+                        if (erase_arm_fifo)
+                        {
+                                JTAC_jaco->eraseTrajectories();
+                                erase_arm_fifo = false;
+                        }
+                        if (start_interpolation)
+                        {
+                                // velocities are joint commands, whatever is left in the FIFO of the arm would fight them
+                                JTAC_jaco->setAngularMode();
+                                JTAC_jaco->eraseTrajectories();
+                                startInterpolation();
+                        }
+                        if (interpolating_joint)
+                                updateInterpolation();
+                        if (stop_joint_velocities)
+                        {
+                                double zero[NUM_JOINTS] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+                                JTAC_jaco->setJointVelocities(zero);
+                                stop_joint_velocities = false;
                         }
-                  
                 }
 
                 // reason for putting this code here instead of placing above the movejoint_done is bcoz of traj num
                 // i.e. firt i need to send the traj to jaco and i need to update the status and then check for traj num.
+                if (move_joint && !sendJointTrajectory())
+                {
+                        // e.g. the trajectory would make the arm collide with itself
+                        ROS_ERROR("Joint trajectory rejected by the Jaco arm. Aborted!");
+                        jtaction_res.error_code = control_msgs::FollowJointTrajectoryResult::INVALID_GOAL;
+                        joint_active_goal.setAborted(jtaction_res);
+                        has_active_arm_goal = false;
+                        move_joint = false;
+                }
+
                 if (move_joint)
                 {
 
-                        JTAC_jaco->setJointSpaceTrajectory(desired_jtangles);
-                        
                         ROS_INFO("Joint trajectory sent to Jaco arm");
 
                         old_time = ros::Time::now().toSec();
+                        fifo_start_jtangles = JTAC_jaco->getJointAngles();
+                        fifo_emptied = false;
 
                         movejoint_done = true;
                         move_joint = false;
                         
                         current_jtangles = JTAC_jaco->getJointAngles();
 
-                        num_activeTrajectory = JTAC_jaco->getCurrentTrajectoryNumber();                      
+                        num_activeTrajectory = JTAC_jaco->getCurrentTrajectoryNumber() + JTAC_jaco->getQueuedTrajectoryNumber();
 
                         
                         for (int j = 0; j < 6; j++)                        
-                                nextTraj_jtangles.at(j) = joint_active_goal.getGoal()->trajectory.points.at(0).positions.at(j);
+                                nextTraj_jtangles.at(j) = desired_jtangles.at(j);
                                 
 
 			calculate_error_dervError(current_jtangles, nextTraj_jtangles);
@@ -262,24 +361,42 @@ namespace kinova
                 // pose
                 if (move_pose)
                 {
-                        double ps[6];
-
-                        for ( int i = 0; i < 6; i++)
-                        	ps[i] = desired_pose.at(i);
-
                         ROS_INFO("Sending movement to Jaco arm...");
-                        CMAC_jaco->setAbsPose(ps);
-
-                        movepose_done = true;
+                        if (sendCartesianGoal())
+                                movepose_done = true;
+                        else
+                        {
+                                ROS_ERROR("Cartesian goal rejected by the Jaco arm. Aborted!");
+                                cmaction_res.error_code = jaco::CartesianMovementResult::INVALID_GOAL;
+                                cartesian_active_goal.setAborted(cmaction_res);
+                                has_active_arm_goal = false;
+                        }
                         move_pose = false;
                 }
                 if (movepose_done)
                 {
+                        // the arm cannot change the speed of a running trajectory, so the goal is sent again
+                        double speed_scale = CMAC_jaco->getSingularityState().speed_scale;
+                        if (scale_cartesian_speed && CMAC_jaco->getCurrentTrajectoryNumber() > 0 && rescaleDue(speed_scale))
+                        {
+                                ROS_INFO("Singularity speed scale changed to %.2f, sending the movement again", speed_scale);
+                                CMAC_jaco->eraseTrajectories();
+                                if (!sendCartesianGoal())
+                                {
+                                        // the FIFO is empty now, the goal would wait for nothing
+                                        ROS_ERROR("Cartesian goal rejected by the Jaco arm when sent again. Aborted!");
+                                        cmaction_res.error_code = jaco::CartesianMovementResult::ABORTED;
+                                        cartesian_active_goal.setAborted(cmaction_res);
+                                        movepose_done = false;
+                                        has_active_arm_goal = false;
+                                }
+                        }
                         
                         if (CMAC_jaco->getCurrentTrajectoryNumber() == 0)
                         {
 
-                                current_pose = CMAC_jaco->getPose();
+                                // the goal is given in base_jaco, the frame of the arm
+                                current_pose = CMAC_jaco->getApiPose();
                                 if (is_cartesianSpaceTrajectory_finished(current_pose, desired_pose))
                                 {
                                         cmaction_res.error_code = jaco::CartesianMovementResult::SUCCESSFUL;
@@ -291,6 +408,27 @@ namespace kinova
                         }
                 }
 
+                // cartesian trajectory
+                if (move_pose_trajectory)
+                {
+                        ROS_INFO("Sending cartesian trajectory of %d poses to Jaco arm...", num_poseTrajectory);
+                        limitCartesianTrajectorySpeed();
+                        if (CMAC_jaco->setCartesianSpaceTrajectory(desired_pose_trajectory))
+                                moveposetrajectory_done = true;
+                        else
+                        {
+                                ROS_ERROR("Cartesian trajectory rejected by the Jaco arm. Aborted!");
+                                ctaction_res.error_code = jaco::CartesianTrajectoryResult::INVALID_GOAL;
+                                cartesian_trajectory_active_goal.setAborted(ctaction_res);
+                                has_active_arm_goal = false;
+                        }
+                        move_pose_trajectory = false;
+                }
+                if (moveposetrajectory_done && cartesian_trajectory_active_goal.getGoalStatus().status != actionlib_msgs::GoalStatus::ACTIVE)
+                        moveposetrajectory_done = false;
+                if (moveposetrajectory_done)
+                        monitorCartesianTrajectory();
+
                 // finger
                 if (move_finger)
                 {                        
@@ -320,23 +458,30 @@ namespace kinova
 
                 if (movefinger_done)
                 {
-                        fingerTrajNumber = FAC_jaco->getCurrentTrajectoryNumber();
+                        // the fingers ride on the points of the arm, the FIFO tells nothing about them,
+                        // only where they are and whether they still move
                         current_fingervalues = FAC_jaco->getFingersJointAngle();
+                        const std::vector<double> &fingers_velocity = FAC_jaco->getFingersVelocity();
+                        bool fingers_settled = true;
+                        for (size_t j = 0; j < fingers_velocity.size(); j++)
+                                if (fabs(fingers_velocity.at(j)) > 0.02)
+                                        fingers_settled = false;
                        
                         if (finger_open == true)
                         {
-                                if ( (fingerTrajNumber == 0) && (simplecontroller_finger(current_fingervalues,0.001745329)  ) )
+                                if (simplecontroller_finger(current_fingervalues,0.001745329))
                                 {                                        
                                         fingeraction_res.result_code = jaco::FingerMovementResult::GRASPED ;
                                         movefinger_done = false;
                                         finger_active_goal.setSucceeded(fingeraction_res);
                                         finger_open = false;
+                                        has_active_finger_goal = false;
                                 }
 
                         }
                         else if (finger_close == true)
                         {
-                                if ( (fingerTrajNumber == 0) && (object_grasped_process)  ) //&& (simplecontroller_finger(current_fingervalues,0.6981317)  )
+                                if ( (object_grasped_process) && (fingers_settled) ) //&& (simplecontroller_finger(current_fingervalues,0.6981317)  )
                                 {
                                         
                                         std::cerr<< std::endl<<" object Grasped result " << object_grasped <<std::endl;
@@ -347,6 +492,7 @@ namespace kinova
                                         std::cerr<<"!!!!!!!!  finished !!!!!!!!!!!!"<<std::endl;
                                         //stop_jaco = true;
                                         finger_close = false;
+                                        has_active_finger_goal = false;
 
                                 }
                         }
@@ -360,11 +506,127 @@ namespace kinova
                         stop_jaco = false;
                 }
 
+                // only the fingers, an arm goal keeps going
+                if (stop_fingers)
+                {
+                        ROS_INFO(" Stopping the fingers of Jaco arm...");
+                        FAC_jaco->stopFingers();
+                        stop_fingers = false;
+                }
+
+                publishWatchdog();
         }
 
         void JacoActionController::watchdog(const ros::TimerEvent &e)
         {
-                // todo
+                // runs in the thread of the timer, the arm and its state are safe to use from there
+                ros::Time now = ros::Time::now();
+                ros::Time last_command;
+                bool streaming = jaco_apictrl->isStreamingJointVelocities(last_command);
+                JacoStateSnapshotConstPtr state = jaco_apictrl->getStateSnapshot();
+
+                boost::mutex::scoped_lock lock(watchdog_mutex);
+                if (watchdog_tripped)
+                        return;
+
+                double command_age = (now - last_command).toSec();
+                double state_age = (now - state->stamp).toSec();
+                bool moving = false;
+                for (size_t j = 0; j < NUM_JOINTS; j++)
+                        if (watchdog_velocity_tolerance[j] > 0.0 && fabs(state->joint_velocities[j]) > watchdog_velocity_tolerance[j])
+                                moving = true;
+
+                if (streaming && command_timeout > 0.0 && command_age > command_timeout)
+                        ROS_ERROR("Watchdog: no joint velocities sent for %.3f s, stopping the arm", command_age);
+                else if ((streaming || watchdog_armed) && state_timeout > 0.0 && state_age > state_timeout)
+                        ROS_ERROR("Watchdog: the state of the arm is %.3f s old, stopping the arm", state_age);
+                else if (!watchdog_deadline.isZero() && now > watchdog_deadline && moving)
+                {
+                        ROS_ERROR("Watchdog: the joint trajectory still moves after its goal time, stopping the arm");
+                        watchdog_goal_time = true;
+                }
+                else
+                        return;
+
+                // does not wait for the main loop, which may be the one stuck in the driver
+                jaco_apictrl->emergencyStop(streaming);
+                watchdog_tripped = true;
+        }
+
+        void JacoActionController::publishWatchdog()
+        {
+                boost::mutex::scoped_lock interpolation_lock(interpolation_mutex);
+
+                // the goal time runs from the end of the interpolated trajectory, or from when the FIFO ran empty
+                ros::Time deadline;
+                if (active_constraints.goal_time > 0.0)
+                {
+                        if (interpolating_joint)
+                                deadline = interpolation_start + ros::Duration(interpolator.getEndTime() + active_constraints.goal_time);
+                        else if (movejoint_done && fifo_emptied)
+                                deadline = fifo_empty_time + ros::Duration(active_constraints.goal_time);
+                }
+
+                boost::mutex::scoped_lock lock(watchdog_mutex);
+                // only arm motion, a finger goal alone does not stop the arm
+                watchdog_armed = move_joint || movejoint_done || start_interpolation || interpolating_joint || move_pose || movepose_done
+                                 || move_pose_trajectory || moveposetrajectory_done;
+                watchdog_deadline = deadline;
+                std::copy(active_constraints.goal_velocity, active_constraints.goal_velocity + NUM_JOINTS, watchdog_velocity_tolerance);
+        }
+
+        void JacoActionController::abortWatchdogGoals()
+        {
+                // commands sent by the last cycle after the watchdog stopped the arm are dropped as well
+                JTAC_jaco->eraseTrajectories();
+                {
+                        boost::mutex::scoped_lock lock(interpolation_mutex);
+                        stopInterpolation();
+                }
+
+                bool goal_time;
+                {
+                        boost::mutex::scoped_lock lock(watchdog_mutex);
+                        goal_time = watchdog_goal_time;
+                }
+
+                if (joint_active_goal.getGoal() && joint_active_goal.getGoalStatus().status == actionlib_msgs::GoalStatus::ACTIVE)
+                {
+                        jtaction_res.error_code = goal_time ? control_msgs::FollowJointTrajectoryResult::GOAL_TOLERANCE_VIOLATED
+                                                            : control_msgs::FollowJointTrajectoryResult::PATH_TOLERANCE_VIOLATED;
+                        joint_active_goal.setAborted(jtaction_res);
+                }
+                if (cartesian_active_goal.getGoal() && cartesian_active_goal.getGoalStatus().status == actionlib_msgs::GoalStatus::ACTIVE)
+                {
+                        cmaction_res.error_code = jaco::CartesianMovementResult::ABORTED;
+                        cartesian_active_goal.setAborted(cmaction_res);
+                }
+                if (cartesian_trajectory_active_goal.getGoal() && cartesian_trajectory_active_goal.getGoalStatus().status == actionlib_msgs::GoalStatus::ACTIVE)
+                {
+                        ctaction_res.error_code = jaco::CartesianTrajectoryResult::ABORTED;
+                        cartesian_trajectory_active_goal.setAborted(ctaction_res);
+                }
+                ROS_ERROR("Arm goals aborted after the watchdog stopped the arm");
+
+                // a finger goal is not aborted, its target went with the FIFO and is sent again
+                if (movefinger_done && finger_open)
+                        FAC_jaco->openFingers();
+                else if (movefinger_done && finger_close)
+                        FAC_jaco->closeFingers();
+
+                move_joint = false;
+                movejoint_done = false;
+                move_pose = false;
+                movepose_done = false;
+                move_pose_trajectory = false;
+                moveposetrajectory_done = false;
+                has_active_arm_goal = false;
+
+                boost::mutex::scoped_lock lock(watchdog_mutex);
+                watchdog_armed = false;
+                watchdog_deadline = ros::Time();
+                watchdog_goal_time = false;
+                watchdog_tripped = false;
         }
 
         void JacoActionController::joint_goalCB(JointGoalHandle gh)
@@ -378,76 +640,531 @@ namespace kinova
 
                         ROS_ERROR("Joints on incoming goal don't match our joints");
                         std::cerr << "Joints on incoming goal don't match our joints" << std::endl;
-                        gh.setRejected();
+                        control_msgs::FollowJointTrajectoryResult result;
+                        result.error_code = control_msgs::FollowJointTrajectoryResult::INVALID_JOINTS;
+                        gh.setRejected(result);
                         return;
                 }
 
-                // Cancels the currently active goal.
-                if (has_active_goal)
-                {
-                        ROS_DEBUG("Received new goal, canceling current goal");
+                // the interpolation of update() must not see half of the new goal
+                boost::mutex::scoped_lock lock(interpolation_mutex);
 
-                        // Marks the current goal as canceled.
-                        joint_active_goal.setCanceled();
-                        has_active_goal = false;
+                // Sends the trajectory along to the controller
+                ROS_DEBUG("Publishing trajectory");                
+
+                // any length is fine, the driver streams the points into the FIFO of the arm. Until the goal is
+                // accepted only locals are used, a rejected goal leaves the one running alone
+                control_msgs::FollowJointTrajectoryResult rejection;
+                rejection.error_code = control_msgs::FollowJointTrajectoryResult::INVALID_GOAL;
+                if (gh.getGoal()->trajectory.points.empty()){
+                    ROS_ERROR("Trajectory without points. Rejected!");
+                    std::cerr << "Trajectory without points. Rejected!" << std::endl;
+                    gh.setRejected(rejection);
+                    return;
                 }
 
+                // the tolerances of the goal are looked up by joint name once, not every cycle
+                JacoTrajectoryConstraints constraints;
+                if (!loadConstraints(*gh.getGoal(), constraints)){
+                    ROS_ERROR("Tolerances for joints the arm does not have. Rejected!");
+                    rejection.error_code = control_msgs::FollowJointTrajectoryResult::INVALID_JOINTS;
+                    gh.setRejected(rejection);
+                    return;
+                }
 
-                // Sends the trajectory along to the controller
-                ROS_DEBUG("Publishing trajectory");                
+                // the points in our joint order, the update loop does not look into the goal again
+                JacoCompiledTrajectory trajectory;
+                if (!trajectory.compile(gh.getGoal()->trajectory, joints_name)){
+                    ROS_ERROR("Trajectory points without a position for every joint. Rejected!");
+                    gh.setRejected(rejection);
+                    return;
+                }
 
-                int ct = 0;
-                num_jointTrajectory = 0;
-                num_jointTrajectory = gh.getGoal()->trajectory.points.size();
+                // the angles of the continuous joints are in [-pi, pi], the interpolation goes on from where it
+                // starts the short way round instead of turning a joint back across the whole circle
+                if (interpolate_trajectories)
+                {
+                        double start[NUM_JOINTS];
+                        if (interpolating_joint && splice_trajectories)
+                                interpolator.sample((ros::Time::now() - interpolation_start).toSec(), start, NULL, NULL);
+                        else
+                        {
+                                const std::vector<double> &current = JTAC_jaco->getJointAngles();
+                                std::copy(current.begin(), current.end(), start);
+                        }
+                        trajectory.unwrap(start);
+                }
 
-                if (num_jointTrajectory > 100){
-                    ROS_ERROR("Trajectory longer than 50. Rejected!");
-                    std::cerr << "Trajectory longer than 50. Rejected!" << std::endl;
-                    gh.setRejected();
+                // goals without usable timing, or slower than the arm could go, are retimed
+                if (interpolate_trajectories && retime_trajectories)
+                        retimeTrajectory(trajectory);
+
+                if (interpolate_trajectories && !loadInterpolator(trajectory)){
+                    ROS_ERROR("Trajectory times not increasing or sizes not matching. Rejected!");
+                    gh.setRejected(rejection);
                     return;
                 }
 
+                // Cancels the currently active arm goal, when splicing a joint goal the arm keeps moving
+                // and the new goal continues from its motion
+                preemptArmGoal(splice_trajectories);
+
                 gh.setAccepted();
                 joint_active_goal = gh;
-                has_active_goal = true;
-
+                has_active_arm_goal = true;
+                active_constraints = constraints;
+                num_jointTrajectory = trajectory.size();
 
-                desired_jtangles.resize(num_jointTrajectory * 6);
 
                 std::cerr<<"num_jointTrajectory  "<<num_jointTrajectory<<std::endl;
 
-                for(unsigned int i = 0 ; i < gh.getGoal()->trajectory.points.size(); i++)
-                {
-                        for (int j = 0; j < 6; j++)
-                        {
-                                desired_jtangles.at(ct) = gh.getGoal()->trajectory.points.at(i).positions.at(j);
-                                ct = ct+1;                                
-                        }
-                }
+                desired_jtangles = trajectory.positions;
 
                 //save the estimated duration of the trajectory
-                trajectory_duration = gh.getGoal()->trajectory.points.at(num_jointTrajectory - 1).time_from_start.toSec();
+                trajectory_duration = trajectory.duration();
 
-                move_joint = true;  
+                // the arm slows down at every point of its FIFO, the ones on a straight line are not needed
+                if (simplify_trajectories && !interpolate_trajectories)
+                {
+                        std::vector<double> simplified;
+                        JacoTrajectorySimplifier::simplify(desired_jtangles, simplify_tolerances, simplified);
+                        ROS_INFO("Joint trajectory simplified from %d to %d points", num_jointTrajectory, (int)(simplified.size() / 6));
+                        desired_jtangles.swap(simplified);
+                        num_jointTrajectory = desired_jtangles.size() / 6;
+                }
+
+                if (interpolate_trajectories)
+                        start_interpolation = true;
+                else
+                        move_joint = true;  
 
         }
 
         void JacoActionController::joint_cancelCB(JointGoalHandle gh)
         {
                 ROS_DEBUG("Received action cancel request");
+                boost::mutex::scoped_lock lock(interpolation_mutex);
                 if (joint_active_goal == gh)
                 {
                         // Stops the controller.
                         stop_jaco = true;
+                        stopInterpolation();
 
                         // Marks the current goal as canceled.
                         joint_active_goal.setCanceled();
-                        has_active_goal = false;
+                        has_active_arm_goal = false;
 
                         std::cout << "Joint goal canceled" << std::endl;
                 }
         }
 
+        bool JacoActionController::loadConstraints(const control_msgs::FollowJointTrajectoryGoal &goal, JacoTrajectoryConstraints &constraints)
+        {
+                // as control_msgs/JointTolerance: 0 keeps the default of the parameters, -1 removes the tolerance
+                constraints = default_constraints;
+                for (size_t i = 0; i < goal.path_tolerance.size(); i++)
+                {
+                        size_t j = std::find(joints_name.begin(), joints_name.end(), goal.path_tolerance[i].name) - joints_name.begin();
+                        if (j == joints_name.size())
+                                return false;
+                        if (goal.path_tolerance[i].position != 0.0)
+                                constraints.path[j] = goal.path_tolerance[i].position;
+                }
+                for (size_t i = 0; i < goal.goal_tolerance.size(); i++)
+                {
+                        size_t j = std::find(joints_name.begin(), joints_name.end(), goal.goal_tolerance[i].name) - joints_name.begin();
+                        if (j == joints_name.size())
+                                return false;
+                        if (goal.goal_tolerance[i].position != 0.0)
+                                constraints.goal[j] = goal.goal_tolerance[i].position;
+                        if (goal.goal_tolerance[i].velocity != 0.0)
+                                constraints.goal_velocity[j] = goal.goal_tolerance[i].velocity;
+                }
+                if (goal.goal_time_tolerance.toSec() != 0.0)
+                        constraints.goal_time = goal.goal_time_tolerance.toSec();
+                return true;
+        }
+
+        void JacoActionController::monitorFifoTrajectory()
+        {
+                const std::vector<double>& velocities = JTAC_jaco->getJointVelocities();
+                double error[NUM_JOINTS], actual_velocities[NUM_JOINTS];
+                std::copy(velocities.begin(), velocities.end(), actual_velocities);
+
+                // the arm picks its own timing between the points, so the path is checked against the segments
+                // around the point it is heading for, starting from where it was when the trajectory was sent.
+                // Spliced points were checked against the path before the upload, and the arm is somewhere
+                // in the old ones still in the FIFO.
+                if (!fifo_spliced)
+                {
+                        double tolerances[NUM_JOINTS];
+                        active_constraints.pathTolerances(tolerances);
+                        int target = std::max(0, std::min(num_jointTrajectory - num_activeTrajectory, num_jointTrajectory - 1));
+                        const double *from = target > 0 ? &desired_jtangles[(target - 1) * NUM_JOINTS] : &fifo_start_jtangles[0];
+                        double deviation = JacoTrajectorySimplifier::deviation(from, &desired_jtangles[target * NUM_JOINTS], &current_jtangles[0], tolerances);
+                        // the FIFO count may change a little before or after the arm passes a point
+                        if (target > 1)
+                                deviation = std::min(deviation, JacoTrajectorySimplifier::deviation(&desired_jtangles[(target - 2) * NUM_JOINTS], from, &current_jtangles[0], tolerances));
+                        if (target + 1 < num_jointTrajectory)
+                                deviation = std::min(deviation, JacoTrajectorySimplifier::deviation(&desired_jtangles[target * NUM_JOINTS], &desired_jtangles[(target + 1) * NUM_JOINTS], &current_jtangles[0], tolerances));
+                        if (deviation > 1.0)
+                        {
+                                ROS_ERROR("Joint trajectory left its path tolerance before point %d. Aborted!", target);
+                                jtaction_res.error_code = control_msgs::FollowJointTrajectoryResult::PATH_TOLERANCE_VIOLATED;
+                                joint_active_goal.setAborted(jtaction_res);
+                                stop_jaco = true;
+                                movejoint_done = false;
+                                has_active_arm_goal = false;
+                                return;
+                        }
+                }
+
+                //if all trajectories have been executed
+                if (num_activeTrajectory != 0)
+                        return;
+
+                if (!FAC_jaco->isApiInCtrl())
+                {
+                        std::cerr<<"No active trajectories but API is not in control. Aborted!"<<std::endl;
+                        jtaction_res.error_code = control_msgs::FollowJointTrajectoryResult::GOAL_TOLERANCE_VIOLATED;
+                        joint_active_goal.setAborted(jtaction_res);
+                        movejoint_done = false;
+                        has_active_arm_goal = false;
+                        return;
+                }
+
+                // done as soon as the arm has settled at the last point, the nominal duration does not matter
+                const double *last = &desired_jtangles[(num_jointTrajectory - 1) * NUM_JOINTS];
+                for (size_t j = 0; j < NUM_JOINTS; j++)
+                        error[j] = jointAngleDifference(j, last[j], current_jtangles[j]);
+                int violation = active_constraints.goalViolation(error, actual_velocities);
+                if (violation < 0)
+                {
+                        jtaction_res.error_code = control_msgs::FollowJointTrajectoryResult::SUCCESSFUL;
+                        movejoint_done = false;
+                        joint_active_goal.setSucceeded(jtaction_res);
+
+                        std::cout<<" Final angles in degree"<<std::endl;
+                        for(int i = 0; i< 6; i++)
+                        std::cout<<current_jtangles.at(i)*RTD<<"  ";
+                        std::cout<<"---------------"<<std::endl;
+                        std::cout<<" Final angles in Radian"<<std::endl;
+                        for(int i = 0; i< 6; i++)
+                        std::cout<<current_jtangles.at(i)<<"  "<<std::endl;
+
+                        std::cerr<<"!!!!!!!!  finished !!!!!!!!!!!!"<<std::endl;
+                        has_active_arm_goal = false;
+                        return;
+                }
+
+                // the goal time runs from the nominal end, or from when the FIFO ran empty if that was later.
+                // As the joint_trajectory_controller, 0 waits for the goal without a limit.
+                ros::Time now = ros::Time::now();
+                if (!fifo_emptied)
+                {
+                        fifo_empty_time = std::max(now, ros::Time(trajectory_start_time + trajectory_duration));
+                        fifo_emptied = true;
+                }
+                if (active_constraints.goal_time > 0.0 && (now - fifo_empty_time).toSec() > active_constraints.goal_time)
+                {
+                        ROS_ERROR("Joint trajectory goal not reached %.2f s after its end, %s is %.4f rad off at %.4f rad/s. Aborted!",
+                                  active_constraints.goal_time, joints_name[violation].c_str(), error[violation], actual_velocities[violation]);
+                        jtaction_res.error_code = control_msgs::FollowJointTrajectoryResult::GOAL_TOLERANCE_VIOLATED;
+                        joint_active_goal.setAborted(jtaction_res);
+                        movejoint_done = false;
+                        has_active_arm_goal = false;
+                }
+        }
+
+        void JacoActionController::retimeTrajectory(JacoCompiledTrajectory &trajectory)
+        {
+                bool timed = trajectory.duration() > 0.0;
+                for (size_t i = 1; i < trajectory.size(); i++)
+                        timed = timed && trajectory.times[i] > trajectory.times[i - 1];
+
+                // A goal preempting an interpolated motion is spliced onto it: only its own points are retimed, and
+                // the interpolator takes the arm from its setpoint, with the velocity of that, to the first of them
+                // (see startInterpolation()). Otherwise the goal starts from where the arm is, at rest.
+                bool splice = interpolating_joint && splice_trajectories;
+                std::vector<double> path;
+                if (!splice)
+                {
+                        const std::vector<double> &current = JTAC_jaco->getJointAngles();
+                        path.assign(current.begin(), current.end());
+                }
+                path.insert(path.end(), trajectory.positions.begin(), trajectory.positions.end());
+
+                std::vector<double> positions, times, velocities;
+                if (!retimer.retime(path, positions, times, velocities))
+                {
+                        ROS_WARN("Joint trajectory could not be retimed, its own timing is kept");
+                        return;
+                }
+
+                // the time to the first point: braking from the velocity of the setpoint, then going there from rest
+                double lead = 0.0;
+                if (splice)
+                {
+                        double start[NUM_JOINTS], start_velocities[NUM_JOINTS];
+                        interpolator.sample((ros::Time::now() - interpolation_start).toSec(), start, start_velocities, NULL);
+
+                        std::vector<double> lead_in(start, start + NUM_JOINTS), lead_positions, lead_times, lead_velocities;
+                        lead_in.insert(lead_in.end(), trajectory.positions.begin(), trajectory.positions.begin() + NUM_JOINTS);
+                        if (!retimer.retime(lead_in, lead_positions, lead_times, lead_velocities))
+                        {
+                                ROS_WARN("Joint trajectory could not be retimed, its own timing is kept");
+                                return;
+                        }
+                        double braking = 0.0;
+                        for (size_t j = 0; j < NUM_JOINTS; j++)
+                                braking = std::max(braking, fabs(start_velocities[j]) / retime_max_acceleration[j]);
+                        lead = lead_times.back() + braking;
+                }
+                if (timed && trajectory.duration() <= retime_slack * (lead + times.back()))
+                        return;
+
+                for (size_t i = 0; i < times.size(); i++)
+                        times[i] += lead;
+                ROS_INFO("Joint trajectory retimed from %.2f s to %.2f s", trajectory.duration(), times.back());
+                trajectory.positions.swap(positions);
+                trajectory.times.swap(times);
+                trajectory.velocities.swap(velocities);
+                trajectory.accelerations.clear();
+        }
+
+        bool JacoActionController::loadInterpolator(const JacoCompiledTrajectory &trajectory)
+        {
+                // only checked here, the start is added by startInterpolation()
+                JacoTrajectoryInterpolator check;
+                if (!check.setTrajectory(trajectory.times, trajectory.positions, trajectory.velocities, trajectory.accelerations))
+                        return false;
+
+                pending_trajectory = trajectory;
+                return true;
+        }
+
+        void JacoActionController::startInterpolation()
+        {
+                std::vector<double> times, positions, velocities, accelerations;
+
+                // a trajectory not starting at 0 s starts from the setpoint the arm follows when it is spliced on,
+                // from where the arm is otherwise
+                if (pending_trajectory.times.front() > 0.0)
+                {
+                        double start[NUM_JOINTS], start_velocities[NUM_JOINTS], start_accelerations[NUM_JOINTS];
+                        if (interpolating_joint)
+                                interpolator.sample((ros::Time::now() - interpolation_start).toSec(), start, start_velocities, start_accelerations);
+                        else
+                        {
+                                const std::vector<double>& current = JTAC_jaco->getJointAngles();
+                                std::copy(current.begin(), current.end(), start);
+                                std::fill(start_velocities, start_velocities + NUM_JOINTS, 0.0);
+                                std::fill(start_accelerations, start_accelerations + NUM_JOINTS, 0.0);
+                        }
+
+                        times.push_back(0.0);
+                        positions.assign(start, start + NUM_JOINTS);
+                        if (!pending_trajectory.velocities.empty())
+                                velocities.assign(start_velocities, start_velocities + NUM_JOINTS);
+                        if (!pending_trajectory.accelerations.empty())
+                                accelerations.assign(start_accelerations, start_accelerations + NUM_JOINTS);
+                }
+                times.insert(times.end(), pending_trajectory.times.begin(), pending_trajectory.times.end());
+                positions.insert(positions.end(), pending_trajectory.positions.begin(), pending_trajectory.positions.end());
+                velocities.insert(velocities.end(), pending_trajectory.velocities.begin(), pending_trajectory.velocities.end());
+                accelerations.insert(accelerations.end(), pending_trajectory.accelerations.begin(), pending_trajectory.accelerations.end());
+                interpolator.setTrajectory(times, positions, velocities, accelerations);
+
+                // a spliced trajectory goes on with the integrals of the one before
+                if (!interpolating_joint)
+                        tracking_controller.reset();
+                last_tracking_time = ros::Time::now();
+
+                // the trajectory starts at its stamp, or right away if that has passed
+                interpolation_start = std::max(ros::Time::now(), pending_trajectory.stamp);
+                start_interpolation = false;
+                interpolating_joint = true;
+                ROS_INFO("Joint trajectory of %.2f s followed with joint velocities", interpolator.getEndTime());
+        }
+
+        void JacoActionController::updateInterpolation()
+        {
+                double t = (ros::Time::now() - interpolation_start).toSec();
+                double desired[NUM_JOINTS], desired_velocities[NUM_JOINTS];
+                interpolator.sample(t, desired, desired_velocities, NULL);
+
+                const std::vector<double>& current = JTAC_jaco->getJointAngles();
+
+                control_msgs::FollowJointTrajectoryFeedback feedback;
+                feedback.header.stamp = ros::Time::now();
+                feedback.joint_names = joints_name;
+                feedback.desired.positions.assign(desired, desired + NUM_JOINTS);
+                feedback.desired.velocities.assign(desired_velocities, desired_velocities + NUM_JOINTS);
+                feedback.actual.positions = current;
+                feedback.actual.velocities = JTAC_jaco->getJointVelocities();
+                feedback.desired.time_from_start = ros::Duration(std::max(t, 0.0));
+                feedback.actual.time_from_start = feedback.desired.time_from_start;
+
+                // the velocities of the trajectory, and a PID pulling back onto it
+                double actual[NUM_JOINTS], actual_velocities[NUM_JOINTS], command[NUM_JOINTS];
+                std::copy(current.begin(), current.end(), actual);
+                std::copy(feedback.actual.velocities.begin(), feedback.actual.velocities.end(), actual_velocities);
+                ros::Time now = ros::Time::now();
+                tracking_controller.update((now - last_tracking_time).toSec(), desired, desired_velocities, actual, actual_velocities, command);
+                last_tracking_time = now;
+
+                double error[NUM_JOINTS];
+                for (size_t j = 0; j < NUM_JOINTS; j++)
+                {
+                        error[j] = jointAngleDifference(j, desired[j], current[j]);
+                        feedback.error.positions.push_back(error[j]);
+                        feedback.error.velocities.push_back(desired_velocities[j] - actual_velocities[j]);
+                }
+                joint_active_goal.publishFeedback(feedback);
+                int path_violation = active_constraints.pathViolation(error);
+
+                if (!JTAC_jaco->isApiInCtrl())
+                {
+                        ROS_ERROR("API control lost while following the joint trajectory. Aborted!");
+                        jtaction_res.error_code = control_msgs::FollowJointTrajectoryResult::GOAL_TOLERANCE_VIOLATED;
+                        joint_active_goal.setAborted(jtaction_res);
+                        stopInterpolation();
+                        has_active_arm_goal = false;
+                        return;
+                }
+
+                if (path_violation >= 0)
+                {
+                        ROS_ERROR("Joint trajectory: %s %.4f rad off its path. Aborted!", joints_name[path_violation].c_str(), error[path_violation]);
+                        jtaction_res.error_code = control_msgs::FollowJointTrajectoryResult::PATH_TOLERANCE_VIOLATED;
+                        joint_active_goal.setAborted(jtaction_res);
+                        stopInterpolation();
+                        has_active_arm_goal = false;
+                        return;
+                }
+
+                // settled at the last point, within the goal tolerances and below their velocities
+                double end = interpolator.getEndTime();
+                if (t >= end && active_constraints.goalViolation(error, actual_velocities) < 0)
+                {
+                        ROS_INFO("Joint trajectory finished %.2f s after its end", t - end);
+                        jtaction_res.error_code = control_msgs::FollowJointTrajectoryResult::SUCCESSFUL;
+                        joint_active_goal.setSucceeded(jtaction_res);
+                        stopInterpolation();
+                        has_active_arm_goal = false;
+                        return;
+                }
+
+                // as the joint_trajectory_controller, 0 waits for the goal without a limit
+                if (t >= end && active_constraints.goal_time > 0.0 && t > end + active_constraints.goal_time)
+                {
+                        int joint = std::max(active_constraints.goalViolation(error, actual_velocities), 0);
+                        ROS_ERROR("Joint trajectory goal not reached %.2f s after its end, %s is %.4f rad off at %.4f rad/s. Aborted!",
+                                  active_constraints.goal_time, joints_name[joint].c_str(), error[joint], actual_velocities[joint]);
+                        jtaction_res.error_code = control_msgs::FollowJointTrajectoryResult::GOAL_TOLERANCE_VIOLATED;
+                        joint_active_goal.setAborted(jtaction_res);
+                        stopInterpolation();
+                        has_active_arm_goal = false;
+                        return;
+                }
+
+                if (!JTAC_jaco->setJointVelocities(command))
+                {
+                        // e.g. the arm would collide with itself or leave the workspace
+                        ROS_ERROR("Joint trajectory stopped by the Jaco arm. Aborted!");
+                        jtaction_res.error_code = control_msgs::FollowJointTrajectoryResult::INVALID_GOAL;
+                        joint_active_goal.setAborted(jtaction_res);
+                        stopInterpolation();
+                        has_active_arm_goal = false;
+                }
+        }
+
+        void JacoActionController::stopInterpolation()
+        {
+                if (interpolating_joint || start_interpolation)
+                        stop_joint_velocities = true;
+                interpolating_joint = false;
+                start_interpolation = false;
+        }
+
+        bool JacoActionController::sendJointTrajectory()
+        {
+                // the FIFO is erased for a new trajectory, so the arm stops unless it can be spliced on
+                fifo_spliced = splice_trajectories && JTAC_jaco->spliceJointSpaceTrajectory(desired_jtangles, simplify_tolerances);
+                if (fifo_spliced)
+                        return true;
+                return JTAC_jaco->setJointSpaceTrajectory(desired_jtangles);
+        }
+
+        bool JacoActionController::sendCartesianGoal()
+        {
+                double ps[6];
+
+                for ( int i = 0; i < 6; i++)
+                        ps[i] = desired_pose.at(i);
+
+                if (scale_cartesian_speed)
+                {
+                        // no limitation at all far from singularities, the arm keeps its own speed
+                        commanded_speed_scale = CMAC_jaco->getSingularityState().speed_scale;
+                        rescale_time = ros::Time::now();
+                        if (commanded_speed_scale >= 1.0)
+                                CMAC_jaco->setCartesianSpeedLimit(0.0, 0.0);
+                        else
+                                CMAC_jaco->setCartesianSpeedLimit(max_linear_speed * commanded_speed_scale, max_angular_speed * commanded_speed_scale);
+                }
+
+                if (!CMAC_jaco->setAbsPose(ps))
+                        return false;
+
+                // the workspace fences may have moved the target, the goal is reached there
+                for ( int i = 0; i < 6; i++)
+                        desired_pose.at(i) = ps[i];
+                return true;
+        }
+
+        bool JacoActionController::hasActiveArmGoal() const
+        {
+                return has_active_arm_goal;
+        }
+
+        void JacoActionController::preemptArmGoal(bool keep_joint_motion)
+        {
+                // a canceled goal stopped the arm already, the new one must not be erased by that stop
+                if (stop_jaco)
+                {
+                        stop_jaco = false;
+                        erase_arm_fifo = true;
+                }
+
+                if (!has_active_arm_goal)
+                        return;
+                ROS_DEBUG("Received new goal, canceling current goal");
+
+                // only one of them is active, the arm is one resource
+                bool joint_active = joint_active_goal.getGoal() && joint_active_goal.getGoalStatus().status == actionlib_msgs::GoalStatus::ACTIVE;
+                if (joint_active)
+                        joint_active_goal.setCanceled();
+                if (cartesian_active_goal.getGoal() && cartesian_active_goal.getGoalStatus().status == actionlib_msgs::GoalStatus::ACTIVE)
+                        cartesian_active_goal.setCanceled();
+                if (cartesian_trajectory_active_goal.getGoal() && cartesian_trajectory_active_goal.getGoalStatus().status == actionlib_msgs::GoalStatus::ACTIVE)
+                        cartesian_trajectory_active_goal.setCanceled();
+
+                move_joint = false;
+                movejoint_done = false;
+                move_pose = false;
+                movepose_done = false;
+                move_pose_trajectory = false;
+                moveposetrajectory_done = false;
+                has_active_arm_goal = false;
+
+                if (!(joint_active && keep_joint_motion))
+                {
+                        stopInterpolation();
+                        erase_arm_fifo = true;
+                }
+        }
+
         void JacoActionController::cartesian_goalCB(CartesianGoalHandle gh)
         {
                 // Ensures that the joints in the goal match the joints we are commanding.
@@ -460,19 +1177,15 @@ namespace kinova
                         return;
                 }
 
-                // Cancels the currently active goal.
-                if (has_active_goal)
+                // Cancels the currently active arm goal.
                 {
-                        ROS_DEBUG("Received new goal, canceling current goal");
-
-                        // Marks the current goal as canceled.
-                        cartesian_active_goal.setCanceled();
-                        has_active_goal = false;
+                        boost::mutex::scoped_lock lock(interpolation_mutex);
+                        preemptArmGoal(false);
                 }
 
                 gh.setAccepted();
                 cartesian_active_goal = gh;
-                has_active_goal = true;
+                has_active_arm_goal = true;
 
 
                 desired_pose.at(0) = gh.getGoal()->poseGoal.position.x;
@@ -496,7 +1209,172 @@ namespace kinova
 
                         // Marks the current goal as canceled.
                         cartesian_active_goal.setCanceled();
-                        has_active_goal = false;
+                        has_active_arm_goal = false;
+                }
+        }
+
+        void JacoActionController::limitCartesianTrajectorySpeed()
+        {
+                // the FIFO of the arm has no timing, the speed limit the poses are added with is what there is.
+                // Poses streamed later get the limit of when they are uploaded, so it follows the singularities.
+                double linear = trajectory_linear_speed, angular = trajectory_angular_speed;
+                commanded_speed_scale = scale_cartesian_speed ? CMAC_jaco->getSingularityState().speed_scale : 1.0;
+                rescale_time = ros::Time::now();
+                if (commanded_speed_scale < 1.0)
+                {
+                        linear = std::min(linear > 0.0 ? linear : max_linear_speed, max_linear_speed * commanded_speed_scale);
+                        angular = std::min(angular > 0.0 ? angular : max_angular_speed, max_angular_speed * commanded_speed_scale);
+                }
+                CMAC_jaco->setCartesianSpeedLimit(linear, angular);
+        }
+
+        bool JacoActionController::rescaleDue(double speed_scale) const
+        {
+                // slowing down is not put off, speeding up has a hysteresis and waits
+                if (speed_scale < commanded_speed_scale - rescale_step)
+                        return true;
+                bool faster = speed_scale > commanded_speed_scale + 2.0 * rescale_step || (speed_scale >= 1.0 && commanded_speed_scale < 1.0);
+                return faster && (ros::Time::now() - rescale_time).toSec() > rescale_interval;
+        }
+
+        void JacoActionController::monitorCartesianTrajectory()
+        {
+                double speed_scale = CMAC_jaco->getSingularityState().speed_scale;
+                if (scale_cartesian_speed && CMAC_jaco->getQueuedTrajectoryNumber() > 0 && rescaleDue(speed_scale))
+                        limitCartesianTrajectorySpeed();
+
+                // the poses not in the FIFO yet are still to come
+                int remaining = CMAC_jaco->getCurrentTrajectoryNumber() + CMAC_jaco->getQueuedTrajectoryNumber();
+                int point = std::max(0, std::min(num_poseTrajectory - remaining, num_poseTrajectory - 1));
+                current_pose = CMAC_jaco->getApiPose();
+
+                // once per pose, not every cycle
+                if (point != pose_feedback_point)
+                {
+                        jaco::CartesianTrajectoryFeedback feedback;
+                        feedback.current_point = point;
+                        feedback.num_points = num_poseTrajectory;
+                        feedback.actual.position.x = current_pose[0];
+                        feedback.actual.position.y = current_pose[1];
+                        feedback.actual.position.z = current_pose[2];
+                        feedback.actual.orientation.x = current_pose[3];
+                        feedback.actual.orientation.y = current_pose[4];
+                        feedback.actual.orientation.z = current_pose[5];
+                        cartesian_trajectory_active_goal.publishFeedback(feedback);
+                        pose_feedback_point = point;
+                }
+
+                if (remaining != 0)
+                        return;
+
+                if (!CMAC_jaco->isApiInCtrl())
+                {
+                        ROS_ERROR("API control lost while following the cartesian trajectory. Aborted!");
+                        ctaction_res.error_code = jaco::CartesianTrajectoryResult::ABORTED;
+                        cartesian_trajectory_active_goal.setAborted(ctaction_res);
+                        moveposetrajectory_done = false;
+                        has_active_arm_goal = false;
+                        return;
+                }
+
+                const jaco::JacoPose &last = desired_pose_trajectory.points.back();
+                double target[6] = { last.position.x, last.position.y, last.position.z, last.orientation.x, last.orientation.y, last.orientation.z };
+                if (is_cartesianSpaceTrajectory_finished(current_pose, std::vector<double>(target, target + 6)))
+                {
+                        ctaction_res.error_code = jaco::CartesianTrajectoryResult::SUCCESSFUL;
+                        moveposetrajectory_done = false;
+                        cartesian_trajectory_active_goal.setSucceeded(ctaction_res);
+                        ROS_INFO("Cartesian trajectory finished");
+                        has_active_arm_goal = false;
+                }
+        }
+
+        void JacoActionController::cartesian_trajectory_goalCB(CartesianTrajectoryGoalHandle gh)
+        {
+                ROS_INFO("Received goal: cartesian_trajectory_goalCB");
+                jaco::CartesianTrajectoryResult rejection;
+                rejection.error_code = jaco::CartesianTrajectoryResult::INVALID_GOAL;
+
+                const jaco::JacoPoseTrajectory &trajectory = gh.getGoal()->trajectory;
+                const std::vector<ros::Duration> &times = gh.getGoal()->time_from_start;
+                if (trajectory.header.frame_id != "base_jaco")
+                {
+                        ROS_ERROR("Pose.header on incoming goal don't match our Pose.header");
+                        gh.setRejected(rejection);
+                        return;
+                }
+                if (trajectory.points.empty() || (!times.empty() && times.size() != trajectory.points.size()))
+                {
+                        ROS_ERROR("Cartesian trajectory without poses, or not a time for each. Rejected!");
+                        gh.setRejected(rejection);
+                        return;
+                }
+
+                // the fastest any segment has to be, from the current pose for the first one
+                double linear = 0.0, angular = 0.0;
+                const std::vector<double> &start = CMAC_jaco->getApiPose();
+                double from[6] = { start[0], start[1], start[2], start[3], start[4], start[5] };
+                double previous_time = 0.0;
+                for (size_t i = 0; i < times.size(); i++)
+                {
+                        const jaco::JacoPose &p = trajectory.points[i];
+                        double to[6] = { p.position.x, p.position.y, p.position.z, p.orientation.x, p.orientation.y, p.orientation.z };
+                        double dt = times[i].toSec() - previous_time;
+                        if (dt <= 0.0 && (i > 0 || times[i].toSec() < 0.0))
+                        {
+                                ROS_ERROR("Cartesian trajectory times not increasing. Rejected!");
+                                gh.setRejected(rejection);
+                                return;
+                        }
+                        if (dt > 0.0)
+                        {
+                                double distance = sqrt((to[0]-from[0])*(to[0]-from[0]) + (to[1]-from[1])*(to[1]-from[1]) + (to[2]-from[2])*(to[2]-from[2]));
+                                double rotation = 0.0;
+                                for (int j = 3; j < 6; j++)
+                                        rotation = std::max(rotation, fabs(atan2(sin(to[j] - from[j]), cos(to[j] - from[j]))));
+                                linear = std::max(linear, distance / dt);
+                                angular = std::max(angular, rotation / dt);
+                        }
+                        std::copy(to, to + 6, from);
+                        previous_time = times[i].toSec();
+                }
+
+                // Cancels the currently active arm goal.
+                {
+                        boost::mutex::scoped_lock lock(interpolation_mutex);
+                        preemptArmGoal(false);
+                }
+
+                gh.setAccepted();
+                cartesian_trajectory_active_goal = gh;
+                has_active_arm_goal = true;
+
+                // a segment that does not turn or does not move takes the speed the other one allows
+                trajectory_linear_speed = linear;
+                trajectory_angular_speed = angular;
+                if (!times.empty() && linear <= 0.0)
+                        trajectory_linear_speed = max_linear_speed;
+                if (!times.empty() && angular <= 0.0)
+                        trajectory_angular_speed = max_angular_speed;
+
+                desired_pose_trajectory = trajectory;
+                num_poseTrajectory = trajectory.points.size();
+                pose_feedback_point = -1;
+                move_pose_trajectory = true;
+        }
+
+        void JacoActionController::cartesian_trajectory_cancelCB(CartesianTrajectoryGoalHandle gh)
+        {
+                ROS_DEBUG("Received action cancel request");
+                if (cartesian_trajectory_active_goal == gh)
+                {
+                        // Stops the controller.
+                        stop_jaco = true;
+
+                        // Marks the current goal as canceled.
+                        cartesian_trajectory_active_goal.setCanceled();
+                        moveposetrajectory_done = false;
+                        has_active_arm_goal = false;
                 }
         }
 
@@ -505,19 +1383,21 @@ namespace kinova
 
                 ROS_INFO("Received goal: goalCB");               
 
-                // Cancels the currently active goal.
-                if (has_active_goal)
+                // Cancels the currently active finger goal, an arm goal is not affected.
+                if (has_active_finger_goal)
                 {
                         ROS_DEBUG("Received new goal, canceling current goal");
 
                         // Marks the current goal as canceled.
                         finger_active_goal.setCanceled();
-                        has_active_goal = false;
+                        has_active_finger_goal = false;
+                        finger_open = false;
+                        finger_close = false;
                 }
 
                 gh.setAccepted();
                 finger_active_goal = gh;
-                has_active_goal = true;
+                has_active_finger_goal = true;
 
                 move_finger = true;
                 finger_action = gh.getGoal()->task;
@@ -539,12 +1419,15 @@ namespace kinova
                 ROS_DEBUG("Received action cancel request");
                 if (finger_active_goal == gh)
                 {
-                        // Stops the controller.
-                        stop_jaco = true;
+                        // Stops the fingers, the arm keeps moving.
+                        stop_fingers = true;
 
                         // Marks the current goal as canceled.
                         finger_active_goal.setCanceled();
-                        has_active_goal = false;
+                        movefinger_done = false;
+                        finger_open = false;
+                        finger_close = false;
+                        has_active_finger_goal = false;
                 }
         }
 
@@ -562,7 +1445,9 @@ namespace kinova
 
                 while (ros::ok())
                 {
-                        fingers_current = jaco_apictrl->getFingersCurrent();
+                        // this runs in its own thread, so only use the snapshot of the state
+                        JacoStateSnapshotConstPtr state = jaco_apictrl->getStateSnapshot();
+                        fingers_current.assign(state->fingers_current.begin(), state->fingers_current.end());
 
 
                         if (fingers_current.at(0) > 0.2)
@@ -595,7 +1480,7 @@ namespace kinova
                                         object_grasped = true;
                                  }
 
-                                finger_current_angle  = jaco_apictrl->getFingersJointAngle();
+                                finger_current_angle.assign(state->fingers_jointangle.begin(), state->fingers_jointangle.end());
 
                                 //std::cerr<< " Chance of current gripping ="<<(finger_current_areas.at(0) +finger_current_areas.at(1) + finger_current_areas.at(2)) / 135.0<<std::endl;
                                 //std::cerr<< " Chance of current gripping ="<<(finger_current_areas.at(0) +finger_current_areas.at(1) + finger_current_areas.at(2)) <<std::endl;
@@ -613,27 +1498,6 @@ namespace kinova
 
 
 
-        bool JacoActionController::is_jointSpaceTrajectory_finished(const std::vector<double> &currentvalue, const std::vector<double> &targetvalue)
-        {
-                double tol_jtag = 2.0 * DTR; 	// tolerance = 2 degree
-
-                for(int i = 0; i< 6; i++)
-                        std::cout<<fabs(currentvalue.at(i) - targetvalue.at(i))<<"  ";
-                std::cout<<"---------------"<<std::endl;
-
-                if (	(fabs(currentvalue.at(0) - targetvalue.at(0)) < tol_jtag) &&
-                (fabs(currentvalue.at(1) - targetvalue.at(1)) < tol_jtag) &&
-                (fabs(currentvalue.at(2) - targetvalue.at(2)) < tol_jtag) &&
-                (fabs(currentvalue.at(3) - targetvalue.at(3)) < tol_jtag) &&
-                (fabs(currentvalue.at(4) - targetvalue.at(4)) < tol_jtag) &&
-                (fabs(currentvalue.at(5) - targetvalue.at(5)) < tol_jtag) )
-                        return true;
-
-                return false;
-
-        }
-
-
         bool JacoActionController::is_cartesianSpaceTrajectory_finished(const std::vector<double> &currentvalue, const std::vector<double> &targetvalue)
         {
 
@@ -653,45 +1517,6 @@ namespace kinova
 
         }
 
-        void JacoActionController::outerloopcontroller_jointSpace(const std::vector<double> &currentvalue, const std::vector<double> &targetvalue, const double error_factor)
-        {
-
-                std::vector<double> new_jtang(6,0.0);
-
-                for(int i = 0; i< 6; i++)
-                        new_jtang.at(i) = targetvalue.at(i) + (error_factor *( targetvalue.at(i) - currentvalue.at(i)) );
-
-                std::cout<<"!!!!!!!!!!!!!!!!!!!!!!!!!  Doing the brutal control !!!!!!!!!!!!!!!!!! "<<std::endl;
-
-                JTAC_jaco->setJointSpaceTrajectory(new_jtang);  
-        }
-
-        bool JacoActionController::is_trajectory_finished()
-        {
-
-                if (    (( fabs(dervErr_jtangles.at(0))< 0.000001 ) && ( fabs(old_dervErr_jtangles.at(0))< 0.000001 ) ) &&
-                        (( fabs(dervErr_jtangles.at(1))< 0.000001 ) && ( fabs(old_dervErr_jtangles.at(1))< 0.000001 ) ) &&
-                        (( fabs(dervErr_jtangles.at(2))< 0.000001 ) && ( fabs(old_dervErr_jtangles.at(2))< 0.000001 ) ) )
-                {
-                        derv_counter = derv_counter+1;
-                }
-                else
-                        derv_counter = 0;
-
-
-                if(derv_counter > 100)
-                {
-                        derv_counter = 0;
-                        //printf("%2.9f, %2.9f, %2.9f, %2.9f \n",error_jtangles.at(0), old_err_jtangles.at(0), time_diff, dervErr_jtangles.at(0));
-                        //printf("%2.9f, %2.9f, %2.9f, %2.9f \n",error_jtangles.at(1), old_err_jtangles.at(1), time_diff, dervErr_jtangles.at(1));
-                        //printf("%2.9f, %2.9f, %2.9f, %2.9f \n",error_jtangles.at(2), old_err_jtangles.at(2), time_diff, dervErr_jtangles.at(2));
-                        return true;
-                }
-
-                return false;
-
-        }
-
         void JacoActionController::calculate_error_dervError(const std::vector<double> &currentvalue, const std::vector<double> &targetvalue)
         {
 
@@ -702,7 +1527,7 @@ namespace kinova
 
                 for(int i = 0; i< 6; i++)
                 {
-                         error_jtangles.at(i) = targetvalue.at(i) - currentvalue.at(i);
+                         error_jtangles.at(i) = jointAngleDifference(i, targetvalue.at(i), currentvalue.at(i));
                          dervErr_jtangles.at(i) = (error_jtangles.at(i) - old_err_jtangles.at(i)) / time_diff;
                 }
 
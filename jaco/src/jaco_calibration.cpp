@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_calibration.cpp
+ *
+ *  PURPOSE ---  Conversion between the actuator degrees of the arm and the joint angles of the urdf
+ */
+
+#include <jaco/jaco_calibration.h>
+
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace kinova
+{
+	namespace
+	{
+		const double DTR = M_PI / 180.0;
+		const double RTD = 180.0 / M_PI;
+		const double TWO_PI = 2.0 * M_PI;
+	}
+
+	JacoCalibration::JacoCalibration()
+	{
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+		{
+			offsets_[i] = DEFAULT_JOINT_OFFSETS[i];
+			signs_[i] = DEFAULT_JOINT_SIGNS[i];
+		}
+	}
+
+	bool JacoCalibration::set(const double offsets[NUM_JOINTS], const double signs[NUM_JOINTS])
+	{
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			if (signs[i] != 1.0 && signs[i] != -1.0)
+				return false;
+
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+		{
+			offsets_[i] = offsets[i];
+			signs_[i] = signs[i];
+		}
+		return true;
+	}
+
+	void JacoCalibration::toJointAngles(const double actuator[NUM_JOINTS], double angles[NUM_JOINTS]) const
+	{
+		size_t i = 0;
+
+#ifdef __SSE2__
+		// two joints at once, rounding to the nearest turn with the conversion to int instead of looping
+		const __m128d dtr = _mm_set1_pd(DTR);
+		const __m128d two_pi = _mm_set1_pd(TWO_PI);
+		const __m128d turns_per_radian = _mm_set1_pd(1.0 / TWO_PI);
+
+		for (; i + 2 <= NUM_JOINTS; i += 2)
+		{
+			__m128d x = _mm_sub_pd(_mm_loadu_pd(&actuator[i]), _mm_loadu_pd(&offsets_[i]));
+			x = _mm_mul_pd(_mm_mul_pd(x, _mm_loadu_pd(&signs_[i])), dtr);
+
+			__m128d turns = _mm_cvtepi32_pd(_mm_cvtpd_epi32(_mm_mul_pd(x, turns_per_radian)));
+			_mm_storeu_pd(&angles[i], _mm_sub_pd(x, _mm_mul_pd(turns, two_pi)));
+		}
+#endif
+
+		for (; i < NUM_JOINTS; i++)
+		{
+			double x = signs_[i] * (actuator[i] - offsets_[i]) * DTR;
+			angles[i] = x - TWO_PI * floor(x / TWO_PI + 0.5);
+		}
+	}
+
+	void JacoCalibration::toActuatorPositions(const double angles[NUM_JOINTS], double actuator[NUM_JOINTS]) const
+	{
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			actuator[i] = signs_[i] * angles[i] * RTD + offsets_[i];
+	}
+
+	void JacoCalibration::toActuatorSpeeds(const double velocities[NUM_JOINTS], double actuator[NUM_JOINTS]) const
+	{
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			actuator[i] = signs_[i] * velocities[i] * RTD;
+	}
+}
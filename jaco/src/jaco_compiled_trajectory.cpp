@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_compiled_trajectory.cpp
+ *
+ *  PURPOSE ---  A joint trajectory goal compiled once into flat arrays in the joint order of the arm
+ */
+
+#include <jaco/jaco_compiled_trajectory.h>
+
+#include <algorithm>
+
+namespace kinova
+{
+	bool JacoCompiledTrajectory::compile(const trajectory_msgs::JointTrajectory& trajectory, const std::vector<std::string>& joint_names)
+	{
+		clear();
+		if (joint_names.size() != NUM_JOINTS)
+			return false;
+
+		// the joints of the goal may come in any order
+		size_t index[NUM_JOINTS];
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+		{
+			index[j] = std::find(trajectory.joint_names.begin(), trajectory.joint_names.end(), joint_names[j]) - trajectory.joint_names.begin();
+			if (index[j] == trajectory.joint_names.size())
+				return false;
+		}
+
+		bool has_velocities = true, has_accelerations = true;
+		for (size_t i = 0; i < trajectory.points.size(); i++)
+		{
+			if (trajectory.points[i].positions.size() != trajectory.joint_names.size())
+				return false;
+			has_velocities = has_velocities && trajectory.points[i].velocities.size() == trajectory.joint_names.size();
+			has_accelerations = has_accelerations && trajectory.points[i].accelerations.size() == trajectory.joint_names.size();
+		}
+		has_accelerations = has_accelerations && has_velocities;
+
+		size_t count = trajectory.points.size();
+		times.resize(count);
+		positions.resize(count * NUM_JOINTS);
+		velocities.resize(has_velocities ? count * NUM_JOINTS : 0);
+		accelerations.resize(has_accelerations ? count * NUM_JOINTS : 0);
+		for (size_t i = 0; i < count; i++)
+		{
+			const trajectory_msgs::JointTrajectoryPoint& p = trajectory.points[i];
+			times[i] = p.time_from_start.toSec();
+			for (size_t j = 0; j < NUM_JOINTS; j++)
+			{
+				positions[i*NUM_JOINTS + j] = p.positions[index[j]];
+				if (has_velocities)
+					velocities[i*NUM_JOINTS + j] = p.velocities[index[j]];
+				if (has_accelerations)
+					accelerations[i*NUM_JOINTS + j] = p.accelerations[index[j]];
+			}
+		}
+		stamp = trajectory.header.stamp;
+		return true;
+	}
+
+	void JacoCompiledTrajectory::unwrap(const double start[NUM_JOINTS])
+	{
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+		{
+			if (!CONTINUOUS_JOINTS[j])
+				continue;
+			double previous = start[j];
+			for (size_t i = j; i < positions.size(); i += NUM_JOINTS)
+			{
+				positions[i] = previous + jointAngleDifference(j, positions[i], previous);
+				previous = positions[i];
+			}
+		}
+	}
+
+	void JacoCompiledTrajectory::clear()
+	{
+		times.clear();
+		positions.clear();
+		velocities.clear();
+		accelerations.clear();
+		stamp = ros::Time();
+	}
+
+	size_t JacoCompiledTrajectory::size() const
+	{
+		return times.size();
+	}
+
+	const double* JacoCompiledTrajectory::point(size_t index) const
+	{
+		return &positions[index * NUM_JOINTS];
+	}
+
+	double JacoCompiledTrajectory::duration() const
+	{
+		return times.empty() ? 0.0 : times.back();
+	}
+}
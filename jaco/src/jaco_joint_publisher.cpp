@@ -27,32 +27,31 @@
 
 namespace kinova
 {
-        JacoJointPublisher::JacoJointPublisher(boost::shared_ptr<AbstractJaco> jaco) : jaco(jaco)
+        // messages allocated up front / maximum the pool grows to while intra-process subscribers hold them
+        const size_t JOINT_STATE_POOL_SIZE = 4;
+        const size_t JOINT_STATE_POOL_MAX_SIZE = 32;
+
+        JacoJointPublisher::JacoJointPublisher(boost::shared_ptr<AbstractJaco> jaco, ros::NodeHandle nh) : jaco(jaco)
         {
-                ros::NodeHandle nh;
                 jtang_pub = nh.advertise<sensor_msgs::JointState>   ("joint_states", 100);                
 
-                jointNames.resize(NUM_JOINTS);
-                fingers_jointName.resize(NUM_FINGER_JOINTS);
-                jointangles.resize(NUM_JOINTS);
-                joints_current.resize(NUM_JOINTS);
-                fingers_jointangle.resize(NUM_FINGER_JOINTS);
-                fingers_current.resize(NUM_FINGER_JOINTS);
+                // the names never change, so they are only written into the prototype message
+                sensor_msgs::JointState prototype;
+                prototype.name.resize(NUM_JOINTS + NUM_FINGER_JOINTS, "");
+                prototype.position.resize(NUM_JOINTS + NUM_FINGER_JOINTS, 0.0);
+                prototype.velocity.resize(NUM_JOINTS + NUM_FINGER_JOINTS, 0.0);
+                prototype.effort.resize(NUM_JOINTS + NUM_FINGER_JOINTS, 0.0);
+
+                const std::vector<std::string>& jointNames = jaco -> getJointNames();
+                const std::vector<std::string>& fingers_jointName = jaco -> getFingersJointName();
 
                 for(size_t i = 0; i < NUM_JOINTS ; i++)
-                {
-                        jointangles.at(i) 		= 0.0;
-                        joints_current.at(i) 		= 0.0;
-                        jointNames.at(i) 		= "";
-                }
+                        prototype.name.at(i) 			= jointNames.at(i);
 
                 for(size_t i = 0; i < NUM_FINGER_JOINTS; i++)
-                {
-                        fingers_jointangle.at(i)	= 0.0;
-                        fingers_current.at(i) 		= 0.0;
-                        fingers_jointName.at(i) 	= "";
-                }
+                        prototype.name.at(NUM_JOINTS + i) 	= fingers_jointName.at(i);
 
+                jtang_pool.reset(new MessagePool<sensor_msgs::JointState>(prototype, JOINT_STATE_POOL_SIZE, JOINT_STATE_POOL_MAX_SIZE));
         }
 
         JacoJointPublisher::~JacoJointPublisher()
@@ -62,32 +61,26 @@ namespace kinova
 	void JacoJointPublisher::update()
 	{
 		// publish joint angles 
-		sensor_msgs::JointStatePtr jtang_msg = boost::make_shared<sensor_msgs::JointState>();                
-		
-		jointNames 		= jaco -> getJointNames();
-		jointangles 		= jaco -> getJointAngles();
-                joints_current          = jaco -> getJointsCurrent();
-                fingers_jointName 	= jaco -> getFingersJointName();
-                fingers_jointangle 	= jaco -> getFingersJointAngle();
-                fingers_current 	= jaco -> getFingersCurrent();
-		
+		sensor_msgs::JointStatePtr jtang_msg = jtang_pool->acquire();
+
+		JacoStateSnapshotConstPtr state = jaco -> getStateSnapshot();
 		
 	  	for (size_t i = 0; i < NUM_JOINTS; i++)
 	  	{	
-			jtang_msg->name.push_back(jointNames[i]);    		
-	    		jtang_msg->position.push_back(jointangles[i]);	
-                        jtang_msg->effort.push_back(joints_current[i]);   	
+	    		jtang_msg->position[i] 	= state->joint_angles[i];
+	    		jtang_msg->velocity[i] 	= state->joint_velocities[i];
+                        jtang_msg->effort[i] 	= state->joints_current[i];
 	  	}
 
 		for (size_t i = 0; i < NUM_FINGER_JOINTS; i++)
 	  	{	
-                        jtang_msg->name.push_back(fingers_jointName[i]);
-                        jtang_msg->position.push_back(fingers_jointangle[i]);
-                        jtang_msg->effort.push_back(fingers_current[i]);
+                        jtang_msg->position[NUM_JOINTS + i] 	= state->fingers_jointangle[i];
+                        jtang_msg->velocity[NUM_JOINTS + i] 	= state->fingers_velocity[i];
+                        jtang_msg->effort[NUM_JOINTS + i] 	= state->fingers_current[i];
 	  	}
 	
-		
-	  	jtang_msg -> header.stamp = ros::Time::now();	                
+		// stamped with the time the values were read from the arm
+	  	jtang_msg -> header.stamp = state->stamp;
 
                 jtang_pub.publish (jtang_msg);
 
@@ -27,11 +27,19 @@
 
 namespace kinova
 {
-	JacoJoystickPublisher::JacoJoystickPublisher(boost::shared_ptr<AbstractJaco> jaco) : jaco(jaco)
+	// messages allocated up front / maximum the pool grows to while intra-process subscribers hold them
+	const size_t JOYSTICK_POOL_SIZE = 4;
+	const size_t JOYSTICK_POOL_MAX_SIZE = 32;
+
+	JacoJoystickPublisher::JacoJoystickPublisher(boost::shared_ptr<AbstractJaco> jaco, ros::NodeHandle nh) : jaco(jaco)
         {
-                ros::NodeHandle nh;
                 joystick_pub = nh.advertise<sensor_msgs::Joy>("jaco_joystick_state", 100);
 
+                sensor_msgs::Joy prototype;
+                prototype.axes.resize(NUM_JOYSTICK_AXES, 0.0);
+                prototype.buttons.resize(NUM_JOYSTICK_BUTTONS, 0);
+
+                joystick_pool.reset(new MessagePool<sensor_msgs::Joy>(prototype, JOYSTICK_POOL_SIZE, JOYSTICK_POOL_MAX_SIZE));
         }
 
         JacoJoystickPublisher::~JacoJoystickPublisher()
@@ -41,14 +49,17 @@ namespace kinova
 	void JacoJoystickPublisher::update()
 	{
 		// publish joystick state
-		sensor_msgs::JoyPtr joystick_msg = boost::make_shared<sensor_msgs::Joy>();
+		sensor_msgs::JoyPtr joystick_msg = joystick_pool->acquire();
+
+		JacoStateSnapshotConstPtr state = jaco->getStateSnapshot();
+
+		joystick_msg->header.stamp = state->stamp;
 
-		joystick_msg->header.stamp = ros::Time::now();
-		std::vector<float> float_vector(jaco->joystick_axes_states_.begin(), jaco->joystick_axes_states_.end());
-		joystick_msg->axes = float_vector;
+		for (size_t i = 0; i < NUM_JOYSTICK_AXES; i++)
+			joystick_msg->axes[i] = state->joystick_axes_states[i];
 
-		std::vector<int> bool_vector(jaco->joystick_button_states_.begin(), jaco->joystick_button_states_.end());
-		joystick_msg->buttons = bool_vector;
+		for (size_t i = 0; i < NUM_JOYSTICK_BUTTONS; i++)
+			joystick_msg->buttons[i] = state->joystick_button_states[i];
 
 		joystick_pub.publish (joystick_msg);
 
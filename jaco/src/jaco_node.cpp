@@ -24,15 +24,59 @@
  */
 
 #include <jaco/jaco_node.h>
+#include <jaco/jaco_params.h>
 #define DTR 0.0174532925
 
 namespace kinova
 {
+	namespace
+	{
+		// one entry of workspace/fences, see config/workspace.yaml
+		bool readFence(XmlRpc::XmlRpcValue& entry, JacoWorkspaceFence& fence)
+		{
+			if (entry.getType() != XmlRpc::XmlRpcValue::TypeStruct || !entry.hasMember("type")
+			    || entry["type"].getType() != XmlRpc::XmlRpcValue::TypeString)
+			{
+				ROS_ERROR("workspace/fences entries need a type");
+				return false;
+			}
+
+			if (entry.hasMember("name") && entry["name"].getType() == XmlRpc::XmlRpcValue::TypeString)
+				fence.name = (std::string&)entry["name"];
+			if (entry.hasMember("keep_out") && entry["keep_out"].getType() == XmlRpc::XmlRpcValue::TypeBoolean)
+				fence.keep_out = (bool&)entry["keep_out"];
+
+			const std::string& type = entry["type"];
+			std::string name = "workspace/fences/" + fence.name;
+			if (type == "box")
+			{
+				fence.type = JacoWorkspaceFence::BOX;
+				return entry.hasMember("lower") && entry.hasMember("upper")
+				       && toList(entry["lower"], name + "/lower", fence.lower, 3) && toList(entry["upper"], name + "/upper", fence.upper, 3);
+			}
+			if (type == "plane")
+			{
+				fence.type = JacoWorkspaceFence::PLANE;
+				return entry.hasMember("point") && entry.hasMember("normal")
+				       && toList(entry["point"], name + "/point", fence.point, 3) && toList(entry["normal"], name + "/normal", fence.normal, 3);
+			}
+			if (type == "cylinder")
+			{
+				fence.type = JacoWorkspaceFence::CYLINDER;
+				return entry.hasMember("point") && entry.hasMember("radius") && entry.hasMember("height")
+				       && toList(entry["point"], name + "/point", fence.point, 3)
+				       && toNumber(entry["radius"], fence.radius) && toNumber(entry["height"], fence.height);
+			}
+
+			ROS_ERROR("%s: unknown type %s, use box, plane or cylinder", name.c_str(), type.c_str());
+			return false;
+		}
+	}
 	
-	JacoNode::JacoNode(char *CSharpDLL_path)
+	JacoNode::JacoNode(const char *CSharpDLL_path, ros::NodeHandle nh, ros::NodeHandle pn) : nh_(nh), pn_(pn), configured(true), watchdog_running(false)
 	{
 		
-		ros::NodeHandle pn("~");
+		pn_.param("loop_rate", loop_rate, 100.0);
 		
 		jaco.reset(new Jaco(CSharpDLL_path, "C6H12O6h2so4")); 
 
@@ -48,58 +92,219 @@ namespace kinova
                 }
                 else
                         std::cout<< "Error : Jaconode intialising failed"<<std::endl;
+
+                // opt-in state broadcast for local processes, see state_shm.h
+                bool shared_memory;
+                pn_.param("shared_memory/enable", shared_memory, false);
+                if(shared_memory)
+                {
+                        std::string shm_name;
+                        int shm_capacity;
+                        pn_.param("shared_memory/name", shm_name, std::string(STATE_SHM_DEFAULT_NAME));
+                        pn_.param("shared_memory/capacity", shm_capacity, (int)STATE_SHM_DEFAULT_CAPACITY);
+
+                        if(shm_capacity <= 0 || !jaco->enableStateSharedMemory(shm_name, shm_capacity))
+                                std::cout<< "Error : could not enable the shared memory state broadcast"<<std::endl;
+                }
+
+                // samples the joint velocities are fitted to, see jaco_state_estimator.h
+                int velocity_window;
+                pn_.param("velocity_window", velocity_window, 7);
+                if(velocity_window < 0 || !jaco->setVelocityEstimationWindow(velocity_window))
+                        std::cout<< "Error : velocity_window must be 3 .. " << JacoStateEstimator::MAX_WINDOW << ", using 7"<<std::endl;
+
+                // joint trajectory points uploaded to the FIFO of the arm at once, see jaco_trajectory_feeder.h
+                int trajectory_chunk;
+                pn_.param("trajectory/stream_chunk", trajectory_chunk, 20);
+                if(trajectory_chunk < 0)
+                        std::cout<< "Error : trajectory/stream_chunk must not be negative, using 20"<<std::endl;
+                else
+                        jaco->setTrajectoryChunkSize(trajectory_chunk);
+
+                // where cartesian motions slow down, see jaco_singularity.h
+                JacoSingularityLimits singularity_limits;
+                pn_.param("singularity/manipulability_slow", singularity_limits.manipulability_slow, singularity_limits.manipulability_slow);
+                pn_.param("singularity/manipulability_stop", singularity_limits.manipulability_stop, singularity_limits.manipulability_stop);
+                pn_.param("singularity/distance_slow", singularity_limits.distance_slow, singularity_limits.distance_slow);
+                pn_.param("singularity/theta_distance_slow", singularity_limits.theta_distance_slow, singularity_limits.theta_distance_slow);
+                pn_.param("singularity/min_speed_scale", singularity_limits.min_speed_scale, singularity_limits.min_speed_scale);
+                jaco->setSingularityLimits(singularity_limits);
+
+                // how close the links may come, see jaco_self_collision_guard.h
+                JacoSelfCollisionLimits self_collision_limits;
+                pn_.param("self_collision/enable", self_collision_limits.enabled, self_collision_limits.enabled);
+                pn_.param("self_collision/margin", self_collision_limits.margin, self_collision_limits.margin);
+                pn_.param("self_collision/stop_margin", self_collision_limits.stop_margin, self_collision_limits.stop_margin);
+                pn_.param("self_collision/velocity_lookahead", self_collision_limits.velocity_lookahead, self_collision_limits.velocity_lookahead);
+                jaco->setSelfCollisionLimits(self_collision_limits);
+
+                // fences around the hand, see jaco_workspace.h and config/workspace.yaml
+                JacoWorkspace workspace;
+                JacoWorkspaceLimits workspace_limits;
+                std::string workspace_action;
+                pn_.param("workspace/action", workspace_action, std::string("reject"));
+                if(workspace_action == "clamp")
+                        workspace_limits.action = WORKSPACE_CLAMP;
+                else if(workspace_action == "slow")
+                        workspace_limits.action = WORKSPACE_SLOW;
+                else if(workspace_action != "reject")
+                        std::cout<< "Error : workspace/action must be reject, clamp or slow, using reject"<<std::endl;
+                pn_.param("workspace/padding", workspace_limits.padding, workspace_limits.padding);
+                pn_.param("workspace/slow_distance", workspace_limits.slow_distance, workspace_limits.slow_distance);
+                pn_.param("workspace/velocity_lookahead", workspace_limits.velocity_lookahead, workspace_limits.velocity_lookahead);
+                pn_.param("workspace/direction_lookahead", workspace_limits.direction_lookahead, workspace_limits.direction_lookahead);
+                // weaker fences than configured are not safe, the node refuses to run instead
+                XmlRpc::XmlRpcValue api_origin, fences;
+                if(pn_.getParam("workspace/api_origin", api_origin) && !toList(api_origin, "workspace/api_origin", workspace_limits.api_origin, 4))
+                        configured = false;
+                workspace.setLimits(workspace_limits);
+
+                if(pn_.getParam("workspace/fences", fences))
+                {
+                        if(fences.getType() != XmlRpc::XmlRpcValue::TypeArray)
+                        {
+                                ROS_ERROR("workspace/fences needs a list of fences");
+                                configured = false;
+                        }
+                        else
+                                for(int i = 0; i < fences.size(); i++)
+                                {
+                                        JacoWorkspaceFence fence;
+                                        if(readFence(fences[i], fence))
+                                                workspace.addFence(fence);
+                                        else
+                                        {
+                                                ROS_ERROR("workspace fence %d is malformed", i);
+                                                configured = false;
+                                        }
+                                }
+                }
+                if(!configured)
+                        ROS_ERROR("The workspace configuration does not parse, the node does not start");
+                jaco->setWorkspace(workspace);
+                if(workspace.size() > 0)
+                        ROS_INFO("Workspace of the hand limited by %lu fences", (unsigned long)workspace.size());
+
+                // joint model of the arm, see jaco_calibration.h and config/calibration.yaml
+                JacoCalibration calibration;
+                double offsets[NUM_JOINTS], signs[NUM_JOINTS];
+                for(size_t i = 0; i < NUM_JOINTS; i++)
+                {
+                        offsets[i] = calibration.getOffsets()[i];
+                        signs[i] = calibration.getSigns()[i];
+                }
+                bool has_offsets = readList(pn_, "calibration/offsets", offsets, NUM_JOINTS);
+                bool has_signs = readList(pn_, "calibration/signs", signs, NUM_JOINTS);
+                if(has_offsets || has_signs)
+                {
+                        if(calibration.set(offsets, signs))
+                                jaco->setJointCalibration(calibration);
+                        else
+                                std::cout<< "Error : calibration/signs must be 1 or -1, using the default calibration"<<std::endl;
+                }
 		
 	}
 	
 
 	JacoNode::~JacoNode()
 	{
+                if(watchdog_thread)
+                {
+                        {
+                                boost::mutex::scoped_lock lock(watchdog_mutex);
+                                watchdog_running = false;
+                        }
+                        watchdog_thread->join();
+                }
+
+                // the controllers use the arm, so they go first
+                jacoTwistServo.reset();
+                gripper_controller.reset();
+                jacoActionController.reset();
+                jacoWrenchPublisher.reset();
+                jacoSingularityPublisher.reset();
+                jacoPosePublisher.reset();
+                jacoJoystickPublisher.reset();
+                jacoJointPublisher.reset();
+
                 if(apistate)
                 {
                         //jaco->restoreFactorySetting();
                         jaco->stopApiCtrl();
                 }
 	}	
+
+	void JacoNode::start()
+	{
+		jacoJointPublisher.reset(new JacoJointPublisher(jaco, nh_));
+		jacoJoystickPublisher.reset(new JacoJoystickPublisher(jaco, nh_));
+		jacoPosePublisher.reset(new JacoPosePublisher(jaco, pn_));
+		jacoSingularityPublisher.reset(new JacoSingularityPublisher(jaco, nh_));
+		jacoWrenchPublisher.reset(new JacoWrenchPublisher(jaco, nh_, pn_));
+
+		ros::NodeHandle wn(pn_);
+		wn.setCallbackQueue(&watchdog_queue);
+		jacoActionController.reset(new JacoActionController(jaco, nh_, pn_, wn));
+		gripper_controller.reset(new GripperAction(jaco, nh_, pn_, wn));
+		jacoTwistServo.reset(new JacoTwistServo(jaco, nh_, pn_, jacoActionController));
+
+		{
+			boost::mutex::scoped_lock lock(watchdog_mutex);
+			watchdog_running = true;
+		}
+		watchdog_thread.reset(new boost::thread(boost::bind(&JacoNode::watchdogLoop, this)));
+	}
+
+	void JacoNode::watchdogLoop()
+	{
+		jaco->attachThread();
+
+		// waits for the timers instead of polling, the timeout only bounds the reaction to the shutdown
+		while (isWatchdogRunning() && ros::ok())
+			watchdog_queue.callAvailable(ros::WallDuration(0.1));
+
+		jaco->detachThread();
+	}
+
+	bool JacoNode::isWatchdogRunning()
+	{
+		boost::mutex::scoped_lock lock(watchdog_mutex);
+		return watchdog_running;
+	}
+
+	void JacoNode::update()
+	{
+		jaco -> readJacoStatus();
+
+		jacoJointPublisher->update();
+		jacoJoystickPublisher->update();
+		jacoPosePublisher->update();
+		jacoSingularityPublisher->update();
+		jacoWrenchPublisher->update();
+		// a servo preempted by an arm goal stops before the goal sends its first command
+		jacoTwistServo->update();
+		jacoActionController->update();
+		gripper_controller->update();
+	}
+
+	double JacoNode::getLoopRate() const
+	{
+		return loop_rate;
+	}
 	
 	int JacoNode::loop()
 	{
-                ros::Rate loop_rate(100);
-		JacoJointPublisher jacoJointPublisher(jaco);
-		JacoJoystickPublisher jacoJoystickPublisher(jaco);
-		JacoActionController jacoActionController(jaco);
-		GripperAction gripper_controller(jaco);
+                ros::Rate rate(loop_rate);
+
+		start();
                 		
 		while (ros::ok())
 	  	{
-			jaco -> readJacoStatus();
-
-			jacoJointPublisher.update();
-			jacoJoystickPublisher.update();
-			jacoActionController.update();
-            gripper_controller.update();
+			update();
 					
 			ros::spinOnce();
-	    		loop_rate.sleep();
+	    		rate.sleep();
 	  	}
 	  	return 0;
 	}
 }
-
-
-int main(int argc, char** argv)
-{
-	ros::init(argc, argv, "jaco");
-
-	if (argc == 2)
-	{
-		kinova::JacoNode jaco_node(argv[1]);	
-	        
-                if(jaco_node.apistate)
-                        jaco_node.loop();
-		
-	}
-	else
-		std::cout<< "Error : Jaconode need C# dll path as a argument"<<std::endl;
-
-  	return 0;
-}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_node_main.cpp
+ *
+ *  PURPOSE ---  Standalone jaco executable, see jaco_nodelet.cpp for the nodelet version
+ */
+
+#include <jaco/jaco_node.h>
+
+int main(int argc, char** argv)
+{
+	ros::init(argc, argv, "jaco");
+
+	if (argc == 2)
+	{
+		kinova::JacoNode jaco_node(argv[1]);	
+	        
+                if(jaco_node.apistate && jaco_node.configured)
+                        jaco_node.loop();
+		
+	}
+	else
+		std::cout<< "Error : Jaconode need C# dll path as a argument"<<std::endl;
+
+  	return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_nodelet.cpp
+ *
+ *  PURPOSE ---  Runs the JacoNode inside a nodelet manager
+ */
+
+#include <jaco/jaco_nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+namespace kinova
+{
+	JacoNodelet::JacoNodelet() : running(false)
+	{
+	}
+
+	JacoNodelet::~JacoNodelet()
+	{
+		running = false;
+
+		if (worker)
+			worker->join();
+	}
+
+	void JacoNodelet::onInit()
+	{
+		// there are no command line arguments for a nodelet, the C# dll path is a parameter
+		if (!getPrivateNodeHandle().getParam("dll_path", dll_path))
+		{
+			NODELET_ERROR("Jaco nodelet needs the C# dll path in the parameter ~dll_path");
+			return;
+		}
+
+		// onInit must not block, the mono runtime is created and used by the worker thread only
+		running = true;
+		worker.reset(new boost::thread(boost::bind(&JacoNodelet::run, this)));
+	}
+
+	void JacoNodelet::run()
+	{
+		ros::NodeHandle nh(getNodeHandle());
+		ros::NodeHandle pn(getPrivateNodeHandle());
+		nh.setCallbackQueue(&queue);
+		pn.setCallbackQueue(&queue);
+
+		JacoNode jaco_node(dll_path.c_str(), nh, pn);
+
+		if (!jaco_node.apistate)
+		{
+			NODELET_ERROR("Jaco nodelet: initialising the arm failed");
+			return;
+		}
+		if (!jaco_node.configured)
+		{
+			NODELET_ERROR("Jaco nodelet: the workspace configuration does not parse");
+			return;
+		}
+
+		jaco_node.start();
+
+		ros::Rate rate(jaco_node.getLoopRate());
+
+		while (running && ros::ok())
+		{
+			jaco_node.update();
+
+			queue.callAvailable();
+			rate.sleep();
+		}
+	}
+}
+
+PLUGINLIB_EXPORT_CLASS(kinova::JacoNodelet, nodelet::Nodelet)
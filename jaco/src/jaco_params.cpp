@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_params.cpp
+ *
+ *  PURPOSE ---  Lists of numbers read from the parameter server, shared by the node and its publishers
+ */
+
+
+#include <jaco/jaco_params.h>
+
+#include <vector>
+#include <algorithm>
+
+namespace kinova
+{
+	bool toNumber(XmlRpc::XmlRpcValue& value, double& number)
+	{
+		if (value.getType() == XmlRpc::XmlRpcValue::TypeInt)
+			number = (int)value;
+		else if (value.getType() == XmlRpc::XmlRpcValue::TypeDouble)
+			number = (double)value;
+		else
+			return false;
+		return true;
+	}
+
+	bool toList(XmlRpc::XmlRpcValue& list, const std::string& name, double values[], size_t count)
+	{
+		if (list.getType() != XmlRpc::XmlRpcValue::TypeArray || list.size() != (int)count)
+		{
+			ROS_ERROR("%s needs %lu values", name.c_str(), (unsigned long)count);
+			return false;
+		}
+
+		std::vector<double> numbers(count);
+		for (int i = 0; i < list.size(); i++)
+			if (!toNumber(list[i], numbers[i]))
+			{
+				ROS_ERROR("%s needs numbers", name.c_str());
+				return false;
+			}
+		std::copy(numbers.begin(), numbers.end(), values);
+		return true;
+	}
+
+	bool readList(const ros::NodeHandle& pn, const std::string& name, double values[], size_t count)
+	{
+		XmlRpc::XmlRpcValue list;
+		if (!pn.getParam(name, list))
+			return false;
+
+		return toList(list, name, values, count);
+	}
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_pose_publisher.cpp
+ *
+ *  PURPOSE ---  Broadcast the pose of the hand computed from the joint angles as tf transform
+ */
+
+#include <jaco/jaco_pose_publisher.h>
+#include <jaco_kinematics/jaco_kinematics.h>
+
+namespace kinova
+{
+        JacoPosePublisher::JacoPosePublisher(boost::shared_ptr<AbstractJaco> jaco, ros::NodeHandle pn) : jaco(jaco), last_sequence(0)
+        {
+                pn.param("fk_frame_id", frame_id, std::string("jaco_base_link"));
+                pn.param("fk_child_frame_id", child_frame_id, std::string("jaco_fk_tool_frame"));
+        }
+
+        JacoPosePublisher::~JacoPosePublisher()
+        {
+        }
+
+	void JacoPosePublisher::update()
+	{
+		JacoStateSnapshotConstPtr state = jaco -> getStateSnapshot();
+
+		if (state->sequence == last_sequence)
+			return;
+		last_sequence = state->sequence;
+
+		JacoFrame tool;
+		double quaternion[4];
+		JacoKinematics::fromPose(state->pose.data(), tool);
+		JacoKinematics::toQuaternion(tool, quaternion);
+
+		tf::Transform transform(tf::Quaternion(quaternion[0], quaternion[1], quaternion[2], quaternion[3]),
+					tf::Vector3(tool.p[0], tool.p[1], tool.p[2]));
+
+		// stamped with the time the joint angles were read from the arm
+		broadcaster.sendTransform(tf::StampedTransform(transform, state->stamp, frame_id, child_frame_id));
+	}
+}
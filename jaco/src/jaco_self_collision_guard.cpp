@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_self_collision_guard.cpp
+ *
+ *  PURPOSE ---  Rejects joint commands and stops the arm before its links collide, see JacoSelfCollision
+ */
+
+#include <jaco/jaco_self_collision_guard.h>
+#include <jaco_kinematics/jaco_self_collision.h>
+
+#include <algorithm>
+
+namespace kinova
+{
+	// the capsules enclose the meshes already, the margin covers the tracking error of the arm
+	JacoSelfCollisionLimits::JacoSelfCollisionLimits() :
+		enabled(true),
+		margin(0.01),
+		stop_margin(0.005),
+		velocity_lookahead(0.2)
+	{
+	}
+
+	JacoSelfCollisionGuard::JacoSelfCollisionGuard() : clearance_(0.0), closest_pair_(0), stopped_(false)
+	{
+	}
+
+	void JacoSelfCollisionGuard::setLimits(const JacoSelfCollisionLimits& limits)
+	{
+		limits_ = limits;
+	}
+
+	const JacoSelfCollisionLimits& JacoSelfCollisionGuard::getLimits() const
+	{
+		return limits_;
+	}
+
+	bool JacoSelfCollisionGuard::pathClear(const double start[NUM_JOINTS], const double *waypoints, size_t count) const
+	{
+		if (!limits_.enabled)
+			return true;
+
+		const double *from = start;
+		for (size_t i = 0; i < count; i++)
+		{
+			const double *to = waypoints + i * NUM_JOINTS;
+			double margin = std::min(limits_.margin, JacoSelfCollision::clearance(from));
+			if (!JacoSelfCollision::motionClear(from, to, margin))
+				return false;
+			from = to;
+		}
+		return true;
+	}
+
+	bool JacoSelfCollisionGuard::velocityClear(const double start[NUM_JOINTS], const double velocities[NUM_JOINTS]) const
+	{
+		double target[NUM_JOINTS];
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			target[i] = start[i] + velocities[i] * limits_.velocity_lookahead;
+
+		return pathClear(start, target, 1);
+	}
+
+	bool JacoSelfCollisionGuard::update(const double q[NUM_JOINTS])
+	{
+		clearance_ = JacoSelfCollision::clearance(q, &closest_pair_);
+
+		if (!limits_.enabled || clearance_ >= limits_.stop_margin)
+		{
+			stopped_ = false;
+			return false;
+		}
+
+		// once, so the arm can still be moved out with commands that increase the clearance
+		bool stop = !stopped_;
+		stopped_ = true;
+		return stop;
+	}
+
+	double JacoSelfCollisionGuard::getClearance() const
+	{
+		return clearance_;
+	}
+
+	void JacoSelfCollisionGuard::getClosestLinks(const char *&first, const char *&second) const
+	{
+		size_t i, j;
+		JacoSelfCollision::pair(closest_pair_, i, j);
+		first = JacoSelfCollision::capsule(i).link;
+		second = JacoSelfCollision::capsule(j).link;
+	}
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_singularity.cpp
+ *
+ *  PURPOSE ---  How close the arm is to a singular configuration, and how much cartesian motions are slowed down there
+ */
+
+#include <jaco/jaco_singularity.h>
+#include <algorithm>
+
+namespace kinova
+{
+	namespace
+	{
+		// 1 at or above slow, 0 at or below stop, linear in between
+		double ramp(double value, double stop, double slow)
+		{
+			if (value >= slow)
+				return 1.0;
+			if (value <= stop)
+				return 0.0;
+			return (value - stop) / (slow - stop);
+		}
+	}
+
+	// |det J| is below 0.004 m^3 in about a fifth of the workspace, the wrist singularity (q5 = 0)
+	// and the stretched elbow (q3 = pi/2) fall to about 0.001 m^3
+	JacoSingularityLimits::JacoSingularityLimits() :
+		manipulability_slow(0.004),
+		manipulability_stop(0.0005),
+		distance_slow(0.05),
+		theta_distance_slow(0.2),
+		min_speed_scale(0.1)
+	{
+	}
+
+	double JacoSingularityLimits::speedScale(const JacoSingularityState& state) const
+	{
+		double scale = ramp(state.manipulability, manipulability_stop, manipulability_slow);
+
+		// the distances of the arm only mean something while it reports a singularity
+		if (distance_slow > 0.0 && state.singularity_count > 0)
+			scale = std::min(scale, ramp(state.singularity_distance, 0.0, distance_slow));
+		if (theta_distance_slow > 0.0 && state.singularity_theta_count > 0)
+			scale = std::min(scale, ramp(state.singularity_theta_distance, 0.0, theta_distance_slow));
+
+		return min_speed_scale + (1.0 - min_speed_scale) * scale;
+	}
+}
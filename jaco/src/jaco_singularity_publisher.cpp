@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_singularity_publisher.cpp
+ *
+ *  PURPOSE ---  Publishes the singularity proximity of every sample on jaco_singularity
+ */
+
+#include <jaco/jaco_singularity_publisher.h>
+
+namespace kinova
+{
+        // messages allocated up front / maximum the pool grows to while intra-process subscribers hold them
+        const size_t SINGULARITY_POOL_SIZE = 4;
+        const size_t SINGULARITY_POOL_MAX_SIZE = 32;
+
+        JacoSingularityPublisher::JacoSingularityPublisher(boost::shared_ptr<AbstractJaco> jaco, ros::NodeHandle nh) : jaco(jaco), last_sequence(0)
+        {
+                singularity_pub = nh.advertise<jaco::JacoSingularity>("jaco_singularity", 100);
+
+                jaco::JacoSingularity prototype;
+                prototype.header.frame_id = "jaco_base_link";
+                singularity_pool.reset(new MessagePool<jaco::JacoSingularity>(prototype, SINGULARITY_POOL_SIZE, SINGULARITY_POOL_MAX_SIZE));
+        }
+
+        JacoSingularityPublisher::~JacoSingularityPublisher()
+        {
+        }
+
+	void JacoSingularityPublisher::update()
+	{
+		JacoStateSnapshotConstPtr state = jaco -> getStateSnapshot();
+
+		if (state->sequence == last_sequence)
+			return;
+		last_sequence = state->sequence;
+
+		jaco::JacoSingularityPtr msg = singularity_pool->acquire();
+		const JacoSingularityState& singularity = state->singularity;
+
+		msg->header.stamp = state->stamp;
+		msg->manipulability = singularity.manipulability;
+		msg->translational_manipulability = singularity.translational_manipulability;
+		msg->rotational_manipulability = singularity.rotational_manipulability;
+		msg->singularity_count = singularity.singularity_count;
+		msg->singularity_theta_count = singularity.singularity_theta_count;
+		msg->singularity_distance = singularity.singularity_distance;
+		msg->singularity_theta_distance = singularity.singularity_theta_distance;
+		for (size_t i = 0; i < POSE_SIZE; i++)
+			msg->repulsion[i] = singularity.repulsion[i];
+		msg->speed_scale = singularity.speed_scale;
+
+		singularity_pub.publish(msg);
+	}
+}
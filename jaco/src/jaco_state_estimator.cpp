@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_state_estimator.cpp
+ *
+ *  PURPOSE ---  Velocities and accelerations of the joints and fingers from the sampled positions
+ */
+
+#include <jaco/jaco_state_estimator.h>
+
+#include <math.h>
+#include <algorithm>
+
+namespace kinova
+{
+	const size_t JacoStateEstimator::NUM_CHANNELS;
+	const size_t JacoStateEstimator::MAX_WINDOW;
+
+	namespace
+	{
+		// a longer pause between two samples [s] would make a parabola through them meaningless
+		const double MAX_GAP = 0.5;
+
+		double wrap(double angle)
+		{
+			return angle - 2.0 * M_PI * floor(angle / (2.0 * M_PI) + 0.5);
+		}
+	}
+
+	JacoStateEstimator::JacoStateEstimator(size_t window) : window_(7)
+	{
+		setWindow(window);
+		reset();
+	}
+
+	bool JacoStateEstimator::setWindow(size_t window)
+	{
+		if (window < 3 || window > MAX_WINDOW)
+			return false;
+
+		window_ = window;
+		reset();
+		return true;
+	}
+
+	size_t JacoStateEstimator::getWindow() const
+	{
+		return window_;
+	}
+
+	void JacoStateEstimator::reset()
+	{
+		count_ = 0;
+		newest_ = 0;
+		std::fill(velocities_, velocities_ + NUM_CHANNELS, 0.0);
+		std::fill(accelerations_, accelerations_ + NUM_CHANNELS, 0.0);
+	}
+
+	void JacoStateEstimator::update(double time, const double positions[NUM_CHANNELS])
+	{
+		if (count_ > 0)
+		{
+			double gap = time - times_[newest_];
+			// the same acquisition again
+			if (gap == 0.0)
+				return;
+			if (gap < 0.0 || gap > MAX_GAP)
+				count_ = 0;
+		}
+
+		const double *previous = positions_[newest_];
+		size_t slot = (count_ == 0) ? 0 : (newest_ + 1) % window_;
+		double *sample = positions_[slot];
+
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+		{
+			sample[i] = (count_ == 0) ? positions[i] : previous[i] + wrap(positions[i] - last_raw_[i]);
+			last_raw_[i] = positions[i];
+		}
+		for (size_t i = NUM_JOINTS; i < NUM_CHANNELS; i++)
+			sample[i] = positions[i];
+
+		times_[slot] = time;
+		newest_ = slot;
+		count_ = std::min(count_ + 1, window_);
+
+		if (count_ == 1)
+		{
+			std::fill(velocities_, velocities_ + NUM_CHANNELS, 0.0);
+			std::fill(accelerations_, accelerations_ + NUM_CHANNELS, 0.0);
+			return;
+		}
+
+		if (count_ == 2)
+		{
+			size_t other = (slot + window_ - 1) % window_;
+			double dt = times_[slot] - times_[other];
+			for (size_t c = 0; c < NUM_CHANNELS; c++)
+			{
+				velocities_[c] = (positions_[slot][c] - positions_[other][c]) / dt;
+				accelerations_[c] = 0.0;
+			}
+			return;
+		}
+
+		// times relative to the newest sample, scaled by the span of the window to keep the fit well conditioned
+		double span = 0.0;
+		for (size_t k = 0; k < count_; k++)
+			span = std::max(span, time - times_[k]);
+
+		double tau[MAX_WINDOW], S[5] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+		for (size_t k = 0; k < count_; k++)
+		{
+			tau[k] = (times_[k] - time) / span;
+			double power = 1.0;
+			for (int e = 0; e < 5; e++)
+			{
+				S[e] += power;
+				power *= tau[k];
+			}
+		}
+
+		// rows 1 and 2 of the inverse of the normal matrix [S0 S1 S2; S1 S2 S3; S2 S3 S4]
+		double c00 = S[2]*S[4] - S[3]*S[3], c01 = S[2]*S[3] - S[1]*S[4], c02 = S[1]*S[3] - S[2]*S[2];
+		double c11 = S[0]*S[4] - S[2]*S[2], c12 = S[1]*S[2] - S[0]*S[3], c22 = S[0]*S[2] - S[1]*S[1];
+		double determinant = S[0]*c00 + S[1]*c01 + S[2]*c02;
+		if (fabs(determinant) < 1e-12)
+			return;
+
+		double w1[MAX_WINDOW], w2[MAX_WINDOW];
+		for (size_t k = 0; k < count_; k++)
+		{
+			w1[k] = (c01 + c11 * tau[k] + c12 * tau[k] * tau[k]) / (determinant * span);
+			w2[k] = 2.0 * (c02 + c12 * tau[k] + c22 * tau[k] * tau[k]) / (determinant * span * span);
+		}
+
+		for (size_t c = 0; c < NUM_CHANNELS; c++)
+		{
+			double velocity = 0.0, acceleration = 0.0;
+			for (size_t k = 0; k < count_; k++)
+			{
+				velocity += w1[k] * positions_[k][c];
+				acceleration += w2[k] * positions_[k][c];
+			}
+			velocities_[c] = velocity;
+			accelerations_[c] = acceleration;
+		}
+	}
+}
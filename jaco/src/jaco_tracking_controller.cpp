@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_tracking_controller.cpp
+ *
+ *  PURPOSE ---  Joint velocities following a reference: velocity feedforward and PID on the joint error
+ */
+
+#include <jaco/jaco_tracking_controller.h>
+
+#include <math.h>
+#include <algorithm>
+
+namespace kinova
+{
+	namespace
+	{
+		// a longer cycle [s] means the loop stalled, its error must not be integrated at once
+		const double MAX_DT = 0.1;
+	}
+
+	JacoTrackingGains::JacoTrackingGains() :
+		p(4.0), i(1.0), d(0.0), i_clamp(0.1)
+	{
+	}
+
+	JacoTrackingController::JacoTrackingController() :
+		max_velocity_(0.0)
+	{
+		reset();
+	}
+
+	void JacoTrackingController::setGains(size_t joint, const JacoTrackingGains& gains)
+	{
+		gains_[joint] = gains;
+	}
+
+	const JacoTrackingGains& JacoTrackingController::getGains(size_t joint) const
+	{
+		return gains_[joint];
+	}
+
+	void JacoTrackingController::setMaxVelocity(double max_velocity)
+	{
+		max_velocity_ = max_velocity;
+	}
+
+	void JacoTrackingController::reset()
+	{
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+			integral_[j] = 0.0;
+	}
+
+	void JacoTrackingController::update(double dt, const double desired[NUM_JOINTS], const double desired_velocities[NUM_JOINTS],
+					    const double actual[NUM_JOINTS], const double actual_velocities[NUM_JOINTS], double command[NUM_JOINTS])
+	{
+		dt = std::max(0.0, std::min(dt, MAX_DT));
+
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+		{
+			const JacoTrackingGains& g = gains_[j];
+			double error = jointAngleDifference(j, desired[j], actual[j]);
+			double velocity_error = desired_velocities[j] - actual_velocities[j];
+
+			// the integral as it would be, kept only if the command does not saturate further with it
+			double integral = integral_[j] + error * dt;
+			if (g.i > 0.0 && g.i_clamp >= 0.0)
+				integral = std::max(-g.i_clamp / g.i, std::min(integral, g.i_clamp / g.i));
+
+			double unclamped = desired_velocities[j] + g.p * error + g.i * integral + g.d * velocity_error;
+			command[j] = unclamped;
+			if (max_velocity_ > 0.0)
+				command[j] = std::max(-max_velocity_, std::min(unclamped, max_velocity_));
+
+			if (command[j] == unclamped || error * unclamped < 0.0)
+				integral_[j] = integral;
+			else
+				command[j] = std::max(-max_velocity_, std::min(desired_velocities[j] + g.p * error + g.i * integral_[j] + g.d * velocity_error, max_velocity_));
+		}
+	}
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_trajectory_constraints.cpp
+ *
+ *  PURPOSE ---  Path, goal and goal time tolerances a joint trajectory is monitored with every cycle
+ */
+
+#include <jaco/jaco_trajectory_constraints.h>
+
+#include <math.h>
+
+namespace kinova
+{
+	JacoTrajectoryConstraints::JacoTrajectoryConstraints() :
+		goal_time(0.0)
+	{
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+		{
+			path[j] = -1.0;
+			goal[j] = 0.01;
+			goal_velocity[j] = 0.01;
+		}
+	}
+
+	int JacoTrajectoryConstraints::pathViolation(const double error[NUM_JOINTS]) const
+	{
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+			if (path[j] > 0.0 && fabs(error[j]) > path[j])
+				return j;
+		return -1;
+	}
+
+	int JacoTrajectoryConstraints::goalViolation(const double error[NUM_JOINTS], const double velocities[NUM_JOINTS]) const
+	{
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+			if ((goal[j] > 0.0 && fabs(error[j]) > goal[j]) || (goal_velocity[j] > 0.0 && fabs(velocities[j]) > goal_velocity[j]))
+				return j;
+		return -1;
+	}
+
+	void JacoTrajectoryConstraints::pathTolerances(double tolerances[NUM_JOINTS]) const
+	{
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+			tolerances[j] = path[j] > 0.0 ? path[j] : HUGE_VAL;
+	}
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_trajectory_feeder.cpp
+ *
+ *  PURPOSE ---  Host side buffer streaming joint trajectories into the trajectory FIFO of the arm
+ */
+
+#include <jaco/jaco_trajectory_feeder.h>
+#include <jaco/jaco_trajectory_simplifier.h>
+
+#include <algorithm>
+
+namespace kinova
+{
+	const int JacoTrajectoryFeeder::DEFAULT_FIFO_SIZE;
+
+	namespace
+	{
+		// of point from the segment of trajectory starting at its point segment, a single point is its own segment
+		double segmentDeviation(const std::vector<double>& trajectory, size_t segment, const double *point, const double tolerances[NUM_JOINTS])
+		{
+			size_t end = std::min(segment + 1, trajectory.size() / NUM_JOINTS - 1);
+			return JacoTrajectorySimplifier::deviation(&trajectory[segment * NUM_JOINTS], &trajectory[end * NUM_JOINTS], point, tolerances);
+		}
+	}
+
+	JacoTrajectoryFeeder::JacoTrajectoryFeeder(size_t chunk) :
+		next_(0),
+		chunk_(chunk)
+	{
+	}
+
+	void JacoTrajectoryFeeder::setChunkSize(size_t chunk)
+	{
+		chunk_ = chunk;
+	}
+
+	size_t JacoTrajectoryFeeder::getChunkSize() const
+	{
+		return chunk_;
+	}
+
+	void JacoTrajectoryFeeder::load(const std::vector<double>& jointtrajectory)
+	{
+		// only whole points
+		points_.assign(jointtrajectory.begin(), jointtrajectory.begin() + (jointtrajectory.size() / NUM_JOINTS) * NUM_JOINTS);
+		next_ = 0;
+	}
+
+	void JacoTrajectoryFeeder::clear()
+	{
+		points_.clear();
+		next_ = 0;
+	}
+
+	size_t JacoTrajectoryFeeder::queued() const
+	{
+		return points_.size() / NUM_JOINTS - next_;
+	}
+
+	bool JacoTrajectoryFeeder::empty() const
+	{
+		return queued() == 0;
+	}
+
+	size_t JacoTrajectoryFeeder::take(int in_fifo, int fifo_size, const double*& points)
+	{
+		if (fifo_size <= 0)
+			fifo_size = DEFAULT_FIFO_SIZE;
+
+		size_t count = 0;
+		if (in_fifo < fifo_size)
+			count = std::min(queued(), (size_t)(fifo_size - std::max(in_fifo, 0)));
+		if (chunk_ > 0)
+			count = std::min(count, chunk_);
+
+		points = count > 0 ? &points_[next_ * NUM_JOINTS] : NULL;
+		next_ += count;
+		return count;
+	}
+
+	bool JacoTrajectoryFeeder::findSplice(const std::vector<double>& trajectory, int in_fifo, const double tolerances[NUM_JOINTS], size_t& tail) const
+	{
+		size_t count = trajectory.size() / NUM_JOINTS;
+		if (in_fifo <= 0 || (size_t)in_fifo > next_ || count == 0)
+			return false;
+
+		// every point left in the FIFO has to be on a segment of the new path, the segments in order
+		size_t segment = 0;
+		size_t last_segment = count > 1 ? count - 2 : 0;
+		for (size_t i = next_ - in_fifo; i < next_; i++)
+		{
+			const double *point = &points_[i * NUM_JOINTS];
+			double d = segmentDeviation(trajectory, segment, point, tolerances);
+			while (d > 1.0)
+			{
+				if (segment == last_segment)
+					return false;
+				d = segmentDeviation(trajectory, ++segment, point, tolerances);
+			}
+
+			// near the end of a segment the next one may fit better, the new points must not lead back
+			while (segment < last_segment && segmentDeviation(trajectory, segment + 1, point, tolerances) < d)
+				d = segmentDeviation(trajectory, ++segment, point, tolerances);
+		}
+
+		tail = std::min(segment + 1, count);
+		return true;
+	}
+
+	void JacoTrajectoryFeeder::splice(const std::vector<double>& trajectory, size_t tail)
+	{
+		points_.resize(next_ * NUM_JOINTS);
+		size_t count = trajectory.size() / NUM_JOINTS;
+		if (tail < count)
+			points_.insert(points_.end(), trajectory.begin() + tail * NUM_JOINTS, trajectory.begin() + count * NUM_JOINTS);
+	}
+
+	void JacoTrajectoryFeeder::fifoPoints(int in_fifo, std::vector<double>& points) const
+	{
+		size_t first = next_ - std::min((size_t)std::max(in_fifo, 0), next_);
+		points.assign(points_.begin() + first * NUM_JOINTS, points_.begin() + next_ * NUM_JOINTS);
+	}
+
+	bool JacoTrajectoryFeeder::lastUploaded(const double*& point) const
+	{
+		if (next_ == 0)
+			return false;
+		point = &points_[(next_ - 1) * NUM_JOINTS];
+		return true;
+	}
+}
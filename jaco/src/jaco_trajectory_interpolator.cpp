@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_trajectory_interpolator.cpp
+ *
+ *  PURPOSE ---  Joint setpoints of a timed trajectory at any time between its points
+ */
+
+#include <jaco/jaco_trajectory_interpolator.h>
+
+#include <algorithm>
+
+namespace kinova
+{
+	namespace
+	{
+		const size_t NUM_COEFFICIENTS = 6;
+
+		// velocity at an inner point from its neighbours, zero where the joint turns around
+		double pointVelocity(double p_prev, double p, double p_next, double dt_prev, double dt_next)
+		{
+			double before = (p - p_prev) / dt_prev;
+			double after = (p_next - p) / dt_next;
+			if (before * after <= 0.0)
+				return 0.0;
+			return 0.5 * (before + after);
+		}
+	}
+
+	JacoTrajectoryInterpolator::JacoTrajectoryInterpolator() :
+		cursor_(0)
+	{
+	}
+
+	bool JacoTrajectoryInterpolator::setTrajectory(const std::vector<double>& times, const std::vector<double>& positions,
+						       const std::vector<double>& velocities, const std::vector<double>& accelerations)
+	{
+		size_t count = times.size();
+		if (count == 0 || positions.size() != count * NUM_JOINTS)
+			return false;
+		if (!velocities.empty() && velocities.size() != count * NUM_JOINTS)
+			return false;
+		if (!accelerations.empty() && (velocities.empty() || accelerations.size() != count * NUM_JOINTS))
+			return false;
+		for (size_t k = 1; k < count; k++)
+			if (!(times[k] > times[k - 1]))
+				return false;
+
+		// the velocities are needed for every point, the trajectory starts and ends at rest
+		std::vector<double> v(count * NUM_JOINTS, 0.0);
+		if (!velocities.empty())
+			v = velocities;
+		else
+			for (size_t k = 1; k + 1 < count; k++)
+				for (size_t j = 0; j < NUM_JOINTS; j++)
+					v[k*NUM_JOINTS + j] = pointVelocity(positions[(k-1)*NUM_JOINTS + j], positions[k*NUM_JOINTS + j], positions[(k+1)*NUM_JOINTS + j],
+									   times[k] - times[k - 1], times[k + 1] - times[k]);
+
+		times_ = times;
+		cursor_ = 0;
+		coefficients_.assign((count - 1) * NUM_JOINTS * NUM_COEFFICIENTS, 0.0);
+		for (size_t k = 0; k + 1 < count; k++)
+		{
+			double T = times[k + 1] - times[k];
+			for (size_t j = 0; j < NUM_JOINTS; j++)
+			{
+				double p0 = positions[k*NUM_JOINTS + j], p1 = positions[(k+1)*NUM_JOINTS + j];
+				double v0 = v[k*NUM_JOINTS + j], v1 = v[(k+1)*NUM_JOINTS + j];
+				double *a = &coefficients_[(k*NUM_JOINTS + j) * NUM_COEFFICIENTS];
+
+				a[0] = p0;
+				a[1] = v0;
+				if (!accelerations.empty())
+				{
+					double acc0 = accelerations[k*NUM_JOINTS + j], acc1 = accelerations[(k+1)*NUM_JOINTS + j];
+					a[2] = 0.5 * acc0;
+					a[3] = (20.0*(p1 - p0) - (8.0*v1 + 12.0*v0)*T - (3.0*acc0 - acc1)*T*T) / (2.0*T*T*T);
+					a[4] = (30.0*(p0 - p1) + (14.0*v1 + 16.0*v0)*T + (3.0*acc0 - 2.0*acc1)*T*T) / (2.0*T*T*T*T);
+					a[5] = (12.0*(p1 - p0) - 6.0*(v1 + v0)*T - (acc0 - acc1)*T*T) / (2.0*T*T*T*T*T);
+				}
+				else
+				{
+					a[2] = (3.0*(p1 - p0) - (2.0*v0 + v1)*T) / (T*T);
+					a[3] = (2.0*(p0 - p1) + (v0 + v1)*T) / (T*T*T);
+				}
+			}
+		}
+
+		// a single point is held, its position is kept as the constant of an empty segment
+		if (count == 1)
+		{
+			coefficients_.assign(NUM_JOINTS * NUM_COEFFICIENTS, 0.0);
+			for (size_t j = 0; j < NUM_JOINTS; j++)
+				coefficients_[j * NUM_COEFFICIENTS] = positions[j];
+		}
+		return true;
+	}
+
+	void JacoTrajectoryInterpolator::clear()
+	{
+		times_.clear();
+		coefficients_.clear();
+		cursor_ = 0;
+	}
+
+	size_t JacoTrajectoryInterpolator::size() const
+	{
+		return times_.size();
+	}
+
+	double JacoTrajectoryInterpolator::getStartTime() const
+	{
+		return times_.empty() ? 0.0 : times_.front();
+	}
+
+	double JacoTrajectoryInterpolator::getEndTime() const
+	{
+		return times_.empty() ? 0.0 : times_.back();
+	}
+
+	size_t JacoTrajectoryInterpolator::segmentEnd(double time) const
+	{
+		// the segment of the last call and the one after it are tried before searching
+		size_t count = times_.size();
+		for (size_t end = cursor_; end <= count && end <= cursor_ + 1; end++)
+			if ((end == 0 || times_[end - 1] <= time) && (end == count || time < times_[end]))
+				return cursor_ = end;
+		cursor_ = std::upper_bound(times_.begin(), times_.end(), time) - times_.begin();
+		return cursor_;
+	}
+
+	void JacoTrajectoryInterpolator::sample(double time, double positions[NUM_JOINTS], double velocities[NUM_JOINTS], double accelerations[NUM_JOINTS]) const
+	{
+		if (times_.empty())
+			return;
+
+		// before the start and after the end the trajectory rests at its first or last point
+		size_t segment;
+		double tau;
+		bool rest = false;
+		size_t end = segmentEnd(time);
+		if (times_.size() == 1 || end == 0)
+		{
+			segment = 0;
+			tau = 0.0;
+			rest = true;
+		}
+		else if (end == times_.size())
+		{
+			segment = times_.size() - 2;
+			tau = times_.back() - times_[segment];
+			rest = true;
+		}
+		else
+		{
+			segment = end - 1;
+			tau = time - times_[segment];
+		}
+
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+		{
+			const double *a = &coefficients_[(segment*NUM_JOINTS + j) * NUM_COEFFICIENTS];
+			positions[j] = a[0] + tau*(a[1] + tau*(a[2] + tau*(a[3] + tau*(a[4] + tau*a[5]))));
+			if (velocities)
+				velocities[j] = rest ? 0.0 : a[1] + tau*(2.0*a[2] + tau*(3.0*a[3] + tau*(4.0*a[4] + tau*5.0*a[5])));
+			if (accelerations)
+				accelerations[j] = rest ? 0.0 : 2.0*a[2] + tau*(6.0*a[3] + tau*(12.0*a[4] + tau*20.0*a[5]));
+		}
+	}
+}
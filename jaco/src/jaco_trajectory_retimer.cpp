@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_trajectory_retimer.cpp
+ *
+ *  PURPOSE ---  Time-optimal timing of a joint path under joint velocity and acceleration limits
+ */
+
+#include <jaco/jaco_trajectory_retimer.h>
+#include <jaco/jaco_trajectory_interpolator.h>
+
+#include <math.h>
+#include <algorithm>
+
+namespace kinova
+{
+	namespace
+	{
+		// points closer than this [rad] are the same
+		const double MIN_CHORD = 1e-6;
+		// derivatives of the path below this do not limit anything
+		const double MIN_DERIVATIVE = 1e-9;
+		// s'^2 where no joint limits it, the path is never that fast
+		const double MAX_X = 1e6;
+		// the grid gets coarser for longer paths
+		const size_t MAX_GRID = 20000;
+		const int BISECTIONS = 50;
+	}
+
+	JacoTrajectoryRetimer::JacoTrajectoryRetimer() :
+		step_(0.01)
+	{
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+		{
+			max_velocity_[j] = 0.2;
+			max_acceleration_[j] = 0.5;
+		}
+	}
+
+	void JacoTrajectoryRetimer::setLimits(size_t joint, double max_velocity, double max_acceleration)
+	{
+		max_velocity_[joint] = max_velocity;
+		max_acceleration_[joint] = max_acceleration;
+	}
+
+	void JacoTrajectoryRetimer::setResolution(double step)
+	{
+		step_ = step;
+	}
+
+	bool JacoTrajectoryRetimer::accelerationRange(const double *d, const double *dd, const double *d_next, const double *dd_next,
+							double delta, double x, double& lower, double& upper) const
+	{
+		// -a <= q' s'' + q'' s'^2 <= a for every joint, at the start of the interval and at its end
+		// with s'^2 + 2 delta s'' there (first order interpolation), so it also holds in between
+		lower = -HUGE_VAL;
+		upper = HUGE_VAL;
+		for (size_t k = 0; k < 2 * NUM_JOINTS; k++)
+		{
+			size_t j = k % NUM_JOINTS;
+			double a = max_acceleration_[j];
+			double cu = k < NUM_JOINTS ? d[j] : d_next[j] + 2.0 * delta * dd_next[j];
+			double cx = k < NUM_JOINTS ? dd[j] : dd_next[j];
+			if (fabs(cu) < MIN_DERIVATIVE)
+			{
+				if (fabs(cx) * x > a)
+					return false;
+				continue;
+			}
+			double u1 = (-a - cx * x) / cu, u2 = (a - cx * x) / cu;
+			lower = std::max(lower, std::min(u1, u2));
+			upper = std::min(upper, std::max(u1, u2));
+		}
+		return lower <= upper;
+	}
+
+	bool JacoTrajectoryRetimer::retime(const std::vector<double>& positions, std::vector<double>& retimed, std::vector<double>& times,
+					   std::vector<double>& velocities) const
+	{
+		size_t count = positions.size() / NUM_JOINTS;
+		retimed.clear();
+		times.clear();
+		velocities.clear();
+		if (count == 0)
+			return false;
+
+		// the points along the path, s by the chord length
+		std::vector<double> s;
+		for (size_t k = 0; k < count; k++)
+		{
+			const double *p = &positions[k * NUM_JOINTS];
+			double chord = 0.0;
+			if (!s.empty())
+			{
+				const double *last = &retimed[retimed.size() - NUM_JOINTS];
+				for (size_t j = 0; j < NUM_JOINTS; j++)
+					chord += (p[j] - last[j]) * (p[j] - last[j]);
+				chord = sqrt(chord);
+				if (chord < MIN_CHORD)
+					continue;
+			}
+			s.push_back(s.empty() ? 0.0 : s.back() + chord);
+			retimed.insert(retimed.end(), p, p + NUM_JOINTS);
+		}
+		count = s.size();
+		if (count == 1)
+		{
+			times.push_back(0.0);
+			velocities.assign(NUM_JOINTS, 0.0);
+			return true;
+		}
+
+		// the curve through the points, its derivatives are those of the joints along s. Its tangents are
+		// the mean of the chords around a point, zero where a joint turns around, and the chord at the ends.
+		std::vector<double> tangents(count * NUM_JOINTS, 0.0);
+		for (size_t k = 0; k < count; k++)
+			for (size_t j = 0; j < NUM_JOINTS; j++)
+			{
+				double before = k > 0 ? (retimed[k*NUM_JOINTS + j] - retimed[(k-1)*NUM_JOINTS + j]) / (s[k] - s[k - 1]) : 0.0;
+				double after = k + 1 < count ? (retimed[(k+1)*NUM_JOINTS + j] - retimed[k*NUM_JOINTS + j]) / (s[k + 1] - s[k]) : 0.0;
+				if (k == 0 || k + 1 == count)
+					tangents[k*NUM_JOINTS + j] = before + after;
+				else if (before * after > 0.0)
+					tangents[k*NUM_JOINTS + j] = 0.5 * (before + after);
+			}
+		JacoTrajectoryInterpolator path;
+		if (!path.setTrajectory(s, retimed, tangents, std::vector<double>()))
+			return false;
+
+		double step = std::max(step_, s.back() / MAX_GRID);
+		std::vector<double> grid;		// through every point
+		for (size_t k = 0; k + 1 < count; k++)
+		{
+			size_t n = std::max((size_t)1, (size_t)ceil((s[k + 1] - s[k]) / step));
+			for (size_t i = 0; i < n; i++)
+				grid.push_back(s[k] + (s[k + 1] - s[k]) * i / n);
+		}
+		grid.push_back(s.back());
+
+		size_t n = grid.size();
+		// q'' of the curve jumps at the points, the intervals ending there take it from before
+		std::vector<double> q(n * NUM_JOINTS), d(n * NUM_JOINTS), dd(n * NUM_JOINTS), dd_end(n * NUM_JOINTS), x_velocity(n, MAX_X);
+		double unused[2 * NUM_JOINTS];
+		for (size_t i = 0; i < n; i++)
+		{
+			path.sample(grid[i], &q[i * NUM_JOINTS], &d[i * NUM_JOINTS], &dd[i * NUM_JOINTS]);
+			if (i > 0)
+				path.sample(grid[i] - 1e-9 * (grid[i] - grid[i - 1]), unused, unused + NUM_JOINTS, &dd_end[i * NUM_JOINTS]);
+			for (size_t j = 0; j < NUM_JOINTS; j++)
+				if (fabs(d[i * NUM_JOINTS + j]) >= MIN_DERIVATIVE)
+					x_velocity[i] = std::min(x_velocity[i], pow(max_velocity_[j] / d[i * NUM_JOINTS + j], 2));
+		}
+
+		// backward: the largest s'^2 at each grid point from which the path can be followed to its end at rest,
+		// the smallest is always 0, the arm can stop anywhere
+		std::vector<double> x_max(n, 0.0);
+		for (size_t i = n - 1; i-- > 0; )
+		{
+			double delta = grid[i + 1] - grid[i];
+			const double *di = &d[i * NUM_JOINTS], *ddi = &dd[i * NUM_JOINTS], *dn = &d[(i + 1) * NUM_JOINTS], *ddn = &dd_end[(i + 1) * NUM_JOINTS];
+
+			// the feasible s'^2 are an interval from 0, bisected for its end
+			double feasible = 0.0, infeasible = x_velocity[i];
+			double lower, upper;
+			for (int b = 0; b <= BISECTIONS; b++)
+			{
+				double x = b == 0 ? infeasible : 0.5 * (feasible + infeasible);
+				bool ok = accelerationRange(di, ddi, dn, ddn, delta, x, lower, upper);
+				ok = ok && std::max(lower, -x / (2.0 * delta)) <= std::min(upper, (x_max[i + 1] - x) / (2.0 * delta));
+				if (ok)
+				{
+					feasible = x;
+					if (b == 0)
+						break;
+				}
+				else
+					infeasible = x;
+			}
+			x_max[i] = feasible;
+		}
+
+		// forward: from rest, always as fast as the next grid point allows
+		std::vector<double> x(n, 0.0);
+		std::vector<double> t(n, 0.0);
+		for (size_t i = 0; i + 1 < n; i++)
+		{
+			double delta = grid[i + 1] - grid[i];
+			double lower, upper;
+			if (!accelerationRange(&d[i * NUM_JOINTS], &dd[i * NUM_JOINTS], &d[(i + 1) * NUM_JOINTS], &dd_end[(i + 1) * NUM_JOINTS], delta, x[i], lower, upper))
+				upper = 0.0;
+			double u = std::min(upper, (x_max[i + 1] - x[i]) / (2.0 * delta));
+			x[i + 1] = std::max(0.0, std::min(x[i] + 2.0 * delta * u, x_max[i + 1]));
+
+			double speed = sqrt(x[i]) + sqrt(x[i + 1]);
+			if (speed <= 0.0)
+				return false;
+			t[i + 1] = t[i] + 2.0 * delta / speed;
+		}
+
+		// every grid point, a cubic between points further apart would not keep the accelerations
+		retimed.swap(q);
+		times.swap(t);
+		velocities.resize(n * NUM_JOINTS);
+		for (size_t i = 0; i < n; i++)
+			for (size_t j = 0; j < NUM_JOINTS; j++)
+				velocities[i * NUM_JOINTS + j] = d[i * NUM_JOINTS + j] * sqrt(x[i]);
+		return true;
+	}
+}
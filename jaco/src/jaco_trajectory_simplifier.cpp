@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_trajectory_simplifier.cpp
+ *
+ *  PURPOSE ---  Drops joint trajectory points the path does not need before they are uploaded
+ */
+
+#include <jaco/jaco_trajectory_simplifier.h>
+
+#include <math.h>
+#include <algorithm>
+#include <utility>
+
+namespace kinova
+{
+	namespace
+	{
+		// stands in for tolerances <= 0 [rad]
+		const double MIN_TOLERANCE = 1e-9;
+	}
+
+	double JacoTrajectorySimplifier::deviation(const double *start, const double *end, const double *point, const double tolerances[NUM_JOINTS])
+	{
+		// in units of the tolerances, so the closest point on the line weighs the joints as the check does
+		double d[NUM_JOINTS], w[NUM_JOINTS];
+		double dd = 0.0, wd = 0.0;
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+		{
+			double scale = 1.0 / std::max(tolerances[j], MIN_TOLERANCE);
+			d[j] = jointAngleDifference(j, end[j], start[j]) * scale;
+			w[j] = jointAngleDifference(j, point[j], start[j]) * scale;
+			dd += d[j] * d[j];
+			wd += w[j] * d[j];
+		}
+
+		double u = dd > 0.0 ? std::max(0.0, std::min(wd / dd, 1.0)) : 0.0;
+		double largest = 0.0;
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+			largest = std::max(largest, fabs(w[j] - u * d[j]));
+		return largest;
+	}
+
+	void JacoTrajectorySimplifier::simplify(const std::vector<double>& trajectory, const double tolerances[NUM_JOINTS], std::vector<double>& simplified)
+	{
+		size_t count = trajectory.size() / NUM_JOINTS;
+		if (count <= 2)
+		{
+			simplified.assign(trajectory.begin(), trajectory.begin() + count * NUM_JOINTS);
+			return;
+		}
+
+		std::vector<bool> keep(count, false);
+		keep[0] = keep[count - 1] = true;
+
+		// a stack of spans instead of recursion, trajectories may have thousands of points
+		std::vector<std::pair<size_t, size_t> > spans;
+		spans.push_back(std::make_pair((size_t)0, count - 1));
+		while (!spans.empty())
+		{
+			size_t first = spans.back().first, last = spans.back().second;
+			spans.pop_back();
+
+			size_t farthest = first;
+			double largest = 1.0;
+			for (size_t i = first + 1; i < last; i++)
+			{
+				double d = deviation(&trajectory[first * NUM_JOINTS], &trajectory[last * NUM_JOINTS], &trajectory[i * NUM_JOINTS], tolerances);
+				if (d > largest)
+				{
+					largest = d;
+					farthest = i;
+				}
+			}
+
+			if (farthest != first)
+			{
+				keep[farthest] = true;
+				spans.push_back(std::make_pair(first, farthest));
+				spans.push_back(std::make_pair(farthest, last));
+			}
+		}
+
+		simplified.clear();
+		for (size_t i = 0; i < count; i++)
+			if (keep[i])
+				simplified.insert(simplified.end(), trajectory.begin() + i * NUM_JOINTS, trajectory.begin() + (i + 1) * NUM_JOINTS);
+	}
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_twist_servo.cpp
+ *
+ *  PURPOSE ---  Streams joint velocities to the arm that follow the twist commands on servo/twist
+ */
+
+#include <jaco/jaco_twist_servo.h>
+#include <jaco_kinematics/jaco_kinematics.h>
+
+#include <math.h>
+#include <algorithm>
+
+namespace kinova
+{
+	namespace
+	{
+		// scales v[0..2] down to a norm of at most limit
+		void clampNorm(double *v, double limit)
+		{
+			double norm = sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+			if (limit > 0.0 && norm > limit)
+				for (int k = 0; k < 3; k++)
+					v[k] *= limit / norm;
+		}
+	}
+
+	JacoTwistServo::JacoTwistServo(boost::shared_ptr<AbstractJaco> jaco, ros::NodeHandle nh, ros::NodeHandle pn,
+				       boost::shared_ptr<JacoActionController> controller) :
+		jaco(jaco), controller(controller), twist_in_tool_frame(false), active(false)
+	{
+		for (int k = 0; k < 6; k++)
+			twist[k] = 0.0;
+
+		pn.param("servo/timeout", timeout, 0.1);
+		pn.param("servo/damping", damping, 0.02);
+		pn.param("servo/manipulability_threshold", manipulability_threshold, 0.004);
+		pn.param("servo/max_joint_velocity", max_joint_velocity, 0.8);
+		pn.param("servo/max_linear_velocity", max_linear_velocity, 0.2);
+		pn.param("servo/max_angular_velocity", max_angular_velocity, 1.0);
+
+		// only the latest command matters
+		twist_sub = nh.subscribe("servo/twist", 1, &JacoTwistServo::twistCB, this);
+	}
+
+	JacoTwistServo::~JacoTwistServo()
+	{
+		if (active)
+			sendStop();
+	}
+
+	bool JacoTwistServo::armBusy() const
+	{
+		return controller && controller->hasActiveArmGoal();
+	}
+
+	void JacoTwistServo::twistCB(const geometry_msgs::TwistStampedConstPtr& msg)
+	{
+		// erasing the FIFO here would leave the goal running on nothing, and its velocities would fight ours
+		if (armBusy())
+		{
+			ROS_WARN_THROTTLE(1.0, "servo/twist: ignored while an arm goal is active");
+			return;
+		}
+
+		const std::string& frame = msg->header.frame_id;
+		if (frame == "jaco_gripper_tool_frame")
+			twist_in_tool_frame = true;
+		else if (frame.empty() || frame == "jaco_base_link")
+			twist_in_tool_frame = false;
+		else
+		{
+			ROS_WARN_THROTTLE(1.0, "servo/twist: twists in frame %s are not supported, only jaco_base_link and jaco_gripper_tool_frame", frame.c_str());
+			return;
+		}
+
+		twist[0] = msg->twist.linear.x;
+		twist[1] = msg->twist.linear.y;
+		twist[2] = msg->twist.linear.z;
+		twist[3] = msg->twist.angular.x;
+		twist[4] = msg->twist.angular.y;
+		twist[5] = msg->twist.angular.z;
+		twist_time = ros::Time::now();
+
+		if (!active)
+		{
+			// velocities are joint commands, whatever is left in the FIFO of the arm would fight them
+			jaco->setAngularMode();
+			jaco->eraseTrajectories();
+			active = true;
+		}
+	}
+
+	void JacoTwistServo::update()
+	{
+		if (!active)
+			return;
+
+		// a goal accepted since takes over, it is sent after this stop in the same cycle
+		if (armBusy())
+		{
+			ROS_WARN("servo/twist: preempted by an arm goal");
+			sendStop();
+			active = false;
+			return;
+		}
+
+		if ((ros::Time::now() - twist_time).toSec() > timeout)
+		{
+			sendStop();
+			active = false;
+			return;
+		}
+
+		JacoStateSnapshotConstPtr state = jaco->getStateSnapshot();
+		double q[NUM_JOINTS];
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			q[i] = state->joint_angles[i];
+
+		double command[6];
+		if (twist_in_tool_frame)
+		{
+			JacoFrame tool;
+			JacoKinematics::forward(q, tool);
+			for (int row = 0; row < 3; row++)
+			{
+				command[row] = 0.0;
+				command[3 + row] = 0.0;
+				for (int col = 0; col < 3; col++)
+				{
+					command[row] += tool.R[3*row + col] * twist[col];
+					command[3 + row] += tool.R[3*row + col] * twist[3 + col];
+				}
+			}
+		}
+		else
+			std::copy(twist, twist + 6, command);
+
+		clampNorm(command, max_linear_velocity);
+		clampNorm(command + 3, max_angular_velocity);
+
+		// damping grows from 0 at the threshold to its maximum at a singular configuration (Nakamura and Hanafusa)
+		double J[6 * NUM_JOINTS], translational, rotational;
+		JacoKinematics::jacobian(q, J);
+		double w = JacoKinematics::manipulability(J, translational, rotational);
+		double lambda = 0.0;
+		if (w < manipulability_threshold)
+			lambda = damping * sqrt(1.0 - (w / manipulability_threshold) * (w / manipulability_threshold));
+
+		double qdot[NUM_JOINTS];
+		if (!JacoKinematics::dampedLeastSquares(J, command, std::max(lambda, 1e-6), qdot))
+		{
+			ROS_WARN_THROTTLE(1.0, "servo/twist: no joint velocities for this configuration, stopping");
+			sendStop();
+			return;
+		}
+
+		double fastest = 0.0;
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+			fastest = std::max(fastest, fabs(qdot[i]));
+		if (max_joint_velocity > 0.0 && fastest > max_joint_velocity)
+			for (size_t i = 0; i < NUM_JOINTS; i++)
+				qdot[i] *= max_joint_velocity / fastest;
+
+		jaco->setJointVelocities(qdot);
+	}
+
+	void JacoTwistServo::sendStop()
+	{
+		double zero[NUM_JOINTS] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+		jaco->setJointVelocities(zero);
+	}
+}
@@ -0,0 +1,422 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_workspace.cpp
+ *
+ *  PURPOSE ---  Workspace fences in base_jaco the commands of the hand are checked against
+ */
+
+#include <jaco/jaco_workspace.h>
+#include <jaco_kinematics/jaco_kinematics.h>
+
+#include <math.h>
+#include <algorithm>
+
+namespace kinova
+{
+	namespace
+	{
+		// lines of the hand are sampled this densely [m], joint motions [rad]
+		const double LINE_STEP = 0.01;
+		const double JOINT_STEP = 0.02;
+
+		// passes over the fences when a target is moved onto them, overlapping fences may push it back and forth
+		const int PROJECTION_PASSES = 3;
+
+		// so a target moved exactly onto a fence is not refused for rounding [m]
+		const double TOLERANCE = 1e-6;
+
+		// bisection steps for the clamped velocity scale
+		const int SCALE_ITERATIONS = 12;
+
+		double norm(const double a[3])
+		{
+			return sqrt(a[0]*a[0] + a[1]*a[1] + a[2]*a[2]);
+		}
+
+		// distance of p outside the axis aligned box, negative inside
+		double boxOutside(const double lower[3], const double upper[3], const double p[3])
+		{
+			double outside[3], deepest = -HUGE_VAL;
+			bool is_outside = false;
+			for (int k = 0; k < 3; k++)
+			{
+				double e = std::max(lower[k] - p[k], p[k] - upper[k]);
+				deepest = std::max(deepest, e);
+				outside[k] = std::max(e, 0.0);
+				is_outside = is_outside || e > 0.0;
+			}
+			return is_outside ? norm(outside) : deepest;
+		}
+	}
+
+	JacoWorkspaceFence::JacoWorkspaceFence() : type(BOX), keep_out(false), radius(0.0), height(0.0)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			lower[k] = upper[k] = point[k] = 0.0;
+			normal[k] = (k == 2) ? 1.0 : 0.0;
+		}
+	}
+
+	double JacoWorkspaceFence::distance(const double p[3]) const
+	{
+		switch (type)
+		{
+			case BOX:
+				return keep_out ? boxOutside(lower, upper, p) : -boxOutside(lower, upper, p);
+
+			case PLANE:
+			{
+				double d[3] = { p[0] - point[0], p[1] - point[1], p[2] - point[2] };
+				return (d[0]*normal[0] + d[1]*normal[1] + d[2]*normal[2]) / norm(normal);
+			}
+
+			case CYLINDER:
+			{
+				double r = hypot(p[0] - point[0], p[1] - point[1]);
+				double radial = r - radius;
+				double vertical = std::max(point[2] - p[2], p[2] - point[2] - height);
+				double outside = (radial > 0.0 && vertical > 0.0) ? hypot(radial, vertical) : std::max(radial, vertical);
+				return keep_out ? outside : -outside;
+			}
+		}
+		return HUGE_VAL;
+	}
+
+	void JacoWorkspaceFence::project(const double p[3], double offset, double out[3]) const
+	{
+		std::copy(p, p + 3, out);
+		if (distance(p) >= offset)
+			return;
+
+		switch (type)
+		{
+			case BOX:
+				if (!keep_out)
+				{
+					for (int k = 0; k < 3; k++)
+					{
+						double low = lower[k] + offset, high = upper[k] - offset;
+						out[k] = (low > high) ? 0.5 * (lower[k] + upper[k]) : std::min(high, std::max(low, p[k]));
+					}
+				}
+				else
+				{
+					// out of the grown box over its nearest face
+					int axis = 0;
+					double shortest = HUGE_VAL, target = p[0];
+					for (int k = 0; k < 3; k++)
+					{
+						double down = p[k] - (lower[k] - offset), up = (upper[k] + offset) - p[k];
+						if (down < shortest)
+						{
+							shortest = down;
+							axis = k;
+							target = lower[k] - offset;
+						}
+						if (up < shortest)
+						{
+							shortest = up;
+							axis = k;
+							target = upper[k] + offset;
+						}
+					}
+					out[axis] = target;
+				}
+				break;
+
+			case PLANE:
+			{
+				double length = norm(normal), push = offset - distance(p);
+				for (int k = 0; k < 3; k++)
+					out[k] = p[k] + push * normal[k] / length;
+				break;
+			}
+
+			case CYLINDER:
+			{
+				double dx = p[0] - point[0], dy = p[1] - point[1], r = hypot(dx, dy);
+				if (r < 1e-9)
+				{
+					// on the axis, any direction is as good
+					dx = 1.0;
+					dy = 0.0;
+					r = 1.0;
+				}
+
+				if (!keep_out)
+				{
+					double limit = std::max(0.0, radius - offset);
+					if (r > limit)
+					{
+						out[0] = point[0] + dx * limit / r;
+						out[1] = point[1] + dy * limit / r;
+					}
+					double low = point[2] + offset, high = point[2] + height - offset;
+					out[2] = (low > high) ? point[2] + 0.5 * height : std::min(high, std::max(low, p[2]));
+				}
+				else
+				{
+					// out of the grown cylinder over its side or the nearer cap
+					double side = radius + offset - r;
+					double down = p[2] - (point[2] - offset), up = (point[2] + height + offset) - p[2];
+					if (side <= std::min(down, up))
+					{
+						out[0] = point[0] + dx * (radius + offset) / r;
+						out[1] = point[1] + dy * (radius + offset) / r;
+					}
+					else if (down < up)
+						out[2] = point[2] - offset;
+					else
+						out[2] = point[2] + height + offset;
+				}
+				break;
+			}
+		}
+	}
+
+	// the hand is at the wrist flange plus the fingers, the padding covers the fingers around the tool point
+	JacoWorkspaceLimits::JacoWorkspaceLimits() :
+		action(WORKSPACE_REJECT),
+		padding(0.05),
+		slow_distance(0.1),
+		velocity_lookahead(0.2),
+		direction_lookahead(0.02)
+	{
+		for (int i = 0; i < 4; i++)
+			api_origin[i] = 0.0;
+	}
+
+	JacoWorkspace::JacoWorkspace()
+	{
+	}
+
+	void JacoWorkspace::setLimits(const JacoWorkspaceLimits& limits)
+	{
+		limits_ = limits;
+	}
+
+	const JacoWorkspaceLimits& JacoWorkspace::getLimits() const
+	{
+		return limits_;
+	}
+
+	void JacoWorkspace::addFence(const JacoWorkspaceFence& fence)
+	{
+		fences_.push_back(fence);
+	}
+
+	void JacoWorkspace::clearFences()
+	{
+		fences_.clear();
+	}
+
+	size_t JacoWorkspace::size() const
+	{
+		return fences_.size();
+	}
+
+	const JacoWorkspaceFence& JacoWorkspace::fence(size_t index) const
+	{
+		return fences_.at(index);
+	}
+
+	double JacoWorkspace::distance(const double p[3], size_t *closest) const
+	{
+		double smallest = HUGE_VAL;
+		for (size_t i = 0; i < fences_.size(); i++)
+		{
+			double d = fences_[i].distance(p) - limits_.padding;
+			if (d < smallest)
+			{
+				smallest = d;
+				if (closest)
+					*closest = i;
+			}
+		}
+		return smallest;
+	}
+
+	void JacoWorkspace::toolPosition(const double q[NUM_JOINTS], double p[3]) const
+	{
+		JacoFrame tool;
+		JacoKinematics::forward(q, tool);
+
+		double c = cos(limits_.api_origin[3]), s = sin(limits_.api_origin[3]);
+		p[0] = c * tool.p[0] - s * tool.p[1] + limits_.api_origin[0];
+		p[1] = s * tool.p[0] + c * tool.p[1] + limits_.api_origin[1];
+		p[2] = tool.p[2] + limits_.api_origin[2];
+	}
+
+	bool JacoWorkspace::lineAllowed(const double from[3], const double to[3]) const
+	{
+		double floor = std::min(0.0, distance(from)) - TOLERANCE;
+		double delta[3] = { to[0] - from[0], to[1] - from[1], to[2] - from[2] };
+		int steps = std::max(1, (int)ceil(norm(delta) / LINE_STEP));
+
+		for (int i = 1; i <= steps; i++)
+		{
+			double s = (double)i / steps, p[3];
+			for (int k = 0; k < 3; k++)
+				p[k] = from[k] + s * delta[k];
+			if (distance(p) < floor)
+				return false;
+		}
+		return true;
+	}
+
+	bool JacoWorkspace::jointPathAllowed(const double start[NUM_JOINTS], const double *waypoints, size_t count) const
+	{
+		if (fences_.empty())
+			return true;
+
+		const double *from = start;
+		for (size_t i = 0; i < count; i++)
+		{
+			const double *to = waypoints + i * NUM_JOINTS;
+
+			double p[3], widest = 0.0;
+			toolPosition(from, p);
+			double floor = std::min(0.0, distance(p));
+
+			for (size_t j = 0; j < NUM_JOINTS; j++)
+				widest = std::max(widest, fabs(to[j] - from[j]));
+			int steps = std::max(1, (int)ceil(widest / JOINT_STEP));
+
+			for (int k = 1; k <= steps; k++)
+			{
+				double s = (double)k / steps, q[NUM_JOINTS];
+				for (size_t j = 0; j < NUM_JOINTS; j++)
+					q[j] = from[j] + s * (to[j] - from[j]);
+				toolPosition(q, p);
+				if (distance(p) < floor)
+					return false;
+			}
+			from = to;
+		}
+		return true;
+	}
+
+	bool JacoWorkspace::positionPathAllowed(const double start[3], const double *positions, size_t count) const
+	{
+		if (fences_.empty())
+			return true;
+
+		const double *from = start;
+		for (size_t i = 0; i < count; i++)
+		{
+			if (!lineAllowed(from, positions + 3 * i))
+				return false;
+			from = positions + 3 * i;
+		}
+		return true;
+	}
+
+	bool JacoWorkspace::positionAllowed(const double start[3], double target[3]) const
+	{
+		if (fences_.empty() || lineAllowed(start, target))
+			return true;
+		if (limits_.action == WORKSPACE_REJECT)
+			return false;
+
+		for (int pass = 0; pass < PROJECTION_PASSES; pass++)
+			for (size_t i = 0; i < fences_.size(); i++)
+			{
+				double moved[3];
+				fences_[i].project(target, limits_.padding, moved);
+				std::copy(moved, moved + 3, target);
+			}
+
+		// a keep out fence may still be in the way
+		return lineAllowed(start, target);
+	}
+
+	bool JacoWorkspace::directionAllowed(const double start[3], double direction[3]) const
+	{
+		if (fences_.empty())
+			return true;
+
+		double to[3];
+		for (int k = 0; k < 3; k++)
+			to[k] = start[k] + ((direction[k] > 0.0) - (direction[k] < 0.0)) * limits_.direction_lookahead;
+		if (lineAllowed(start, to))
+			return true;
+		if (limits_.action == WORKSPACE_REJECT)
+			return false;
+
+		for (int k = 0; k < 3; k++)
+		{
+			if (direction[k] == 0.0)
+				continue;
+
+			std::copy(start, start + 3, to);
+			to[k] += (direction[k] > 0.0 ? 1.0 : -1.0) * limits_.direction_lookahead;
+			if (!lineAllowed(start, to))
+				direction[k] = 0.0;
+		}
+		return true;
+	}
+
+	double JacoWorkspace::velocityScale(const double q[NUM_JOINTS], const double velocities[NUM_JOINTS]) const
+	{
+		if (fences_.empty())
+			return 1.0;
+
+		double p[3], q1[NUM_JOINTS];
+		toolPosition(q, p);
+		double d0 = distance(p);
+
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+			q1[j] = q[j] + velocities[j] * limits_.velocity_lookahead;
+		toolPosition(q1, p);
+		double d1 = distance(p);
+
+		// moving away from the fences is always allowed
+		if (d1 >= d0)
+			return 1.0;
+
+		double floor = std::min(0.0, d0), scale = 1.0;
+		if (d1 < floor)
+		{
+			if (limits_.action == WORKSPACE_REJECT)
+				return 0.0;
+
+			// the largest part of the motion that ends on the fence
+			double low = 0.0, high = 1.0;
+			for (int i = 0; i < SCALE_ITERATIONS; i++)
+			{
+				double middle = 0.5 * (low + high);
+				for (size_t j = 0; j < NUM_JOINTS; j++)
+					q1[j] = q[j] + middle * velocities[j] * limits_.velocity_lookahead;
+				toolPosition(q1, p);
+				if (distance(p) >= floor)
+					low = middle;
+				else
+					high = middle;
+			}
+			scale = low;
+		}
+
+		if (limits_.action == WORKSPACE_SLOW && d0 < limits_.slow_distance && limits_.slow_distance > 0.0)
+			scale *= std::max(0.0, d0) / limits_.slow_distance;
+		return scale;
+	}
+}
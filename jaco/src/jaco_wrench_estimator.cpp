@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_wrench_estimator.cpp
+ *
+ *  PURPOSE ---  External joint torques and the wrench on the hand from the joint currents
+ */
+
+#include <jaco/jaco_wrench_estimator.h>
+#include <jaco_kinematics/jaco_kinematics.h>
+
+#include <math.h>
+#include <algorithm>
+
+namespace kinova
+{
+	namespace
+	{
+		// the datasheet gives 5.7 kg for the arm with the hand, about 1 kg of it is the base
+		const JacoMass DEFAULT_LINKS[NUM_JOINTS] =
+		{
+			{ 0.75, { -0.0005, 0.0098, -0.0533 } },
+			{ 0.99, { 0.2053, 0.0001, -0.0131 } },
+			{ 0.68, { 0.0, 0.0885, 0.0006 } },
+			{ 0.43, { 0.0, -0.0145, -0.0035 } },
+			{ 0.43, { -0.0004, -0.0150, -0.0034 } },
+			{ 0.99, { 0.0, -0.0009, -0.0810 } }
+		};
+
+		// nominal, the large actuators drive joints 1 - 3, identify them on the arm
+		const double DEFAULT_TORQUE_CONSTANTS[NUM_JOINTS] = { 7.0, 7.0, 7.0, 3.0, 3.0, 3.0 };
+
+		// a longer pause between two samples [s] restarts the low pass
+		const double MAX_GAP = 0.5;
+
+		void cross(const double a[3], const double b[3], double out[3])
+		{
+			out[0] = a[1]*b[2] - a[2]*b[1];
+			out[1] = a[2]*b[0] - a[0]*b[2];
+			out[2] = a[0]*b[1] - a[1]*b[0];
+		}
+
+		void transform(const JacoFrame& frame, const double p[3], double out[3])
+		{
+			for (int row = 0; row < 3; row++)
+				out[row] = frame.R[3*row]*p[0] + frame.R[3*row + 1]*p[1] + frame.R[3*row + 2]*p[2] + frame.p[row];
+		}
+	}
+
+	JacoWrenchModel::JacoWrenchModel()
+	{
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+		{
+			links[i] = DEFAULT_LINKS[i];
+			torque_constants[i] = DEFAULT_TORQUE_CONSTANTS[i];
+		}
+
+		payload.mass = 0.0;
+		payload.com[0] = payload.com[1] = payload.com[2] = 0.0;
+
+		gravity[0] = 0.0;
+		gravity[1] = 0.0;
+		gravity[2] = -9.81;
+	}
+
+	JacoWrenchEstimator::JacoWrenchEstimator() : damping_(0.01), time_constant_(0.05), last_time_(0.0), initialised_(false), payload_mass_(0.0)
+	{
+		std::fill(offsets_, offsets_ + NUM_JOINTS, 0.0);
+		std::fill(external_torques_, external_torques_ + NUM_JOINTS, 0.0);
+		std::fill(wrench_, wrench_ + 6, 0.0);
+	}
+
+	void JacoWrenchEstimator::setModel(const JacoWrenchModel& model)
+	{
+		model_ = model;
+	}
+
+	const JacoWrenchModel& JacoWrenchEstimator::getModel() const
+	{
+		return model_;
+	}
+
+	void JacoWrenchEstimator::setDamping(double damping)
+	{
+		damping_ = damping;
+	}
+
+	void JacoWrenchEstimator::setTimeConstant(double time_constant)
+	{
+		time_constant_ = std::max(0.0, time_constant);
+	}
+
+	void JacoWrenchEstimator::gravityTorques(const double q[NUM_JOINTS], double torques[NUM_JOINTS]) const
+	{
+		JacoFrame frames[JacoKinematics::NUM_FRAMES];
+		JacoKinematics::linkFrames(q, frames);
+
+		// weight and center of mass of every body in jaco_base_link, the payload hangs on jaco_link_6
+		double weights[NUM_JOINTS + 1][3], centers[NUM_JOINTS + 1][3];
+		for (size_t i = 0; i <= NUM_JOINTS; i++)
+		{
+			const JacoMass& body = (i < NUM_JOINTS) ? model_.links[i] : model_.payload;
+			transform(frames[i], body.com, centers[i]);
+			for (int k = 0; k < 3; k++)
+				weights[i][k] = body.mass * model_.gravity[k];
+		}
+
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+		{
+			JacoFrame origin;
+			double sign;
+			JacoKinematics::jointOrigin(j, origin, sign);
+
+			double axis[3] = { sign * frames[j].R[2], sign * frames[j].R[5], sign * frames[j].R[8] };
+
+			// the motor holds against the moment of every body behind the joint
+			torques[j] = 0.0;
+			for (size_t i = j; i <= NUM_JOINTS; i++)
+			{
+				double lever[3], moment[3];
+				for (int k = 0; k < 3; k++)
+					lever[k] = centers[i][k] - frames[j].p[k];
+				cross(lever, weights[i], moment);
+				torques[j] -= axis[0]*moment[0] + axis[1]*moment[1] + axis[2]*moment[2];
+			}
+		}
+	}
+
+	void JacoWrenchEstimator::rawExternalTorques(const double q[NUM_JOINTS], const double currents[NUM_JOINTS], double torques[NUM_JOINTS]) const
+	{
+		gravityTorques(q, torques);
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+			torques[j] -= model_.torque_constants[j] * currents[j];
+	}
+
+	void JacoWrenchEstimator::tare(const double q[NUM_JOINTS], const double currents[NUM_JOINTS])
+	{
+		rawExternalTorques(q, currents, offsets_);
+		initialised_ = false;
+	}
+
+	void JacoWrenchEstimator::update(double time, const double q[NUM_JOINTS], const double currents[NUM_JOINTS])
+	{
+		double raw[NUM_JOINTS];
+		rawExternalTorques(q, currents, raw);
+
+		double dt = time - last_time_;
+		double alpha = (!initialised_ || dt <= 0.0 || dt > MAX_GAP || time_constant_ <= 0.0) ? 1.0 : dt / (time_constant_ + dt);
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+			external_torques_[j] += alpha * (raw[j] - offsets_[j] - external_torques_[j]);
+		last_time_ = time;
+		initialised_ = true;
+
+		double J[6 * NUM_JOINTS], base[6];
+		JacoKinematics::jacobian(q, J);
+		if (!JacoKinematics::dampedWrench(J, external_torques_, damping_, base))
+			return;
+
+		double g2 = model_.gravity[0]*model_.gravity[0] + model_.gravity[1]*model_.gravity[1] + model_.gravity[2]*model_.gravity[2];
+		payload_mass_ = (g2 > 0.0) ? (base[0]*model_.gravity[0] + base[1]*model_.gravity[1] + base[2]*model_.gravity[2]) / g2 : 0.0;
+
+		// force and moment about the tool point into the tool frame
+		JacoFrame tool;
+		JacoKinematics::forward(q, tool);
+		for (int row = 0; row < 3; row++)
+		{
+			wrench_[row] = tool.R[row]*base[0] + tool.R[3 + row]*base[1] + tool.R[6 + row]*base[2];
+			wrench_[3 + row] = tool.R[row]*base[3] + tool.R[3 + row]*base[4] + tool.R[6 + row]*base[5];
+		}
+	}
+}
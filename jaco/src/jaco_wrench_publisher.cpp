@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_wrench_publisher.cpp
+ *
+ *  PURPOSE ---  Publishes the wrench on the hand estimated from the joint currents
+ */
+
+#include <jaco/jaco_wrench_publisher.h>
+#include <jaco/jaco_params.h>
+
+namespace kinova
+{
+        // messages allocated up front / maximum the pool grows to while intra-process subscribers hold them
+        const size_t WRENCH_POOL_SIZE = 4;
+        const size_t WRENCH_POOL_MAX_SIZE = 32;
+
+        JacoWrenchPublisher::JacoWrenchPublisher(boost::shared_ptr<AbstractJaco> jaco, ros::NodeHandle nh, ros::NodeHandle pn) :
+                jaco(jaco), last_sequence(0), tare_requested(true)
+        {
+                JacoWrenchModel model;
+                double masses[NUM_JOINTS], centers[3 * NUM_JOINTS];
+                for (size_t i = 0; i < NUM_JOINTS; i++)
+                {
+                        masses[i] = model.links[i].mass;
+                        for (size_t k = 0; k < 3; k++)
+                                centers[3*i + k] = model.links[i].com[k];
+                }
+
+                readList(pn, "wrench/masses", masses, NUM_JOINTS);
+                readList(pn, "wrench/centers_of_mass", centers, 3 * NUM_JOINTS);
+                readList(pn, "wrench/torque_constants", model.torque_constants, NUM_JOINTS);
+                readList(pn, "wrench/gravity", model.gravity, 3);
+                pn.param("wrench/payload_mass", model.payload.mass, model.payload.mass);
+                readList(pn, "wrench/payload_center_of_mass", model.payload.com, 3);
+
+                for (size_t i = 0; i < NUM_JOINTS; i++)
+                {
+                        model.links[i].mass = masses[i];
+                        for (size_t k = 0; k < 3; k++)
+                                model.links[i].com[k] = centers[3*i + k];
+                }
+                estimator.setModel(model);
+
+                double damping, time_constant;
+                pn.param("wrench/damping", damping, 0.01);
+                pn.param("wrench/time_constant", time_constant, 0.05);
+                estimator.setDamping(damping);
+                estimator.setTimeConstant(time_constant);
+
+                wrench_pub = nh.advertise<geometry_msgs::WrenchStamped>("tool_wrench", 100);
+                payload_pub = nh.advertise<std_msgs::Float64>("estimated_payload", 10);
+                tare_sub = nh.subscribe("wrench/tare", 1, &JacoWrenchPublisher::tareCB, this);
+
+                geometry_msgs::WrenchStamped prototype;
+                prototype.header.frame_id = "jaco_gripper_tool_frame";
+                wrench_pool.reset(new MessagePool<geometry_msgs::WrenchStamped>(prototype, WRENCH_POOL_SIZE, WRENCH_POOL_MAX_SIZE));
+        }
+
+        JacoWrenchPublisher::~JacoWrenchPublisher()
+        {
+        }
+
+        void JacoWrenchPublisher::tareCB(const std_msgs::EmptyConstPtr& msg)
+        {
+                tare_requested = true;
+        }
+
+	void JacoWrenchPublisher::update()
+	{
+		JacoStateSnapshotConstPtr state = jaco -> getStateSnapshot();
+
+		if (state->sequence == last_sequence || state->sequence == 0)
+			return;
+		last_sequence = state->sequence;
+
+		// the actuators report their currents in their own direction
+		const double *signs = jaco->getJointCalibration().getSigns();
+		double q[NUM_JOINTS], currents[NUM_JOINTS];
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+		{
+			q[i] = state->joint_angles[i];
+			currents[i] = signs[i] * state->joints_current[i];
+		}
+
+		if (tare_requested)
+		{
+			estimator.tare(q, currents);
+			tare_requested = false;
+			ROS_INFO("Wrench estimate tared");
+		}
+		estimator.update(state->stamp.toSec(), q, currents);
+
+		geometry_msgs::WrenchStampedPtr msg = wrench_pool->acquire();
+		const double *wrench = estimator.getWrench();
+
+		msg->header.stamp = state->stamp;
+		msg->wrench.force.x = wrench[0];
+		msg->wrench.force.y = wrench[1];
+		msg->wrench.force.z = wrench[2];
+		msg->wrench.torque.x = wrench[3];
+		msg->wrench.torque.y = wrench[4];
+		msg->wrench.torque.z = wrench[5];
+		wrench_pub.publish(msg);
+
+		std_msgs::Float64 payload;
+		payload.data = estimator.getPayloadMass();
+		payload_pub.publish(payload);
+	}
+}
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- state_shm.cpp
+ *
+ *  PURPOSE ---  Shared memory ring buffer of arm states for local processes
+ */
+
+#include <jaco/state_shm.h>
+
+#include <iostream>
+#include <string.h>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+using namespace boost::interprocess;
+
+namespace kinova
+{
+	// "JACO" and the layout version, a reader refuses segments it does not understand
+	const uint32_t STATE_SHM_MAGIC = 0x4a41434f;
+	const uint32_t STATE_SHM_VERSION = 1;
+
+	// attempts of a reader on a slot the writer is busy with before giving up on it
+	const int STATE_SHM_READ_RETRIES = 16;
+
+	struct __attribute__((aligned(64))) JacoShmHeader
+	{
+		volatile uint32_t magic;		// written last, once the segment is set up
+		uint32_t version;
+		uint32_t sample_size;
+		uint32_t capacity;
+		volatile uint64_t write_count;		// number of samples written so far
+	};
+
+	struct __attribute__((aligned(64))) JacoShmSlot
+	{
+		volatile uint64_t lock;			// odd while the writer is changing the slot
+		uint64_t index;				// write_count at the time the sample was written
+		JacoShmSample sample;
+	};
+
+	static size_t segmentSize(size_t capacity)
+	{
+		return sizeof(JacoShmHeader) + capacity * sizeof(JacoShmSlot);
+	}
+
+
+	StateShmWriter::StateShmWriter(const std::string& name, size_t capacity) : name_(name), header_(NULL), slots_(NULL)
+	{
+		if (capacity == 0)
+			capacity = 1;
+
+		try
+		{
+			// a segment left over by a crashed driver is replaced
+			shared_memory_object::remove(name_.c_str());
+
+			shared_memory_object shm(create_only, name_.c_str(), read_write);
+			shm.truncate(segmentSize(capacity));
+			region_.reset(new mapped_region(shm, read_write));
+		}
+		catch (interprocess_exception& e)
+		{
+			std::cout<< "Error : could not create the shared memory segment " << name_ << " : " << e.what() <<std::endl;
+			region_.reset();
+			return;
+		}
+
+		memset(region_->get_address(), 0, region_->get_size());
+
+		header_ = static_cast<JacoShmHeader*>(region_->get_address());
+		slots_ = reinterpret_cast<JacoShmSlot*>(header_ + 1);
+
+		header_->version = STATE_SHM_VERSION;
+		header_->sample_size = sizeof(JacoShmSample);
+		header_->capacity = capacity;
+		header_->write_count = 0;
+
+		__sync_synchronize();
+		header_->magic = STATE_SHM_MAGIC;
+	}
+
+	StateShmWriter::~StateShmWriter()
+	{
+		if (region_)
+			shared_memory_object::remove(name_.c_str());
+	}
+
+	bool StateShmWriter::isOpen() const
+	{
+		return header_ != NULL;
+	}
+
+	void StateShmWriter::write(const JacoShmSample& sample)
+	{
+		if (header_ == NULL)
+			return;
+
+		uint64_t count = header_->write_count;
+		JacoShmSlot& slot = slots_[count % header_->capacity];
+
+		uint64_t lock = slot.lock;
+		slot.lock = lock + 1;
+		__sync_synchronize();
+
+		slot.index = count;
+		slot.sample = sample;
+
+		__sync_synchronize();
+		slot.lock = lock + 2;
+
+		__sync_synchronize();
+		header_->write_count = count + 1;
+	}
+
+
+	StateShmReader::StateShmReader(const std::string& name) : name_(name), header_(NULL), slots_(NULL)
+	{
+		open();
+	}
+
+	bool StateShmReader::open()
+	{
+		if (header_ != NULL)
+			return true;
+
+		try
+		{
+			shared_memory_object shm(open_only, name_.c_str(), read_only);
+			region_.reset(new mapped_region(shm, read_only));
+		}
+		catch (interprocess_exception& e)
+		{
+			// the driver is not running (yet)
+			region_.reset();
+			return false;
+		}
+
+		const JacoShmHeader *header = static_cast<const JacoShmHeader*>(region_->get_address());
+
+		if (region_->get_size() < sizeof(JacoShmHeader) || header->magic != STATE_SHM_MAGIC)
+		{
+			region_.reset();
+			return false;
+		}
+		__sync_synchronize();
+
+		if (header->version != STATE_SHM_VERSION || header->sample_size != sizeof(JacoShmSample) || region_->get_size() < segmentSize(header->capacity))
+		{
+			std::cout<< "Error : shared memory segment " << name_ << " has an incompatible layout" <<std::endl;
+			region_.reset();
+			return false;
+		}
+
+		header_ = header;
+		slots_ = reinterpret_cast<const JacoShmSlot*>(header_ + 1);
+		return true;
+	}
+
+	bool StateShmReader::isOpen() const
+	{
+		return header_ != NULL;
+	}
+
+	size_t StateShmReader::capacity() const
+	{
+		return header_ == NULL ? 0 : header_->capacity;
+	}
+
+	uint64_t StateShmReader::writeCount() const
+	{
+		if (header_ == NULL)
+			return 0;
+
+		uint64_t count = header_->write_count;
+		__sync_synchronize();
+		return count;
+	}
+
+	bool StateShmReader::readSlot(uint64_t index, JacoShmSample& sample) const
+	{
+		const JacoShmSlot& slot = slots_[index % header_->capacity];
+
+		for (int i = 0; i < STATE_SHM_READ_RETRIES; i++)
+		{
+			uint64_t lock = slot.lock;
+			if (lock & 1)
+				continue;
+			__sync_synchronize();
+
+			uint64_t slot_index = slot.index;
+			memcpy(&sample, &slot.sample, sizeof(JacoShmSample));
+
+			__sync_synchronize();
+			if (slot.lock == lock)
+				return slot_index == index;	// otherwise the writer lapped us
+		}
+
+		return false;
+	}
+
+	bool StateShmReader::readLatest(JacoShmSample& sample) const
+	{
+		if (header_ == NULL)
+			return false;
+
+		// if the writer overtakes us, take the newer sample
+		for (int i = 0; i < STATE_SHM_READ_RETRIES; i++)
+		{
+			uint64_t count = writeCount();
+			if (count == 0)
+				return false;
+
+			if (readSlot(count - 1, sample))
+				return true;
+		}
+
+		return false;
+	}
+
+	size_t StateShmReader::readHistory(std::vector<JacoShmSample>& samples, size_t max_samples) const
+	{
+		samples.clear();
+
+		uint64_t count = writeCount();
+		if (count > max_samples)
+		{
+			uint64_t position = count - max_samples;
+			return readNew(position, samples);
+		}
+
+		uint64_t position = 0;
+		return readNew(position, samples);
+	}
+
+	size_t StateShmReader::readNew(uint64_t& position, std::vector<JacoShmSample>& samples) const
+	{
+		if (header_ == NULL)
+			return 0;
+
+		uint64_t count = writeCount();
+
+		// the oldest samples are gone already
+		if (count > position + header_->capacity)
+			position = count - header_->capacity;
+
+		size_t read = 0;
+		JacoShmSample sample;
+		for (; position < count; position++)
+		{
+			if (readSlot(position, sample))
+			{
+				samples.push_back(sample);
+				read++;
+			}
+		}
+
+		return read;
+	}
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_kinematics.h
+ *
+ *  PURPOSE ---  Analytic kinematics of the jaco arm as modelled in jaco_description/urdf/gazebo/jaco.urdf
+ */
+
+#ifndef JACO_KINEMATICS_H_
+#define JACO_KINEMATICS_H_
+
+#include <cstddef>
+
+namespace kinova
+{
+	/// \brief Rigid transform. R is row major, so R[3*row + col].
+	struct JacoFrame
+	{
+		double R[9];
+		double p[3];
+	};
+
+	/**
+	*  Kinematics of the chain jaco_base_link -> jaco_gripper_tool_frame. Joint angles are the
+	*  ones published on joint_states (radians, urdf zero position and directions).
+	*  Everything is computed in closed form from the joint origins of the urdf, no allocation,
+	*  so it is cheap enough to run on every sample of the arm.
+	*/
+	class JacoKinematics
+	{
+		public:
+			static const size_t NUM_JOINTS = 6;
+
+			// jaco_link_1 .. jaco_link_6 and jaco_gripper_tool_frame
+			static const size_t NUM_FRAMES = NUM_JOINTS + 1;
+
+			// pose of jaco_gripper_tool_frame in jaco_base_link
+			static void forward(const double q[NUM_JOINTS], JacoFrame& tool);
+
+			// pose of every link of the chain in jaco_base_link, the tool frame is the last one
+			static void linkFrames(const double q[NUM_JOINTS], JacoFrame frames[NUM_FRAMES]);
+
+			// geometric jacobian of the tool frame in jaco_base_link, row major 6 x NUM_JOINTS,
+			// rows are linear velocity x, y, z then angular velocity x, y, z
+			static void jacobian(const double q[NUM_JOINTS], double J[6 * NUM_JOINTS]);
+
+			/**
+			* Yoshikawa manipulability of a jacobian: |det J|, which is 0 in singular configurations
+			* (m^3). translational / rotational are sqrt(det(J J^T)) of the linear (m^3) and the
+			* angular (dimensionless) rows alone.
+			*/
+			static double manipulability(const double J[6 * NUM_JOINTS], double& translational, double& rotational);
+
+			/**
+			* Joint velocities for a twist of the tool frame (vx vy vz wx wy wz in jaco_base_link) by
+			* damped least squares, qdot = J^T (J J^T + damping^2 I)^-1 twist. With damping 0 this is
+			* the plain inverse, which fails (returns false) in singular configurations.
+			*/
+			static bool dampedLeastSquares(const double J[6 * NUM_JOINTS], const double twist[6], double damping, double qdot[NUM_JOINTS]);
+
+			/**
+			* Wrench on the tool frame (fx fy fz tx ty tz in jaco_base_link) which balances the joint
+			* torques, J^T wrench = torques, by damped least squares, wrench = (J J^T + damping^2 I)^-1 J torques.
+			*/
+			static bool dampedWrench(const double J[6 * NUM_JOINTS], const double torques[NUM_JOINTS], double damping, double wrench[6]);
+
+			// upper bound of the number of solutions inverse() returns
+			static const size_t MAX_IK_SOLUTIONS = 16;
+
+			/**
+			* All joint configurations which put jaco_gripper_tool_frame at tool, angles in [-pi, pi].
+			* The wrist of the jaco is not spherical: the axes 4/5 and 5/6 intersect in two points
+			* whose distance is fixed. The second point follows from the target, the first lies on a
+			* cone around axis 6 parametrized by q6, so q1..q3 are solved in closed form for every q6
+			* and q6 is found as the roots of the remaining angle constraint between axis 4 and 5.
+			* Every solution is polished with a few Newton steps on the full chain.
+			* @return number of solutions written to solutions, 0 if the pose is not reachable.
+			*/
+			static size_t inverse(const JacoFrame& tool, double solutions[][NUM_JOINTS], size_t max_solutions = MAX_IK_SOLUTIONS);
+
+			// x, y, z and euler angles with R = Rx(pose[3]) * Ry(pose[4]) * Rz(pose[5])
+			static void toPose(const JacoFrame& frame, double pose[6]);
+			static void fromPose(const double pose[6], JacoFrame& frame);
+
+			// x, y, z, w
+			static void toQuaternion(const JacoFrame& frame, double quaternion[4]);
+			static void fromQuaternion(const double position[3], const double quaternion[4], JacoFrame& frame);
+
+			// fixed transform of the urdf joint in front of joint (0 based) and the sign of its z axis
+			static void jointOrigin(size_t joint, JacoFrame& origin, double& axis);
+
+			// jaco_gripper_tool_frame in jaco_link_6
+			static void toolOrigin(JacoFrame& origin);
+
+			static void identity(JacoFrame& frame);
+
+			// out = a * b, out may not alias a or b
+			static void multiply(const JacoFrame& a, const JacoFrame& b, JacoFrame& out);
+	};
+}
+
+#endif /* JACO_KINEMATICS_H_ */
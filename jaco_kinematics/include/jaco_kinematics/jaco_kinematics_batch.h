@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_kinematics_batch.h
+ *
+ *  PURPOSE ---  Kinematics of many joint configurations or poses per call, structure of arrays
+ */
+
+#ifndef JACO_KINEMATICS_BATCH_H_
+#define JACO_KINEMATICS_BATCH_H_
+
+#include <jaco_kinematics/jaco_kinematics.h>
+
+namespace kinova
+{
+	/**
+	*  Batched versions of JacoKinematics::forward() and JacoKinematics::inverse(). All arrays
+	*  are structure of arrays: value k of sample i is array[k][i], so the same value of
+	*  neighbouring samples is contiguous. Frames have FRAME_ELEMENTS arrays, the rotation row
+	*  major followed by the position, just like JacoFrame.
+	*/
+	class JacoKinematicsBatch
+	{
+		public:
+			static const size_t FRAME_ELEMENTS = 12;
+
+			// index of the position in the frame arrays
+			static const size_t POSITION = 9;
+
+			/**
+			* Pose of jaco_gripper_tool_frame in jaco_base_link for count joint configurations.
+			* Two configurations are computed at once with SSE2 where the compiler provides it.
+			*/
+			static void forward(size_t count, const double * const q[JacoKinematics::NUM_JOINTS], double * const tool[FRAME_ELEMENTS]);
+
+			/**
+			* One solution of the inverse kinematics for each of count poses. With seed the one
+			* closest to seed (same layout as q) is returned, otherwise the first one found, angles in [-pi, pi].
+			* solution_count[i] is the number of solutions of pose i, 0 if it is not reachable,
+			* q is not written for that pose then. seed may be NULL.
+			* The root search of every pose takes its own path, so this is a loop over
+			* JacoKinematics::inverse(), not SIMD.
+			* @return number of reachable poses
+			*/
+			static size_t inverse(size_t count, const double * const tool[FRAME_ELEMENTS], const double * const seed[JacoKinematics::NUM_JOINTS],
+					      double * const q[JacoKinematics::NUM_JOINTS], unsigned char *solution_count);
+	};
+}
+
+#endif /* JACO_KINEMATICS_BATCH_H_ */
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_kinematics_plugin.h
+ *
+ *  PURPOSE ---  MoveIt kinematics plugin for the arm group based on JacoKinematics::inverse()
+ */
+
+#ifndef JACO_KINEMATICS_PLUGIN_H_
+#define JACO_KINEMATICS_PLUGIN_H_
+
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <geometry_msgs/Pose.h>
+#include <moveit_msgs/MoveItErrorCodes.h>
+#include <moveit/kinematics_base/kinematics_base.h>
+#include <jaco_kinematics/jaco_kinematics.h>
+
+namespace kinova
+{
+	/**
+	*  Solves the chain jaco_base_link -> jaco_gripper_tool_frame. All solution branches are
+	*  enumerated on every call, so the timeout and the search discretization are not used; the
+	*  solutions are tried in the order of their distance to the seed.
+	*/
+	class JacoKinematicsPlugin : public kinematics::KinematicsBase
+	{
+		public:
+			JacoKinematicsPlugin();
+
+			virtual bool getPositionIK(const geometry_msgs::Pose &ik_pose,
+						   const std::vector<double> &ik_seed_state,
+						   std::vector<double> &solution,
+						   moveit_msgs::MoveItErrorCodes &error_code,
+						   const kinematics::KinematicsQueryOptions &options = kinematics::KinematicsQueryOptions()) const;
+
+			virtual bool searchPositionIK(const geometry_msgs::Pose &ik_pose,
+						      const std::vector<double> &ik_seed_state,
+						      double timeout,
+						      std::vector<double> &solution,
+						      moveit_msgs::MoveItErrorCodes &error_code,
+						      const kinematics::KinematicsQueryOptions &options = kinematics::KinematicsQueryOptions()) const;
+
+			virtual bool searchPositionIK(const geometry_msgs::Pose &ik_pose,
+						      const std::vector<double> &ik_seed_state,
+						      double timeout,
+						      const std::vector<double> &consistency_limits,
+						      std::vector<double> &solution,
+						      moveit_msgs::MoveItErrorCodes &error_code,
+						      const kinematics::KinematicsQueryOptions &options = kinematics::KinematicsQueryOptions()) const;
+
+			virtual bool searchPositionIK(const geometry_msgs::Pose &ik_pose,
+						      const std::vector<double> &ik_seed_state,
+						      double timeout,
+						      std::vector<double> &solution,
+						      const IKCallbackFn &solution_callback,
+						      moveit_msgs::MoveItErrorCodes &error_code,
+						      const kinematics::KinematicsQueryOptions &options = kinematics::KinematicsQueryOptions()) const;
+
+			virtual bool searchPositionIK(const geometry_msgs::Pose &ik_pose,
+						      const std::vector<double> &ik_seed_state,
+						      double timeout,
+						      const std::vector<double> &consistency_limits,
+						      std::vector<double> &solution,
+						      const IKCallbackFn &solution_callback,
+						      moveit_msgs::MoveItErrorCodes &error_code,
+						      const kinematics::KinematicsQueryOptions &options = kinematics::KinematicsQueryOptions()) const;
+
+			virtual bool getPositionFK(const std::vector<std::string> &link_names,
+						   const std::vector<double> &joint_angles,
+						   std::vector<geometry_msgs::Pose> &poses) const;
+
+			virtual bool initialize(const std::string& robot_description,
+						const std::string& group_name,
+						const std::string& base_frame,
+						const std::string& tip_frame,
+						double search_discretization);
+
+			virtual const std::vector<std::string>& getJointNames() const;
+			virtual const std::vector<std::string>& getLinkNames() const;
+
+		private:
+			bool solve(const geometry_msgs::Pose &ik_pose,
+				   const std::vector<double> &ik_seed_state,
+				   const std::vector<double> *consistency_limits,
+				   std::vector<double> &solution,
+				   const IKCallbackFn *solution_callback,
+				   moveit_msgs::MoveItErrorCodes &error_code) const;
+
+			// moves q into the joint limits, continuous joints as close as possible to the seed
+			bool applyLimits(double q[JacoKinematics::NUM_JOINTS], const std::vector<double> &seed) const;
+
+			std::vector<std::string> joint_names_;
+			std::vector<std::string> link_names_;
+			std::vector<bool> continuous_;
+			std::vector<double> lower_, upper_;
+			bool active_;
+	};
+}
+
+#endif /* JACO_KINEMATICS_PLUGIN_H_ */
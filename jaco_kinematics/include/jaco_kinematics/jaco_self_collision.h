@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_self_collision.h
+ *
+ *  PURPOSE ---  Self collision check of the arm with one capsule per link
+ */
+
+#ifndef JACO_SELF_COLLISION_H_
+#define JACO_SELF_COLLISION_H_
+
+#include <jaco_kinematics/jaco_kinematics.h>
+
+namespace kinova
+{
+	/// \brief Segment a - b swept by a sphere of radius, in the frame of a link.
+	struct JacoCapsule
+	{
+		const char *link;
+		size_t frame;		// 0 for jaco_base_link, i for jaco_link_i
+		double a[3];
+		double b[3];
+		double radius;
+	};
+
+	/**
+	*  Capsules enclosing the collision meshes of the urdf: jaco_base_link, jaco_link_1 ..
+	*  jaco_link_5, and the hand with the fingers open or closed on jaco_link_6. Only the pairs
+	*  that are not adjacent and not disabled as "Never" in the srdf of jaco_moveit_config are
+	*  checked. A check is one JacoKinematics::linkFrames() and a segment distance per pair,
+	*  about a microsecond.
+	*/
+	class JacoSelfCollision
+	{
+		public:
+			static const size_t NUM_CAPSULES = 7;
+			static const size_t NUM_PAIRS = 11;
+
+			static const JacoCapsule& capsule(size_t index);
+
+			// the two capsules of pair index
+			static void pair(size_t index, size_t& first, size_t& second);
+
+			/**
+			* Smallest distance between the surfaces of the checked capsules [m], negative if
+			* they overlap. closest_pair is set to the pair it was found for, it may be NULL.
+			*/
+			static double clearance(const double q[JacoKinematics::NUM_JOINTS], size_t *closest_pair = NULL);
+
+			/**
+			* Whether the straight joint space motion from q0 to q1 keeps a clearance of at least
+			* margin. The motion is followed by conservative advancement: the distance of a pair
+			* shrinks at most by the sum over the joints between its links of the lever arm times
+			* the joint motion, so every step is as long as the clearance allows and no collision
+			* can be skipped. A motion coming within MIN_ADVANCEMENT (1 mm) of the margin is taken
+			* as not clear, so it is conservative by up to that much. Sets first_contact (0 .. 1
+			* along the motion) if not.
+			*/
+			static bool motionClear(const double q0[JacoKinematics::NUM_JOINTS], const double q1[JacoKinematics::NUM_JOINTS],
+						double margin, double *first_contact = NULL);
+	};
+}
+
+#endif /* JACO_SELF_COLLISION_H_ */
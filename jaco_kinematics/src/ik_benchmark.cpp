@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- ik_benchmark.cpp
+ *
+ *  PURPOSE ---  Compares the jaco kinematics plugin with the KDL plugin on random reachable poses,
+ *               start it with launch/ik_benchmark.launch
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+#include <ros/ros.h>
+#include <pluginlib/class_loader.h>
+#include <moveit/kinematics_base/kinematics_base.h>
+#include <jaco_kinematics/jaco_kinematics.h>
+#include <jaco_kinematics/jaco_kinematics_batch.h>
+
+using namespace kinova;
+
+namespace
+{
+	struct Result
+	{
+		std::string name;
+		std::vector<double> times;	// [us]
+		int solved;
+		double max_error;		// forward kinematics of the solution against the pose [m]
+
+		Result(const std::string& name) : name(name), solved(0), max_error(0.0) {}
+
+		void print(int samples)
+		{
+			std::sort(times.begin(), times.end());
+			double sum = 0.0;
+			for (size_t i = 0; i < times.size(); i++)
+				sum += times[i];
+
+			std::cout << std::setw(28) << std::left << name
+				  << " solved " << std::setw(6) << std::right << solved << " / " << samples
+				  << "   mean " << std::setw(10) << std::fixed << std::setprecision(1) << sum / times.size() << " us"
+				  << "   median " << std::setw(10) << times[times.size() / 2] << " us"
+				  << "   max " << std::setw(10) << times.back() << " us"
+				  << "   max error " << std::scientific << std::setprecision(2) << max_error << std::endl;
+		}
+	};
+
+	double randomAngle()
+	{
+		return (2.0 * rand() / RAND_MAX - 1.0) * M_PI;
+	}
+
+	double positionError(const JacoFrame& target, const std::vector<double>& q)
+	{
+		JacoFrame tool;
+		JacoKinematics::forward(&q[0], tool);
+
+		double error = 0.0;
+		for (int i = 0; i < 3; i++)
+			error = std::max(error, fabs(tool.p[i] - target.p[i]));
+		return error;
+	}
+
+	// like RobotState::setFromIK: up to attempts calls with random seeds
+	void runPlugin(const kinematics::KinematicsBase& solver, const std::vector<geometry_msgs::Pose>& poses, const std::vector<JacoFrame>& targets,
+		       double timeout, int attempts, Result& result)
+	{
+		for (size_t i = 0; i < poses.size(); i++)
+		{
+			std::vector<double> seed(JacoKinematics::NUM_JOINTS), solution;
+			moveit_msgs::MoveItErrorCodes error_code;
+			bool solved = false;
+
+			ros::WallTime start = ros::WallTime::now();
+			for (int attempt = 0; attempt < attempts && !solved; attempt++)
+			{
+				for (size_t j = 0; j < seed.size(); j++)
+					seed[j] = randomAngle();
+				solved = solver.searchPositionIK(poses[i], seed, timeout, solution, error_code);
+			}
+			result.times.push_back((ros::WallTime::now() - start).toSec() * 1e6);
+
+			if (solved)
+			{
+				result.solved++;
+				result.max_error = std::max(result.max_error, positionError(targets[i], solution));
+			}
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	ros::init(argc, argv, "jaco_ik_benchmark");
+	ros::NodeHandle pn("~");
+
+	int samples, attempts, seed;
+	double timeout;
+	std::string group, base_frame, tip_frame;
+	pn.param("samples", samples, 1000);
+	pn.param("timeout", timeout, 0.005);		// as in jaco_moveit_config/config/kinematics.yaml
+	pn.param("attempts", attempts, 3);
+	pn.param("seed", seed, 1);
+	pn.param("group", group, std::string("arm"));
+	pn.param("base_frame", base_frame, std::string("jaco_base_link"));
+	pn.param("tip_frame", tip_frame, std::string("jaco_gripper_tool_frame"));
+
+	srand(seed);
+
+	pluginlib::ClassLoader<kinematics::KinematicsBase> loader("moveit_core", "kinematics::KinematicsBase");
+	boost::shared_ptr<kinematics::KinematicsBase> kdl, jaco;
+	try
+	{
+		kdl = loader.createInstance("kdl_kinematics_plugin/KDLKinematicsPlugin");
+		jaco = loader.createInstance("jaco_kinematics/JacoKinematicsPlugin");
+	}
+	catch (pluginlib::PluginlibException& e)
+	{
+		ROS_ERROR("Could not load the kinematics plugins: %s", e.what());
+		return 1;
+	}
+
+	if (!kdl->initialize("robot_description", group, base_frame, tip_frame, 0.005) ||
+	    !jaco->initialize("robot_description", group, base_frame, tip_frame, 0.005))
+	{
+		ROS_ERROR("Could not initialise the kinematics plugins");
+		return 1;
+	}
+
+	// random joint angles, so every pose is reachable; the plugins have to agree on their FK
+	std::vector<geometry_msgs::Pose> poses(samples);
+	std::vector<JacoFrame> targets(samples);
+	std::vector<double> joint_angles(JacoKinematics::NUM_JOINTS * samples);	// structure of arrays for JacoKinematicsBatch
+	std::vector<std::string> tip(1, tip_frame);
+	double fk_difference = 0.0;
+
+	for (int i = 0; i < samples; i++)
+	{
+		std::vector<double> q(JacoKinematics::NUM_JOINTS);
+		for (size_t j = 0; j < q.size(); j++)
+		{
+			q[j] = randomAngle();
+			joint_angles[j * samples + i] = q[j];
+		}
+
+		std::vector<geometry_msgs::Pose> kdl_pose, jaco_pose;
+		kdl->getPositionFK(tip, q, kdl_pose);
+		jaco->getPositionFK(tip, q, jaco_pose);
+
+		fk_difference = std::max(fk_difference, fabs(kdl_pose[0].position.x - jaco_pose[0].position.x));
+		fk_difference = std::max(fk_difference, fabs(kdl_pose[0].position.y - jaco_pose[0].position.y));
+		fk_difference = std::max(fk_difference, fabs(kdl_pose[0].position.z - jaco_pose[0].position.z));
+
+		poses[i] = kdl_pose[0];
+		JacoKinematics::forward(&q[0], targets[i]);
+	}
+
+	std::cout << "largest difference of the forward kinematics of both plugins: " << std::scientific << fk_difference << " m" << std::endl;
+
+	// forward kinematics of all samples, one call per sample through KDL against one batch call
+	double *q_rows[JacoKinematics::NUM_JOINTS], *frame_rows[JacoKinematicsBatch::FRAME_ELEMENTS];
+	std::vector<double> frame_data(JacoKinematicsBatch::FRAME_ELEMENTS * samples);
+	for (size_t j = 0; j < JacoKinematics::NUM_JOINTS; j++)
+		q_rows[j] = &joint_angles[j * samples];
+	for (size_t k = 0; k < JacoKinematicsBatch::FRAME_ELEMENTS; k++)
+		frame_rows[k] = &frame_data[k * samples];
+
+	ros::WallTime start = ros::WallTime::now();
+	for (int i = 0; i < samples; i++)
+	{
+		std::vector<double> q(JacoKinematics::NUM_JOINTS);
+		for (size_t j = 0; j < q.size(); j++)
+			q[j] = q_rows[j][i];
+
+		std::vector<geometry_msgs::Pose> kdl_pose;
+		kdl->getPositionFK(tip, q, kdl_pose);
+	}
+	double kdl_fk_time = (ros::WallTime::now() - start).toSec();
+
+	start = ros::WallTime::now();
+	JacoKinematicsBatch::forward(samples, q_rows, frame_rows);
+	double batch_fk_time = (ros::WallTime::now() - start).toSec();
+
+	std::cout << "forward kinematics per sample: KDLKinematicsPlugin " << std::fixed << std::setprecision(3) << kdl_fk_time / samples * 1e6
+		  << " us, JacoKinematicsBatch " << batch_fk_time / samples * 1e6 << " us" << std::endl;
+
+	Result kdl_result("KDLKinematicsPlugin"), jaco_result("JacoKinematicsPlugin"), all_result("JacoKinematics::inverse");
+	runPlugin(*kdl, poses, targets, timeout, attempts, kdl_result);
+	runPlugin(*jaco, poses, targets, timeout, 1, jaco_result);
+
+	// the library alone, returning every branch
+	double solutions[JacoKinematics::MAX_IK_SOLUTIONS][JacoKinematics::NUM_JOINTS];
+	size_t branches = 0;
+	for (int i = 0; i < samples; i++)
+	{
+		ros::WallTime start = ros::WallTime::now();
+		size_t count = JacoKinematics::inverse(targets[i], solutions);
+		all_result.times.push_back((ros::WallTime::now() - start).toSec() * 1e6);
+
+		branches += count;
+		if (count > 0)
+			all_result.solved++;
+		for (size_t j = 0; j < count; j++)
+			all_result.max_error = std::max(all_result.max_error, positionError(targets[i], std::vector<double>(solutions[j], solutions[j] + JacoKinematics::NUM_JOINTS)));
+	}
+
+	// the batch version, closest solution to the sampled configuration
+	std::vector<double> batch_solutions(JacoKinematics::NUM_JOINTS * samples);
+	std::vector<unsigned char> solution_count(samples);
+	double *solution_rows[JacoKinematics::NUM_JOINTS];
+	for (size_t j = 0; j < JacoKinematics::NUM_JOINTS; j++)
+		solution_rows[j] = &batch_solutions[j * samples];
+
+	start = ros::WallTime::now();
+	size_t batch_solved = JacoKinematicsBatch::inverse(samples, frame_rows, q_rows, solution_rows, &solution_count[0]);
+	double batch_ik_time = (ros::WallTime::now() - start).toSec();
+
+	kdl_result.print(samples);
+	jaco_result.print(samples);
+	all_result.print(samples);
+	std::cout << "solutions per pose: " << std::fixed << std::setprecision(2) << (double)branches / samples << std::endl;
+	std::cout << "JacoKinematicsBatch::inverse solved " << batch_solved << " / " << samples << " in "
+		  << std::setprecision(1) << batch_ik_time / samples * 1e6 << " us per pose" << std::endl;
+
+	return 0;
+}
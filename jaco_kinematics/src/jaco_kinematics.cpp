@@ -0,0 +1,926 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_kinematics.cpp
+ *
+ *  PURPOSE ---  Analytic kinematics of the jaco arm
+ */
+
+#include <jaco_kinematics/jaco_kinematics.h>
+
+#include <math.h>
+#include <algorithm>
+
+namespace kinova
+{
+	const size_t JacoKinematics::NUM_JOINTS;
+	const size_t JacoKinematics::NUM_FRAMES;
+	const size_t JacoKinematics::MAX_IK_SOLUTIONS;
+
+	namespace
+	{
+		// <origin> of a urdf joint and the sign of its z axis
+		struct JointOrigin
+		{
+			double xyz[3];
+			double rpy[3];
+			double axis;
+		};
+
+		// has to be kept in sync with jaco_description/urdf/gazebo/jaco.urdf
+		const JointOrigin JOINT_ORIGINS[JacoKinematics::NUM_JOINTS] =
+		{
+			{ { 0.0, 0.0, 0.2725 },				{ 0.0, 0.0, 0.0 },			-1.0 },	// jaco_joint_1
+			{ { 0.0, 0.0, 0.0 },				{ -1.570796327, 0.0, 0.0 },		 1.0 },	// jaco_joint_2
+			{ { 0.4100, 0.0, 0.012 },			{ 0.0, 0.0, 0.0 },			-1.0 },	// jaco_joint_3
+			{ { 0.0, 0.24927682300748782, 0.0 },		{ -1.570796327, 0.0, 0.0 },		-1.0 },	// jaco_joint_4
+			{ { 0.0, -0.069262292, 0.048497979 },		{ 0.959931089, 0.0, 0.0 },		-1.0 },	// jaco_joint_5
+			{ { 0.0, -0.186174274, 0.13036063 },		{ -0.959931089, 0.0, 3.1415926535897931 }, -1.0 }	// jaco_joint_6
+		};
+
+		// jaco_gripper_attach_joint is the identity, so this is the tool frame in jaco_link_6
+		const JointOrigin TOOL_ORIGIN = { { 0.0, 0.0, -0.08 }, { 0.17, -1.570796327, 1.570796327 }, 0.0 };
+
+		void originToFrame(const JointOrigin& origin, JacoFrame& frame)
+		{
+			// urdf: R = Rz(yaw) * Ry(pitch) * Rx(roll)
+			double sr = sin(origin.rpy[0]), cr = cos(origin.rpy[0]);
+			double sp = sin(origin.rpy[1]), cp = cos(origin.rpy[1]);
+			double sy = sin(origin.rpy[2]), cy = cos(origin.rpy[2]);
+
+			frame.R[0] = cy*cp;	frame.R[1] = cy*sp*sr - sy*cr;	frame.R[2] = cy*sp*cr + sy*sr;
+			frame.R[3] = sy*cp;	frame.R[4] = sy*sp*sr + cy*cr;	frame.R[5] = sy*sp*cr - cy*sr;
+			frame.R[6] = -sp;	frame.R[7] = cp*sr;		frame.R[8] = cp*cr;
+
+			for (int i = 0; i < 3; i++)
+				frame.p[i] = origin.xyz[i];
+		}
+
+		// the joint origins as transforms, computed once
+		struct ChainTables
+		{
+			JacoFrame joints[JacoKinematics::NUM_JOINTS];
+			JacoFrame tool;
+
+			ChainTables()
+			{
+				for (size_t i = 0; i < JacoKinematics::NUM_JOINTS; i++)
+					originToFrame(JOINT_ORIGINS[i], joints[i]);
+				originToFrame(TOOL_ORIGIN, tool);
+			}
+		};
+
+		const ChainTables& tables()
+		{
+			static const ChainTables chain;
+			return chain;
+		}
+
+		// out = parent * origin * Rz(angle), only the first two columns of the rotation change with the joint
+		inline void jointStep(const JacoFrame& parent, const JacoFrame& origin, double angle, JacoFrame& out)
+		{
+			JacoKinematics::multiply(parent, origin, out);
+
+			double s = sin(angle), c = cos(angle);
+			for (int row = 0; row < 3; row++)
+			{
+				double x = out.R[3*row], y = out.R[3*row + 1];
+				out.R[3*row]     =  c*x + s*y;
+				out.R[3*row + 1] = -s*x + c*y;
+			}
+		}
+	}
+
+	void JacoKinematics::jointOrigin(size_t joint, JacoFrame& origin, double& axis)
+	{
+		origin = tables().joints[joint];
+		axis = JOINT_ORIGINS[joint].axis;
+	}
+
+	void JacoKinematics::toolOrigin(JacoFrame& origin)
+	{
+		origin = tables().tool;
+	}
+
+	void JacoKinematics::identity(JacoFrame& frame)
+	{
+		for (int i = 0; i < 9; i++)
+			frame.R[i] = (i % 4 == 0) ? 1.0 : 0.0;
+		frame.p[0] = frame.p[1] = frame.p[2] = 0.0;
+	}
+
+	void JacoKinematics::multiply(const JacoFrame& a, const JacoFrame& b, JacoFrame& out)
+	{
+		for (int row = 0; row < 3; row++)
+		{
+			const double *ar = &a.R[3*row];
+			for (int col = 0; col < 3; col++)
+				out.R[3*row + col] = ar[0]*b.R[col] + ar[1]*b.R[3 + col] + ar[2]*b.R[6 + col];
+
+			out.p[row] = ar[0]*b.p[0] + ar[1]*b.p[1] + ar[2]*b.p[2] + a.p[row];
+		}
+	}
+
+	void JacoKinematics::linkFrames(const double q[NUM_JOINTS], JacoFrame frames[NUM_FRAMES])
+	{
+		const ChainTables& chain = tables();
+
+		JacoFrame base;
+		identity(base);
+
+		const JacoFrame *parent = &base;
+		for (size_t i = 0; i < NUM_JOINTS; i++)
+		{
+			jointStep(*parent, chain.joints[i], JOINT_ORIGINS[i].axis * q[i], frames[i]);
+			parent = &frames[i];
+		}
+
+		multiply(*parent, chain.tool, frames[NUM_JOINTS]);
+	}
+
+	void JacoKinematics::forward(const double q[NUM_JOINTS], JacoFrame& tool)
+	{
+		const ChainTables& chain = tables();
+
+		// the first joint origin is a pure translation along z
+		JacoFrame a, b;
+		identity(a);
+		a.p[2] = chain.joints[0].p[2];
+		double s = sin(JOINT_ORIGINS[0].axis * q[0]), c = cos(JOINT_ORIGINS[0].axis * q[0]);
+		a.R[0] = c;	a.R[1] = -s;
+		a.R[3] = s;	a.R[4] = c;
+
+		jointStep(a, chain.joints[1], JOINT_ORIGINS[1].axis * q[1], b);
+		jointStep(b, chain.joints[2], JOINT_ORIGINS[2].axis * q[2], a);
+		jointStep(a, chain.joints[3], JOINT_ORIGINS[3].axis * q[3], b);
+		jointStep(b, chain.joints[4], JOINT_ORIGINS[4].axis * q[4], a);
+		jointStep(a, chain.joints[5], JOINT_ORIGINS[5].axis * q[5], b);
+
+		multiply(b, chain.tool, tool);
+	}
+
+	void JacoKinematics::toPose(const JacoFrame& frame, double pose[6])
+	{
+		pose[0] = frame.p[0];
+		pose[1] = frame.p[1];
+		pose[2] = frame.p[2];
+
+		// R = Rx(a) * Ry(b) * Rz(c): R02 = sin(b), R12 = -sin(a)cos(b), R22 = cos(a)cos(b), R01 = -cos(b)sin(c), R00 = cos(b)cos(c)
+		double sb = frame.R[2];
+		if (sb > 1.0) sb = 1.0;
+		if (sb < -1.0) sb = -1.0;
+
+		pose[4] = asin(sb);
+		if (fabs(sb) < 1.0 - 1e-12)
+		{
+			pose[3] = atan2(-frame.R[5], frame.R[8]);
+			pose[5] = atan2(-frame.R[1], frame.R[0]);
+		}
+		else
+		{
+			// gimbal lock, only a +- c is defined
+			pose[3] = atan2(frame.R[7], frame.R[4]);
+			pose[5] = 0.0;
+		}
+	}
+
+	void JacoKinematics::fromPose(const double pose[6], JacoFrame& frame)
+	{
+		double sa = sin(pose[3]), ca = cos(pose[3]);
+		double sb = sin(pose[4]), cb = cos(pose[4]);
+		double sc = sin(pose[5]), cc = cos(pose[5]);
+
+		frame.R[0] = cb*cc;		frame.R[1] = -cb*sc;		frame.R[2] = sb;
+		frame.R[3] = ca*sc + sa*sb*cc;	frame.R[4] = ca*cc - sa*sb*sc;	frame.R[5] = -sa*cb;
+		frame.R[6] = sa*sc - ca*sb*cc;	frame.R[7] = sa*cc + ca*sb*sc;	frame.R[8] = ca*cb;
+
+		frame.p[0] = pose[0];
+		frame.p[1] = pose[1];
+		frame.p[2] = pose[2];
+	}
+
+	void JacoKinematics::toQuaternion(const JacoFrame& frame, double quaternion[4])
+	{
+		const double *R = frame.R;
+		double trace = R[0] + R[4] + R[8];
+
+		if (trace > 0.0)
+		{
+			double s = 0.5 / sqrt(trace + 1.0);
+			quaternion[3] = 0.25 / s;
+			quaternion[0] = (R[7] - R[5]) * s;
+			quaternion[1] = (R[2] - R[6]) * s;
+			quaternion[2] = (R[3] - R[1]) * s;
+		}
+		else if (R[0] > R[4] && R[0] > R[8])
+		{
+			double s = 2.0 * sqrt(1.0 + R[0] - R[4] - R[8]);
+			quaternion[3] = (R[7] - R[5]) / s;
+			quaternion[0] = 0.25 * s;
+			quaternion[1] = (R[1] + R[3]) / s;
+			quaternion[2] = (R[2] + R[6]) / s;
+		}
+		else if (R[4] > R[8])
+		{
+			double s = 2.0 * sqrt(1.0 + R[4] - R[0] - R[8]);
+			quaternion[3] = (R[2] - R[6]) / s;
+			quaternion[0] = (R[1] + R[3]) / s;
+			quaternion[1] = 0.25 * s;
+			quaternion[2] = (R[5] + R[7]) / s;
+		}
+		else
+		{
+			double s = 2.0 * sqrt(1.0 + R[8] - R[0] - R[4]);
+			quaternion[3] = (R[3] - R[1]) / s;
+			quaternion[0] = (R[2] + R[6]) / s;
+			quaternion[1] = (R[5] + R[7]) / s;
+			quaternion[2] = 0.25 * s;
+		}
+	}
+
+	void JacoKinematics::fromQuaternion(const double position[3], const double quaternion[4], JacoFrame& frame)
+	{
+		double x = quaternion[0], y = quaternion[1], z = quaternion[2], w = quaternion[3];
+		double n = x*x + y*y + z*z + w*w;
+		double s = (n > 0.0) ? 2.0 / n : 0.0;
+
+		frame.R[0] = 1.0 - s*(y*y + z*z);	frame.R[1] = s*(x*y - w*z);		frame.R[2] = s*(x*z + w*y);
+		frame.R[3] = s*(x*y + w*z);		frame.R[4] = 1.0 - s*(x*x + z*z);	frame.R[5] = s*(y*z - w*x);
+		frame.R[6] = s*(x*z - w*y);		frame.R[7] = s*(y*z + w*x);		frame.R[8] = 1.0 - s*(x*x + y*y);
+
+		frame.p[0] = position[0];
+		frame.p[1] = position[1];
+		frame.p[2] = position[2];
+	}
+
+	namespace
+	{
+		void jacobianOfFrames(const JacoFrame frames[JacoKinematics::NUM_FRAMES], double J[6 * JacoKinematics::NUM_JOINTS])
+		{
+			const size_t NUM_JOINTS = JacoKinematics::NUM_JOINTS;
+			const double *tip = frames[NUM_JOINTS].p;
+			for (size_t i = 0; i < NUM_JOINTS; i++)
+			{
+				// joint i turns about the z axis of its link, in the direction of the urdf axis
+				double z[3] = { JOINT_ORIGINS[i].axis * frames[i].R[2], JOINT_ORIGINS[i].axis * frames[i].R[5], JOINT_ORIGINS[i].axis * frames[i].R[8] };
+				double r[3] = { tip[0] - frames[i].p[0], tip[1] - frames[i].p[1], tip[2] - frames[i].p[2] };
+
+				J[0*NUM_JOINTS + i] = z[1]*r[2] - z[2]*r[1];
+				J[1*NUM_JOINTS + i] = z[2]*r[0] - z[0]*r[2];
+				J[2*NUM_JOINTS + i] = z[0]*r[1] - z[1]*r[0];
+				J[3*NUM_JOINTS + i] = z[0];
+				J[4*NUM_JOINTS + i] = z[1];
+				J[5*NUM_JOINTS + i] = z[2];
+			}
+		}
+	}
+
+	void JacoKinematics::jacobian(const double q[NUM_JOINTS], double J[6 * NUM_JOINTS])
+	{
+		JacoFrame frames[NUM_FRAMES];
+		linkFrames(q, frames);
+		jacobianOfFrames(frames, J);
+	}
+
+	namespace
+	{
+		// sqrt(det(A A^T)) of the three rows of J starting at first_row
+		double rowManipulability(const double J[6 * JacoKinematics::NUM_JOINTS], int first_row)
+		{
+			const size_t NUM_JOINTS = JacoKinematics::NUM_JOINTS;
+			double M[9];
+			for (int a = 0; a < 3; a++)
+				for (int b = 0; b < 3; b++)
+				{
+					double sum = 0.0;
+					for (size_t k = 0; k < NUM_JOINTS; k++)
+						sum += J[(first_row + a)*NUM_JOINTS + k] * J[(first_row + b)*NUM_JOINTS + k];
+					M[3*a + b] = sum;
+				}
+
+			double det = M[0]*(M[4]*M[8] - M[5]*M[7]) - M[1]*(M[3]*M[8] - M[5]*M[6]) + M[2]*(M[3]*M[7] - M[4]*M[6]);
+			return (det > 0.0) ? sqrt(det) : 0.0;
+		}
+	}
+
+	double JacoKinematics::manipulability(const double J[6 * NUM_JOINTS], double& translational, double& rotational)
+	{
+		translational = rowManipulability(J, 0);
+		rotational = rowManipulability(J, 3);
+
+		// determinant by elimination with partial pivoting
+		double A[6 * NUM_JOINTS];
+		std::copy(J, J + 6 * NUM_JOINTS, A);
+
+		double det = 1.0;
+		for (size_t col = 0; col < NUM_JOINTS; col++)
+		{
+			size_t pivot = col;
+			for (size_t row = col + 1; row < 6; row++)
+				if (fabs(A[row*NUM_JOINTS + col]) > fabs(A[pivot*NUM_JOINTS + col]))
+					pivot = row;
+
+			if (A[pivot*NUM_JOINTS + col] == 0.0)
+				return 0.0;
+
+			if (pivot != col)
+				for (size_t k = 0; k < NUM_JOINTS; k++)
+					std::swap(A[col*NUM_JOINTS + k], A[pivot*NUM_JOINTS + k]);
+
+			det *= A[col*NUM_JOINTS + col];
+			for (size_t row = col + 1; row < 6; row++)
+			{
+				double factor = A[row*NUM_JOINTS + col] / A[col*NUM_JOINTS + col];
+				for (size_t k = col; k < NUM_JOINTS; k++)
+					A[row*NUM_JOINTS + k] -= factor * A[col*NUM_JOINTS + k];
+			}
+		}
+		return fabs(det);
+	}
+
+	namespace
+	{
+		// number of q6 samples the root search of the wrist constraint starts from
+		const int IK_Q6_SAMPLES = 64;
+		const int IK_ROOT_ITERATIONS = 40;
+		const int IK_BOUNDARY_ITERATIONS = 24;
+		const int IK_NEWTON_ITERATIONS = 8;
+
+		// solutions further away from the target are dropped [m, rad]
+		const double IK_TOLERANCE = 1e-6;
+
+		inline double sampleAngle(int i)
+		{
+			return -M_PI + 2.0 * M_PI * i / IK_Q6_SAMPLES;
+		}
+
+		inline double wrapAngle(double angle)
+		{
+			return angle - 2.0 * M_PI * floor((angle + M_PI) / (2.0 * M_PI));
+		}
+
+		// closest points of the lines p1 + t d1 and p2 + s d2
+		void closestPoints(const double p1[3], const double d1[3], const double p2[3], const double d2[3], double& t, double& s)
+		{
+			double w[3] = { p1[0] - p2[0], p1[1] - p2[1], p1[2] - p2[2] };
+			double a = d1[0]*d1[0] + d1[1]*d1[1] + d1[2]*d1[2];
+			double b = d1[0]*d2[0] + d1[1]*d2[1] + d1[2]*d2[2];
+			double c = d2[0]*d2[0] + d2[1]*d2[1] + d2[2]*d2[2];
+			double d = d1[0]*w[0] + d1[1]*w[1] + d1[2]*w[2];
+			double e = d2[0]*w[0] + d2[1]*w[1] + d2[2]*w[2];
+			double denominator = a*c - b*b;
+
+			t = (b*e - c*d) / denominator;
+			s = (a*e - b*d) / denominator;
+		}
+
+		/**
+		*  Constants of the wrist. Point A is where axis 4 meets axis 5, B where axis 5 meets axis 6
+		*  (both up to the rounding of the urdf origins, the Newton steps absorb the difference).
+		*/
+		struct WristTables
+		{
+			JacoFrame tool_inverse;		// jaco_link_6 in the tool frame
+			double b;			// B = (0, 0, b) in jaco_link_6
+			double length;			// B - A along the z axis of jaco_link_5
+			double axis5_in_link6[3];	// z axis of jaco_link_5 in jaco_link_6 at q6 = 0
+			double axis5_in_link4[3];	// z axis of jaco_link_5 in jaco_link_4 at q4 = 0
+			double cos45;			// cosine of the angle between the axes 4 and 5
+
+			// sin / cos of -axis6 * q6 for the q6 the root search starts from
+			double sample_sin[IK_Q6_SAMPLES], sample_cos[IK_Q6_SAMPLES];
+
+			// position of A as a 3R chain: height of the shoulder, upper arm, lateral offset, forearm
+			double shoulder, upper_arm, offset, forearm;
+
+			WristTables()
+			{
+				const ChainTables& chain = tables();
+				const JacoFrame& o4 = chain.joints[3];
+				const JacoFrame& o5 = chain.joints[4];
+				const JacoFrame& o6 = chain.joints[5];
+
+				// inverse of the fixed tool transform
+				for (int row = 0; row < 3; row++)
+					for (int col = 0; col < 3; col++)
+						tool_inverse.R[3*row + col] = chain.tool.R[3*col + row];
+				for (int row = 0; row < 3; row++)
+					tool_inverse.p[row] = -(tool_inverse.R[3*row]*chain.tool.p[0] + tool_inverse.R[3*row + 1]*chain.tool.p[1] + tool_inverse.R[3*row + 2]*chain.tool.p[2]);
+
+				double origin[3] = { 0.0, 0.0, 0.0 };
+				double z[3] = { 0.0, 0.0, 1.0 };
+
+				// axis 5 and 6 in jaco_link_5
+				double axis6[3] = { o6.R[2], o6.R[5], o6.R[8] };
+				double z5_b, s6;
+				closestPoints(origin, z, o6.p, axis6, z5_b, s6);
+				b = s6;
+
+				// axis 4 and 5 in jaco_link_4
+				double axis5[3] = { o5.R[2], o5.R[5], o5.R[8] };
+				double t4, z5_a;
+				closestPoints(origin, z, o5.p, axis5, t4, z5_a);
+				length = z5_b - z5_a;
+
+				for (int i = 0; i < 3; i++)
+				{
+					axis5_in_link6[i] = o6.R[6 + i];	// row 2 of R = R^T z
+					axis5_in_link4[i] = axis5[i];
+				}
+				cos45 = axis5[2];
+
+				shoulder = chain.joints[0].p[2];
+				upper_arm = chain.joints[2].p[0];
+				offset = chain.joints[2].p[2];
+				forearm = o4.p[1];
+
+				for (int i = 0; i < IK_Q6_SAMPLES; i++)
+				{
+					double angle = -JOINT_ORIGINS[5].axis * sampleAngle(i);
+					sample_sin[i] = sin(angle);
+					sample_cos[i] = cos(angle);
+				}
+			}
+		};
+
+		const WristTables& wristTables()
+		{
+			static const WristTables wrist;
+			return wrist;
+		}
+
+		/**
+		*  q1..q3 which put A (the origin of jaco_link_4) at a, for one of the four branches
+		*  (bit 0: arm in front of / behind the base, bit 1: elbow up / down). Derived from
+		*  base -> Rz(-q1) -> Rx(-pi/2) Rz(q2) -> (upper_arm, 0, offset) Rz(-q3) -> (0, forearm, 0).
+		*/
+		bool solveArm(const WristTables& wrist, const double a[3], int branch, double q[3])
+		{
+			double rho2 = a[0]*a[0] + a[1]*a[1];
+			double r2 = rho2 - wrist.offset * wrist.offset;
+			if (r2 < 0.0)
+				return false;
+
+			double r = (branch & 1) ? -sqrt(r2) : sqrt(r2);
+			double h = wrist.shoulder - a[2];
+
+			double k = (r*r + h*h - wrist.upper_arm*wrist.upper_arm - wrist.forearm*wrist.forearm) / (2.0 * wrist.upper_arm * wrist.forearm);
+			if (k < -1.0 || k > 1.0)
+				return false;
+
+			double q3 = asin(k);
+			if (branch & 2)
+				q3 = M_PI - q3;
+
+			double x = wrist.upper_arm + wrist.forearm * sin(q3);
+			double y = wrist.forearm * cos(q3);
+
+			q[0] = atan2(wrist.offset, r) - atan2(a[1], a[0]);
+			q[1] = atan2(h, r) - atan2(y, x);
+			q[2] = q3;
+			return true;
+		}
+
+		/**
+		*  The wrist constraint, cos(angle between axis 4 and axis 5) - cos45, for the branches
+		*  first..last of the arm which puts A at a, with u the direction of axis 5. Only the z axis
+		*  of jaco_link_4 is needed, (-c1 s23, s1 s23, -c23) with s23 = sin(q2 - q3). The angle sums
+		*  are done as products of unit complex numbers, so no trigonometric function is evaluated.
+		*  Whether A is reachable does not depend on the branch.
+		*/
+		inline bool armConstraint(const WristTables& wrist, const double a[3], const double u[3], int first, int last, double f[4])
+		{
+			double rho2 = a[0]*a[0] + a[1]*a[1];
+			double r2 = rho2 - wrist.offset * wrist.offset;
+			if (r2 < 0.0 || rho2 == 0.0)
+				return false;
+
+			double h = wrist.shoulder - a[2];
+			double n2 = r2 + h*h;
+
+			double k = (n2 - wrist.upper_arm*wrist.upper_arm - wrist.forearm*wrist.forearm) / (2.0 * wrist.upper_arm * wrist.forearm);
+			if (k < -1.0 || k > 1.0)
+				return false;
+
+			double root_r = sqrt(r2), root_k = sqrt(1.0 - k*k);
+			double inverse_n2 = 1.0 / n2, inverse_rho2 = 1.0 / rho2;
+
+			for (int branch = first; branch <= last; branch++)
+			{
+				double r = (branch & 1) ? -root_r : root_r;
+				double s3 = k;
+				double c3 = (branch & 2) ? -root_k : root_k;
+				double x = wrist.upper_arm + wrist.forearm * s3;
+				double y = wrist.forearm * c3;
+
+				// exp(i q2) = (r + i h) (x - i y) / n2, then times exp(-i q3)
+				double c2 = (r*x + h*y) * inverse_n2, s2 = (h*x - r*y) * inverse_n2;
+				double c23 = c2*c3 + s2*s3, s23 = s2*c3 - c2*s3;
+
+				// exp(i q1) = (r + i offset) (ax - i ay) / rho2
+				double c1 = (r*a[0] + wrist.offset*a[1]) * inverse_rho2, s1 = (wrist.offset*a[0] - r*a[1]) * inverse_rho2;
+
+				f[branch] = (-c1 * s23) * u[0] + (s1 * s23) * u[1] - c23 * u[2] - wrist.cos45;
+			}
+			return true;
+		}
+
+		/// \brief The wrist constraint as function of q6 for one target.
+		struct WristConstraint
+		{
+			const WristTables& wrist;
+			const JacoFrame& link6;
+			double b[3];			// point B in the base
+
+			WristConstraint(const WristTables& wrist, const JacoFrame& link6) : wrist(wrist), link6(link6)
+			{
+				for (int i = 0; i < 3; i++)
+					b[i] = link6.p[i] + wrist.b * link6.R[3*i + 2];
+			}
+
+			// point A for sin/cos of -axis6 * q6, and the direction of axis 5
+			inline void wristPoint(double s, double c, double a[3], double u[3]) const
+			{
+				// axis 5 in jaco_link_6: Rz(-axis6 * q6) applied to its direction at q6 = 0
+				const double *w = wrist.axis5_in_link6;
+				double u6[3] = { c*w[0] - s*w[1], s*w[0] + c*w[1], w[2] };
+
+				for (int i = 0; i < 3; i++)
+				{
+					u[i] = link6.R[3*i]*u6[0] + link6.R[3*i + 1]*u6[1] + link6.R[3*i + 2]*u6[2];
+					a[i] = b[i] - wrist.length * u[i];
+				}
+			}
+
+			// all four branches for sin/cos of -axis6 * q6, false if A is not reachable
+			inline bool evaluate(double s, double c, double f[4]) const
+			{
+				double a[3], u[3];
+				wristPoint(s, c, a, u);
+				return armConstraint(wrist, a, u, 0, 3, f);
+			}
+
+			bool evaluate(double q6, int branch, double& f) const
+			{
+				double angle = -JOINT_ORIGINS[5].axis * q6;
+				double a[3], u[3], f_branches[4];
+				wristPoint(sin(angle), cos(angle), a, u);
+
+				if (!armConstraint(wrist, a, u, branch, branch, f_branches))
+					return false;
+
+				f = f_branches[branch];
+				return true;
+			}
+
+			bool arm(double q6, int branch, double q[3]) const
+			{
+				double angle = -JOINT_ORIGINS[5].axis * q6;
+				double a[3], u[3];
+				wristPoint(sin(angle), cos(angle), a, u);
+				return solveArm(wrist, a, branch, q);
+			}
+		};
+
+		// q4 and q5 for known q1..q3 and q6
+		void solveWrist(const JacoFrame& link6, double q[JacoKinematics::NUM_JOINTS])
+		{
+			const ChainTables& chain = tables();
+			const WristTables& wrist = wristTables();
+
+			JacoFrame frames[4];
+			JacoFrame base;
+			JacoKinematics::identity(base);
+
+			const JacoFrame *parent = &base;
+			for (int i = 0; i < 3; i++)
+			{
+				jointStep(*parent, chain.joints[i], JOINT_ORIGINS[i].axis * q[i], frames[i]);
+				parent = &frames[i];
+			}
+
+			// axis 5 in the base, then in jaco_link_4 at q4 = 0
+			double angle6 = -JOINT_ORIGINS[5].axis * q[5];
+			double s = sin(angle6), c = cos(angle6);
+			const double *w = wrist.axis5_in_link6;
+			double u6[3] = { c*w[0] - s*w[1], s*w[0] + c*w[1], w[2] };
+			double u[3];
+			for (int i = 0; i < 3; i++)
+				u[i] = link6.R[3*i]*u6[0] + link6.R[3*i + 1]*u6[1] + link6.R[3*i + 2]*u6[2];
+
+			JacoFrame link4_zero;
+			JacoKinematics::multiply(frames[2], chain.joints[3], link4_zero);
+			double v[2];
+			for (int i = 0; i < 2; i++)
+				v[i] = link4_zero.R[i]*u[0] + link4_zero.R[3 + i]*u[1] + link4_zero.R[6 + i]*u[2];
+
+			const double *d = wrist.axis5_in_link4;
+			q[3] = JOINT_ORIGINS[3].axis * (atan2(v[1], v[0]) - atan2(d[1], d[0]));
+
+			// Rz(axis5 * q5) = (link4 * o5)^T * link6 * (o6 * Rz(axis6 * q6))^T, only its first column is needed
+			jointStep(frames[2], chain.joints[3], JOINT_ORIGINS[3].axis * q[3], frames[3]);
+			JacoFrame link5_zero, link6_rel, link6_q6;
+			JacoKinematics::multiply(frames[3], chain.joints[4], link5_zero);
+
+			JacoFrame rz6;
+			JacoKinematics::identity(rz6);
+			double angle = JOINT_ORIGINS[5].axis * q[5];
+			rz6.R[0] = cos(angle);	rz6.R[1] = -sin(angle);
+			rz6.R[3] = sin(angle);	rz6.R[4] = cos(angle);
+			JacoKinematics::multiply(chain.joints[5], rz6, link6_q6);
+
+			// link6_rel = link5_zero^T * link6 * link6_q6^T (rotation only)
+			double m[9];
+			for (int row = 0; row < 3; row++)
+				for (int col = 0; col < 3; col++)
+					m[3*row + col] = link5_zero.R[row]*link6.R[col] + link5_zero.R[3 + row]*link6.R[3 + col] + link5_zero.R[6 + row]*link6.R[6 + col];
+			for (int row = 0; row < 3; row++)
+				for (int col = 0; col < 3; col++)
+					link6_rel.R[3*row + col] = m[3*row]*link6_q6.R[3*col] + m[3*row + 1]*link6_q6.R[3*col + 1] + m[3*row + 2]*link6_q6.R[3*col + 2];
+
+			q[4] = JOINT_ORIGINS[4].axis * atan2(link6_rel.R[3], link6_rel.R[0]);
+		}
+
+		// solves J dq = e in place, false if J is singular
+		bool solve6(double J[36], double e[6])
+		{
+			for (int col = 0; col < 6; col++)
+			{
+				int pivot = col;
+				for (int row = col + 1; row < 6; row++)
+					if (fabs(J[6*row + col]) > fabs(J[6*pivot + col]))
+						pivot = row;
+
+				if (fabs(J[6*pivot + col]) < 1e-12)
+					return false;
+
+				if (pivot != col)
+				{
+					for (int k = 0; k < 6; k++)
+					{
+						double tmp = J[6*col + k]; J[6*col + k] = J[6*pivot + k]; J[6*pivot + k] = tmp;
+					}
+					double tmp = e[col]; e[col] = e[pivot]; e[pivot] = tmp;
+				}
+
+				for (int row = col + 1; row < 6; row++)
+				{
+					double factor = J[6*row + col] / J[6*col + col];
+					for (int k = col; k < 6; k++)
+						J[6*row + k] -= factor * J[6*col + k];
+					e[row] -= factor * e[col];
+				}
+			}
+
+			for (int row = 5; row >= 0; row--)
+			{
+				for (int k = row + 1; k < 6; k++)
+					e[row] -= J[6*row + k] * e[k];
+				e[row] /= J[6*row + row];
+			}
+			return true;
+		}
+
+		// position and orientation error of tool against target, in the base
+		double poseError(const JacoFrame& tool, const JacoFrame& target, double e[6])
+		{
+			for (int i = 0; i < 3; i++)
+				e[i] = target.p[i] - tool.p[i];
+
+			// small angle rotation vector of target * tool^T
+			double m[9];
+			for (int row = 0; row < 3; row++)
+				for (int col = 0; col < 3; col++)
+					m[3*row + col] = target.R[3*row]*tool.R[3*col] + target.R[3*row + 1]*tool.R[3*col + 1] + target.R[3*row + 2]*tool.R[3*col + 2];
+
+			e[3] = 0.5 * (m[7] - m[5]);
+			e[4] = 0.5 * (m[2] - m[6]);
+			e[5] = 0.5 * (m[3] - m[1]);
+
+			double error = 0.0;
+			for (int i = 0; i < 6; i++)
+				error = std::max(error, fabs(e[i]));
+
+			// the small angle approximation does not see a rotation by pi
+			if (m[0] + m[4] + m[8] < 1.0)
+				error = std::max(error, 1.0);
+			return error;
+		}
+
+		bool polish(double q[JacoKinematics::NUM_JOINTS], const JacoFrame& target)
+		{
+			JacoFrame frames[JacoKinematics::NUM_FRAMES];
+			double e[6], J[36];
+			double error = 1.0;
+
+			for (int iteration = 0; iteration < IK_NEWTON_ITERATIONS; iteration++)
+			{
+				JacoKinematics::linkFrames(q, frames);
+				error = poseError(frames[JacoKinematics::NUM_JOINTS], target, e);
+				if (error < 1e-10)
+					return true;
+
+				jacobianOfFrames(frames, J);
+				if (!solve6(J, e))
+					return false;
+
+				for (size_t i = 0; i < JacoKinematics::NUM_JOINTS; i++)
+					q[i] += e[i];
+			}
+
+			return error < IK_TOLERANCE;
+		}
+
+		// last q6 between reachable and unreachable for which A can still be reached, f there
+		double reachBoundary(const WristConstraint& constraint, int branch, double reachable, double unreachable, double& f)
+		{
+			constraint.evaluate(reachable, branch, f);
+			for (int iteration = 0; iteration < IK_BOUNDARY_ITERATIONS; iteration++)
+			{
+				double middle = 0.5 * (reachable + unreachable);
+				double f_middle;
+				if (constraint.evaluate(middle, branch, f_middle))
+				{
+					reachable = middle;
+					f = f_middle;
+				}
+				else
+					unreachable = middle;
+			}
+			return reachable;
+		}
+
+		// root of the wrist constraint between lo and hi, regula falsi (illinois variant)
+		bool findRoot(const WristConstraint& constraint, int branch, double lo, double f_lo, double hi, double f_hi, double& q6)
+		{
+			int side = 0;
+			q6 = lo;
+
+			for (int iteration = 0; iteration < IK_ROOT_ITERATIONS; iteration++)
+			{
+				double f_q6;
+				q6 = (lo * f_hi - hi * f_lo) / (f_hi - f_lo);
+				if (!constraint.evaluate(q6, branch, f_q6))
+					return false;
+				// the Newton steps on the whole chain take it from here
+				if (fabs(f_q6) < 1e-10)
+					break;
+
+				if ((f_q6 > 0.0) == (f_hi > 0.0))
+				{
+					hi = q6; f_hi = f_q6;
+					if (side == 1) f_lo *= 0.5;
+					side = 1;
+				}
+				else
+				{
+					lo = q6; f_lo = f_q6;
+					if (side == -1) f_hi *= 0.5;
+					side = -1;
+				}
+			}
+			return true;
+		}
+
+		// completes q for the root q6, appends it to solutions unless it does not converge or is known already
+		bool addSolution(const WristConstraint& constraint, int branch, const JacoFrame& link6, const JacoFrame& tool, double q6, double solutions[][JacoKinematics::NUM_JOINTS], size_t count)
+		{
+			double *q = solutions[count];
+			if (!constraint.arm(q6, branch, q))
+				return false;
+
+			q[5] = q6;
+			solveWrist(link6, q);
+
+			if (!polish(q, tool))
+				return false;
+
+			for (size_t j = 0; j < JacoKinematics::NUM_JOINTS; j++)
+				q[j] = wrapAngle(q[j]);
+
+			// neighbouring branches can converge to the same configuration
+			for (size_t k = 0; k < count; k++)
+			{
+				double distance = 0.0;
+				for (size_t j = 0; j < JacoKinematics::NUM_JOINTS; j++)
+					distance = std::max(distance, fabs(wrapAngle(solutions[k][j] - q[j])));
+				if (distance < 1e-6)
+					return false;
+			}
+			return true;
+		}
+	}
+
+	size_t JacoKinematics::inverse(const JacoFrame& tool, double solutions[][NUM_JOINTS], size_t max_solutions)
+	{
+		const WristTables& wrist = wristTables();
+
+		JacoFrame link6;
+		multiply(tool, wrist.tool_inverse, link6);
+
+		WristConstraint constraint(wrist, link6);
+
+		double f[IK_Q6_SAMPLES][4];
+		bool valid[IK_Q6_SAMPLES];
+		for (int i = 0; i < IK_Q6_SAMPLES; i++)
+			valid[i] = constraint.evaluate(wrist.sample_sin[i], wrist.sample_cos[i], f[i]);
+
+		size_t count = 0;
+		for (int branch = 0; branch < 4; branch++)
+		{
+			// sign changes between neighbouring samples, the samples wrap around at +-pi
+			for (int i = 0; i < IK_Q6_SAMPLES && count < max_solutions; i++)
+			{
+				int next = (i + 1) % IK_Q6_SAMPLES;
+				double lo = sampleAngle(i), hi = lo + 2.0 * M_PI / IK_Q6_SAMPLES;
+				double f_lo = f[i][branch], f_hi = f[next][branch];
+
+				if (!valid[i] && !valid[next])
+					continue;
+
+				// the elbow branches meet where A gets out of reach, a root can lie between the
+				// last sample and that boundary, where it continues on the other elbow branch
+				if (!valid[i])
+					lo = reachBoundary(constraint, branch, hi, lo, f_lo);
+				else if (!valid[next])
+					hi = reachBoundary(constraint, branch, lo, hi, f_hi);
+
+				if ((f_lo > 0.0) == (f_hi > 0.0))
+					continue;
+
+				double q6;
+				if (findRoot(constraint, branch, lo, f_lo, hi, f_hi, q6) && addSolution(constraint, branch, link6, tool, q6, solutions, count))
+					count++;
+			}
+		}
+
+		return count;
+	}
+
+	bool JacoKinematics::dampedLeastSquares(const double J[6 * NUM_JOINTS], const double twist[6], double damping, double qdot[NUM_JOINTS])
+	{
+		double A[36], y[6];
+		for (int row = 0; row < 6; row++)
+		{
+			for (int col = 0; col < 6; col++)
+			{
+				double sum = 0.0;
+				for (size_t k = 0; k < NUM_JOINTS; k++)
+					sum += J[row*NUM_JOINTS + k] * J[col*NUM_JOINTS + k];
+				A[6*row + col] = sum;
+			}
+			A[6*row + row] += damping * damping;
+			y[row] = twist[row];
+		}
+
+		if (!solve6(A, y))
+			return false;
+
+		for (size_t k = 0; k < NUM_JOINTS; k++)
+		{
+			qdot[k] = 0.0;
+			for (int row = 0; row < 6; row++)
+				qdot[k] += J[row*NUM_JOINTS + k] * y[row];
+		}
+		return true;
+	}
+
+	bool JacoKinematics::dampedWrench(const double J[6 * NUM_JOINTS], const double torques[NUM_JOINTS], double damping, double wrench[6])
+	{
+		double A[36];
+		for (int row = 0; row < 6; row++)
+		{
+			for (int col = 0; col < 6; col++)
+			{
+				double sum = 0.0;
+				for (size_t k = 0; k < NUM_JOINTS; k++)
+					sum += J[row*NUM_JOINTS + k] * J[col*NUM_JOINTS + k];
+				A[6*row + col] = sum;
+			}
+			A[6*row + row] += damping * damping;
+
+			wrench[row] = 0.0;
+			for (size_t k = 0; k < NUM_JOINTS; k++)
+				wrench[row] += J[row*NUM_JOINTS + k] * torques[k];
+		}
+
+		return solve6(A, wrench);
+	}
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_kinematics_batch.cpp
+ *
+ *  PURPOSE ---  Kinematics of many joint configurations or poses per call, structure of arrays
+ */
+
+#include <jaco_kinematics/jaco_kinematics_batch.h>
+
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace kinova
+{
+	const size_t JacoKinematicsBatch::FRAME_ELEMENTS;
+	const size_t JacoKinematicsBatch::POSITION;
+
+	namespace
+	{
+		const size_t NUM_JOINTS = JacoKinematics::NUM_JOINTS;
+
+		// sample i through the scalar code, for the odd sample at the end and machines without SSE2
+		void forwardOne(size_t i, const double * const q[NUM_JOINTS], double * const tool[JacoKinematicsBatch::FRAME_ELEMENTS])
+		{
+			double angles[NUM_JOINTS];
+			for (size_t j = 0; j < NUM_JOINTS; j++)
+				angles[j] = q[j][i];
+
+			JacoFrame frame;
+			JacoKinematics::forward(angles, frame);
+
+			for (int k = 0; k < 9; k++)
+				tool[k][i] = frame.R[k];
+			for (int k = 0; k < 3; k++)
+				tool[JacoKinematicsBatch::POSITION + k][i] = frame.p[k];
+		}
+
+#ifdef __SSE2__
+		/// \brief Two frames, one per lane.
+		struct FramePair
+		{
+			__m128d R[9];
+			__m128d p[3];
+		};
+
+		/// \brief A constant frame in both lanes.
+		struct BroadcastFrame
+		{
+			__m128d R[9];
+			__m128d p[3];
+
+			void set(const JacoFrame& frame)
+			{
+				for (int k = 0; k < 9; k++)
+					R[k] = _mm_set1_pd(frame.R[k]);
+				for (int k = 0; k < 3; k++)
+					p[k] = _mm_set1_pd(frame.p[k]);
+			}
+		};
+
+		/**
+		*  sin and cos of both lanes. The angle is reduced to [-pi/4, pi/4] by multiples of pi/2
+		*  (Cody-Waite, exact for |x| < 2^20), then the polynomials of the cephes library are
+		*  used, so the result agrees with libm to a few ulp.
+		*/
+		inline void sincos2(__m128d x, __m128d& s, __m128d& c)
+		{
+			const __m128d two_over_pi = _mm_set1_pd(0.63661977236758134308);
+			const __m128d pio2_1 = _mm_set1_pd(1.57079632673412561417e+00);
+			const __m128d pio2_2 = _mm_set1_pd(6.07710050630396597660e-11);
+			const __m128d pio2_3 = _mm_set1_pd(2.02226624879595063154e-21);
+
+			__m128i quadrant = _mm_cvtpd_epi32(_mm_mul_pd(x, two_over_pi));
+			__m128d n = _mm_cvtepi32_pd(quadrant);
+
+			__m128d r = _mm_sub_pd(x, _mm_mul_pd(n, pio2_1));
+			r = _mm_sub_pd(r, _mm_mul_pd(n, pio2_2));
+			r = _mm_sub_pd(r, _mm_mul_pd(n, pio2_3));
+			__m128d z = _mm_mul_pd(r, r);
+
+			__m128d ps = _mm_set1_pd(1.58962301576546568060E-10);
+			ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(-2.50507477628578072866E-8));
+			ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(2.75573136213857245213E-6));
+			ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(-1.98412698295895385996E-4));
+			ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(8.33333333332211858878E-3));
+			ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(-1.66666666666666307295E-1));
+			__m128d sin_r = _mm_add_pd(r, _mm_mul_pd(_mm_mul_pd(r, z), ps));
+
+			__m128d pc = _mm_set1_pd(-1.13585365213876817300E-11);
+			pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(2.08757008419747316778E-9));
+			pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(-2.75573141792967388112E-7));
+			pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(2.48015872888517045348E-5));
+			pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(-1.38888888888730564116E-3));
+			pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(4.16666666666665929218E-2));
+			__m128d cos_r = _mm_add_pd(_mm_sub_pd(_mm_set1_pd(1.0), _mm_mul_pd(_mm_set1_pd(0.5), z)), _mm_mul_pd(_mm_mul_pd(z, z), pc));
+
+			// quadrant 0: (sin r, cos r), 1: (cos r, -sin r), 2: (-sin r, -cos r), 3: (-cos r, sin r)
+			__m128i wide = _mm_shuffle_epi32(quadrant, _MM_SHUFFLE(1, 1, 0, 0));
+			__m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+			__m128d swap = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(wide, one), one));
+			__m128d sin_negative = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(wide, two), two));
+			__m128d cos_negative = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(_mm_add_epi32(wide, one), two), two));
+			__m128d sign = _mm_set1_pd(-0.0);
+
+			s = _mm_or_pd(_mm_and_pd(swap, cos_r), _mm_andnot_pd(swap, sin_r));
+			c = _mm_or_pd(_mm_and_pd(swap, sin_r), _mm_andnot_pd(swap, cos_r));
+			s = _mm_xor_pd(s, _mm_and_pd(sin_negative, sign));
+			c = _mm_xor_pd(c, _mm_and_pd(cos_negative, sign));
+		}
+
+		// out = parent * origin
+		inline void multiply(const FramePair& parent, const BroadcastFrame& origin, FramePair& out)
+		{
+			for (int row = 0; row < 3; row++)
+			{
+				const __m128d *ar = &parent.R[3*row];
+				for (int col = 0; col < 3; col++)
+					out.R[3*row + col] = _mm_add_pd(_mm_add_pd(_mm_mul_pd(ar[0], origin.R[col]), _mm_mul_pd(ar[1], origin.R[3 + col])), _mm_mul_pd(ar[2], origin.R[6 + col]));
+
+				out.p[row] = _mm_add_pd(_mm_add_pd(_mm_mul_pd(ar[0], origin.p[0]), _mm_mul_pd(ar[1], origin.p[1])),
+							_mm_add_pd(_mm_mul_pd(ar[2], origin.p[2]), parent.p[row]));
+			}
+		}
+
+		// frame = frame * Rz(angle), only the first two columns change
+		inline void rotateZ(FramePair& frame, __m128d s, __m128d c)
+		{
+			for (int row = 0; row < 3; row++)
+			{
+				__m128d x = frame.R[3*row], y = frame.R[3*row + 1];
+				frame.R[3*row]     = _mm_add_pd(_mm_mul_pd(c, x), _mm_mul_pd(s, y));
+				frame.R[3*row + 1] = _mm_sub_pd(_mm_mul_pd(c, y), _mm_mul_pd(s, x));
+			}
+		}
+#endif
+	}
+
+	void JacoKinematicsBatch::forward(size_t count, const double * const q[JacoKinematics::NUM_JOINTS], double * const tool[FRAME_ELEMENTS])
+	{
+		size_t i = 0;
+
+#ifdef __SSE2__
+		BroadcastFrame origins[NUM_JOINTS], tool_origin;
+		__m128d axes[NUM_JOINTS];
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+		{
+			JacoFrame origin;
+			double axis;
+			JacoKinematics::jointOrigin(j, origin, axis);
+			origins[j].set(origin);
+			axes[j] = _mm_set1_pd(axis);
+		}
+		JacoFrame origin;
+		JacoKinematics::toolOrigin(origin);
+		tool_origin.set(origin);
+
+		for (; i + 2 <= count; i += 2)
+		{
+			FramePair a, b;
+			__m128d s, c;
+
+			// the parent of the first joint is the base itself
+			for (int k = 0; k < 9; k++)
+				a.R[k] = origins[0].R[k];
+			for (int k = 0; k < 3; k++)
+				a.p[k] = origins[0].p[k];
+			sincos2(_mm_loadu_pd(&q[0][i]), s, c);
+			rotateZ(a, _mm_mul_pd(axes[0], s), c);
+
+			for (size_t j = 1; j < NUM_JOINTS; j++)
+			{
+				multiply(a, origins[j], b);
+				sincos2(_mm_loadu_pd(&q[j][i]), s, c);
+				rotateZ(b, _mm_mul_pd(axes[j], s), c);
+				a = b;
+			}
+
+			multiply(a, tool_origin, b);
+
+			for (int k = 0; k < 9; k++)
+				_mm_storeu_pd(&tool[k][i], b.R[k]);
+			for (int k = 0; k < 3; k++)
+				_mm_storeu_pd(&tool[POSITION + k][i], b.p[k]);
+		}
+#endif
+
+		for (; i < count; i++)
+			forwardOne(i, q, tool);
+	}
+
+	size_t JacoKinematicsBatch::inverse(size_t count, const double * const tool[FRAME_ELEMENTS], const double * const seed[JacoKinematics::NUM_JOINTS],
+					    double * const q[JacoKinematics::NUM_JOINTS], unsigned char *solution_count)
+	{
+		double solutions[JacoKinematics::MAX_IK_SOLUTIONS][JacoKinematics::NUM_JOINTS];
+		size_t reachable = 0;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			JacoFrame frame;
+			for (int k = 0; k < 9; k++)
+				frame.R[k] = tool[k][i];
+			for (int k = 0; k < 3; k++)
+				frame.p[k] = tool[POSITION + k][i];
+
+			size_t found = JacoKinematics::inverse(frame, solutions);
+			solution_count[i] = (unsigned char)found;
+			if (found == 0)
+				continue;
+			reachable++;
+
+			size_t best = 0;
+			if (seed)
+			{
+				double best_distance = 0.0;
+				for (size_t k = 0; k < found; k++)
+				{
+					// the solutions are in [-pi, pi], the seed can be any turn
+					double distance = 0.0;
+					for (size_t j = 0; j < NUM_JOINTS; j++)
+					{
+						double difference = solutions[k][j] - seed[j][i];
+						difference -= 2.0 * M_PI * floor((difference + M_PI) / (2.0 * M_PI));
+						distance += difference * difference;
+					}
+
+					if (k == 0 || distance < best_distance)
+					{
+						best = k;
+						best_distance = distance;
+					}
+				}
+			}
+
+			for (size_t j = 0; j < NUM_JOINTS; j++)
+				q[j][i] = solutions[best][j];
+		}
+
+		return reachable;
+	}
+}
@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_kinematics_plugin.cpp
+ *
+ *  PURPOSE ---  MoveIt kinematics plugin for the arm group based on JacoKinematics::inverse()
+ */
+
+#include <jaco_kinematics/jaco_kinematics_plugin.h>
+
+#include <math.h>
+#include <algorithm>
+#include <sstream>
+#include <urdf/model.h>
+#include <pluginlib/class_list_macros.h>
+
+namespace kinova
+{
+	namespace
+	{
+		const char * const BASE_FRAME = "jaco_base_link";
+		const char * const TIP_FRAME = "jaco_gripper_tool_frame";
+
+		std::string stripSlash(const std::string& frame)
+		{
+			if (!frame.empty() && frame[0] == '/')
+				return frame.substr(1);
+			return frame;
+		}
+
+		void poseToFrame(const geometry_msgs::Pose& pose, JacoFrame& frame)
+		{
+			double position[3] = { pose.position.x, pose.position.y, pose.position.z };
+			double quaternion[4] = { pose.orientation.x, pose.orientation.y, pose.orientation.z, pose.orientation.w };
+			JacoKinematics::fromQuaternion(position, quaternion, frame);
+		}
+
+		void frameToPose(const JacoFrame& frame, geometry_msgs::Pose& pose)
+		{
+			double quaternion[4];
+			JacoKinematics::toQuaternion(frame, quaternion);
+
+			pose.position.x = frame.p[0];
+			pose.position.y = frame.p[1];
+			pose.position.z = frame.p[2];
+			pose.orientation.x = quaternion[0];
+			pose.orientation.y = quaternion[1];
+			pose.orientation.z = quaternion[2];
+			pose.orientation.w = quaternion[3];
+		}
+
+		// a solution together with its distance to the seed, for sorting
+		struct Candidate
+		{
+			double distance;
+			size_t index;
+
+			bool operator<(const Candidate& other) const
+			{
+				return distance < other.distance;
+			}
+		};
+	}
+
+	JacoKinematicsPlugin::JacoKinematicsPlugin() : active_(false)
+	{
+	}
+
+	bool JacoKinematicsPlugin::initialize(const std::string& robot_description,
+					      const std::string& group_name,
+					      const std::string& base_frame,
+					      const std::string& tip_frame,
+					      double search_discretization)
+	{
+		setValues(robot_description, group_name, base_frame, tip_frame, search_discretization);
+
+		if (stripSlash(base_frame) != BASE_FRAME || stripSlash(tip_frame) != TIP_FRAME)
+		{
+			ROS_ERROR("JacoKinematicsPlugin only solves %s -> %s, not %s -> %s", BASE_FRAME, TIP_FRAME, base_frame.c_str(), tip_frame.c_str());
+			return false;
+		}
+
+		std::string xml;
+		ros::NodeHandle node_handle("~");
+		std::string description_param;
+		if (!node_handle.searchParam(robot_description, description_param) || !node_handle.getParam(description_param, xml))
+		{
+			ROS_ERROR("JacoKinematicsPlugin: could not find the parameter %s", robot_description.c_str());
+			return false;
+		}
+
+		urdf::Model model;
+		if (!model.initString(xml))
+		{
+			ROS_ERROR("JacoKinematicsPlugin: could not parse the urdf in %s", robot_description.c_str());
+			return false;
+		}
+
+		joint_names_.clear();
+		link_names_.clear();
+		continuous_.clear();
+		lower_.clear();
+		upper_.clear();
+
+		for (size_t i = 0; i < JacoKinematics::NUM_JOINTS; i++)
+		{
+			std::ostringstream name;
+			name << "jaco_joint_" << i + 1;
+
+			boost::shared_ptr<const urdf::Joint> joint = model.getJoint(name.str());
+			if (!joint)
+			{
+				ROS_ERROR("JacoKinematicsPlugin: joint %s is not in the urdf", name.str().c_str());
+				return false;
+			}
+
+			bool continuous = (joint->type == urdf::Joint::CONTINUOUS) || !joint->limits;
+			joint_names_.push_back(name.str());
+			continuous_.push_back(continuous);
+			lower_.push_back(continuous ? -M_PI : joint->limits->lower);
+			upper_.push_back(continuous ? M_PI : joint->limits->upper);
+
+			std::ostringstream link;
+			link << "jaco_link_" << i + 1;
+			link_names_.push_back(link.str());
+		}
+		link_names_.push_back(TIP_FRAME);
+
+		active_ = true;
+		return true;
+	}
+
+	const std::vector<std::string>& JacoKinematicsPlugin::getJointNames() const
+	{
+		return joint_names_;
+	}
+
+	const std::vector<std::string>& JacoKinematicsPlugin::getLinkNames() const
+	{
+		return link_names_;
+	}
+
+	bool JacoKinematicsPlugin::applyLimits(double q[JacoKinematics::NUM_JOINTS], const std::vector<double> &seed) const
+	{
+		for (size_t i = 0; i < JacoKinematics::NUM_JOINTS; i++)
+		{
+			if (continuous_[i])
+			{
+				// the turn closest to the seed
+				q[i] += 2.0 * M_PI * floor((seed[i] - q[i] + M_PI) / (2.0 * M_PI));
+				continue;
+			}
+
+			// the solver returns angles in [-pi, pi], limits can be wider
+			double best = q[i];
+			bool found = false;
+			for (int turn = -1; turn <= 1; turn++)
+			{
+				double candidate = q[i] + turn * 2.0 * M_PI;
+				if (candidate < lower_[i] || candidate > upper_[i])
+					continue;
+				if (!found || fabs(candidate - seed[i]) < fabs(best - seed[i]))
+					best = candidate;
+				found = true;
+			}
+
+			if (!found)
+				return false;
+			q[i] = best;
+		}
+		return true;
+	}
+
+	bool JacoKinematicsPlugin::solve(const geometry_msgs::Pose &ik_pose,
+					 const std::vector<double> &ik_seed_state,
+					 const std::vector<double> *consistency_limits,
+					 std::vector<double> &solution,
+					 const IKCallbackFn *solution_callback,
+					 moveit_msgs::MoveItErrorCodes &error_code) const
+	{
+		if (!active_)
+		{
+			ROS_ERROR("JacoKinematicsPlugin is not initialised");
+			error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+			return false;
+		}
+
+		if (ik_seed_state.size() != JacoKinematics::NUM_JOINTS || (consistency_limits && consistency_limits->size() != JacoKinematics::NUM_JOINTS))
+		{
+			ROS_ERROR("JacoKinematicsPlugin: seed state and consistency limits need %lu values", (unsigned long)JacoKinematics::NUM_JOINTS);
+			error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+			return false;
+		}
+
+		JacoFrame target;
+		poseToFrame(ik_pose, target);
+
+		double solutions[JacoKinematics::MAX_IK_SOLUTIONS][JacoKinematics::NUM_JOINTS];
+		size_t count = JacoKinematics::inverse(target, solutions);
+
+		Candidate candidates[JacoKinematics::MAX_IK_SOLUTIONS];
+		size_t valid = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			if (!applyLimits(solutions[i], ik_seed_state))
+				continue;
+
+			double distance = 0.0;
+			bool consistent = true;
+			for (size_t j = 0; j < JacoKinematics::NUM_JOINTS; j++)
+			{
+				double difference = fabs(solutions[i][j] - ik_seed_state[j]);
+				if (consistency_limits && difference > (*consistency_limits)[j])
+					consistent = false;
+				distance += difference * difference;
+			}
+
+			if (!consistent)
+				continue;
+
+			candidates[valid].distance = distance;
+			candidates[valid].index = i;
+			valid++;
+		}
+
+		std::sort(candidates, candidates + valid);
+
+		for (size_t i = 0; i < valid; i++)
+		{
+			const double *q = solutions[candidates[i].index];
+			solution.assign(q, q + JacoKinematics::NUM_JOINTS);
+
+			if (!solution_callback || solution_callback->empty())
+			{
+				error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+				return true;
+			}
+
+			// e.g. collision checks of the caller
+			(*solution_callback)(ik_pose, solution, error_code);
+			if (error_code.val == moveit_msgs::MoveItErrorCodes::SUCCESS)
+				return true;
+		}
+
+		error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+		return false;
+	}
+
+	bool JacoKinematicsPlugin::getPositionIK(const geometry_msgs::Pose &ik_pose,
+						 const std::vector<double> &ik_seed_state,
+						 std::vector<double> &solution,
+						 moveit_msgs::MoveItErrorCodes &error_code,
+						 const kinematics::KinematicsQueryOptions &options) const
+	{
+		return solve(ik_pose, ik_seed_state, NULL, solution, NULL, error_code);
+	}
+
+	bool JacoKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose &ik_pose,
+						    const std::vector<double> &ik_seed_state,
+						    double timeout,
+						    std::vector<double> &solution,
+						    moveit_msgs::MoveItErrorCodes &error_code,
+						    const kinematics::KinematicsQueryOptions &options) const
+	{
+		return solve(ik_pose, ik_seed_state, NULL, solution, NULL, error_code);
+	}
+
+	bool JacoKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose &ik_pose,
+						    const std::vector<double> &ik_seed_state,
+						    double timeout,
+						    const std::vector<double> &consistency_limits,
+						    std::vector<double> &solution,
+						    moveit_msgs::MoveItErrorCodes &error_code,
+						    const kinematics::KinematicsQueryOptions &options) const
+	{
+		return solve(ik_pose, ik_seed_state, &consistency_limits, solution, NULL, error_code);
+	}
+
+	bool JacoKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose &ik_pose,
+						    const std::vector<double> &ik_seed_state,
+						    double timeout,
+						    std::vector<double> &solution,
+						    const IKCallbackFn &solution_callback,
+						    moveit_msgs::MoveItErrorCodes &error_code,
+						    const kinematics::KinematicsQueryOptions &options) const
+	{
+		return solve(ik_pose, ik_seed_state, NULL, solution, &solution_callback, error_code);
+	}
+
+	bool JacoKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose &ik_pose,
+						    const std::vector<double> &ik_seed_state,
+						    double timeout,
+						    const std::vector<double> &consistency_limits,
+						    std::vector<double> &solution,
+						    const IKCallbackFn &solution_callback,
+						    moveit_msgs::MoveItErrorCodes &error_code,
+						    const kinematics::KinematicsQueryOptions &options) const
+	{
+		return solve(ik_pose, ik_seed_state, &consistency_limits, solution, &solution_callback, error_code);
+	}
+
+	bool JacoKinematicsPlugin::getPositionFK(const std::vector<std::string> &link_names,
+						 const std::vector<double> &joint_angles,
+						 std::vector<geometry_msgs::Pose> &poses) const
+	{
+		if (joint_angles.size() != JacoKinematics::NUM_JOINTS)
+			return false;
+
+		JacoFrame frames[JacoKinematics::NUM_FRAMES];
+		JacoKinematics::linkFrames(&joint_angles[0], frames);
+
+		poses.resize(link_names.size());
+		for (size_t i = 0; i < link_names.size(); i++)
+		{
+			std::vector<std::string>::const_iterator link = std::find(link_names_.begin(), link_names_.end(), stripSlash(link_names[i]));
+			if (link == link_names_.end())
+			{
+				ROS_ERROR("JacoKinematicsPlugin: no forward kinematics for link %s", link_names[i].c_str());
+				return false;
+			}
+
+			frameToPose(frames[link - link_names_.begin()], poses[i]);
+		}
+		return true;
+	}
+}
+
+PLUGINLIB_EXPORT_CLASS(kinova::JacoKinematicsPlugin, kinematics::KinematicsBase)
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- jaco_self_collision.cpp
+ *
+ *  PURPOSE ---  Self collision check of the arm with one capsule per link
+ */
+
+#include <jaco_kinematics/jaco_self_collision.h>
+
+#include <math.h>
+#include <algorithm>
+
+namespace kinova
+{
+	const size_t JacoSelfCollision::NUM_CAPSULES;
+	const size_t JacoSelfCollision::NUM_PAIRS;
+
+	namespace
+	{
+		const size_t NUM_JOINTS = JacoKinematics::NUM_JOINTS;
+
+		// the smallest capsule around the vertices of each collision mesh (with its <origin> and scale)
+		// of jaco_description/urdf/gazebo/jaco.urdf, the hand includes the fingers in both end positions
+		const JacoCapsule CAPSULES[JacoSelfCollision::NUM_CAPSULES] =
+		{
+			{ "jaco_base_link",	0, { 0.0, 0.0, 0.0 },		{ 0.0, 0.0, 0.1535 },		0.0413 },
+			{ "jaco_link_1",	1, { -0.0007, 0.0207, -0.0008 },	{ -0.0003, -0.0011, -0.1058 },	0.0448 },
+			{ "jaco_link_2",	2, { 0.0003, 0.0001, -0.0131 },	{ 0.4103, 0.0001, -0.0131 },	0.0496 },
+			{ "jaco_link_3",	3, { 0.0, 0.0005, 0.0006 },	{ 0.0, 0.1764, 0.0006 },	0.0450 },
+			{ "jaco_link_4",	4, { 0.0, 0.0009, -0.0219 },	{ 0.0001, -0.0299, 0.0149 },	0.0375 },
+			{ "jaco_link_5",	5, { -0.0004, 0.0004, -0.0217 },	{ -0.0003, -0.0304, 0.0150 },	0.0375 },
+			{ "jaco_gripper_link",	6, { 0.0, -0.0009, -0.1270 },	{ 0.0, -0.0009, -0.0349 },	0.0661 }
+		};
+
+		// every pair not adjacent and not "Never" in jaco_moveit_config/config/jaco.srdf
+		const size_t PAIRS[JacoSelfCollision::NUM_PAIRS][2] =
+		{
+			{ 0, 2 }, { 0, 3 }, { 0, 4 }, { 0, 5 }, { 0, 6 },
+			{ 1, 4 }, { 1, 5 }, { 1, 6 },
+			{ 2, 4 }, { 2, 5 }, { 2, 6 }
+		};
+
+		// a step of motionClear() shorter than this at the fastest point [m] counts as contact, which
+		// bounds the number of steps when a motion just grazes the margin without stepping past it
+		const double MIN_ADVANCEMENT = 0.001;
+		const int MAX_ADVANCEMENT_STEPS = 1000;
+
+		inline double dot(const double a[3], const double b[3])
+		{
+			return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+		}
+
+		inline double norm(const double a[3])
+		{
+			return sqrt(dot(a, a));
+		}
+
+		inline void transform(const JacoFrame& frame, const double p[3], double out[3])
+		{
+			for (int row = 0; row < 3; row++)
+				out[row] = frame.R[3*row]*p[0] + frame.R[3*row + 1]*p[1] + frame.R[3*row + 2]*p[2] + frame.p[row];
+		}
+
+		inline double clamp01(double x)
+		{
+			return std::min(1.0, std::max(0.0, x));
+		}
+
+		// distance between the segments p1 - q1 and p2 - q2 (closest points, Ericson, Real-Time Collision Detection 5.1.9)
+		double segmentDistance(const double p1[3], const double q1[3], const double p2[3], const double q2[3])
+		{
+			double d1[3], d2[3], r[3];
+			for (int k = 0; k < 3; k++)
+			{
+				d1[k] = q1[k] - p1[k];
+				d2[k] = q2[k] - p2[k];
+				r[k] = p1[k] - p2[k];
+			}
+
+			double a = dot(d1, d1), e = dot(d2, d2), f = dot(d2, r);
+			double s, t;
+			const double EPSILON = 1e-12;
+
+			if (a <= EPSILON && e <= EPSILON)
+				s = t = 0.0;
+			else if (a <= EPSILON)
+			{
+				s = 0.0;
+				t = clamp01(f / e);
+			}
+			else
+			{
+				double c = dot(d1, r);
+				if (e <= EPSILON)
+				{
+					t = 0.0;
+					s = clamp01(-c / a);
+				}
+				else
+				{
+					double b = dot(d1, d2);
+					double denominator = a*e - b*b;
+					s = (denominator > EPSILON) ? clamp01((b*f - c*e) / denominator) : 0.0;
+					t = (b*s + f) / e;
+
+					if (t < 0.0)
+					{
+						t = 0.0;
+						s = clamp01(-c / a);
+					}
+					else if (t > 1.0)
+					{
+						t = 1.0;
+						s = clamp01((b - c) / a);
+					}
+				}
+			}
+
+			double difference[3];
+			for (int k = 0; k < 3; k++)
+				difference[k] = (p1[k] + d1[k]*s) - (p2[k] + d2[k]*t);
+			return norm(difference);
+		}
+
+		// capsule endpoints in jaco_base_link
+		void placeCapsules(const double q[NUM_JOINTS], double a[][3], double b[][3])
+		{
+			JacoFrame frames[JacoKinematics::NUM_FRAMES];
+			JacoKinematics::linkFrames(q, frames);
+
+			for (size_t i = 0; i < JacoSelfCollision::NUM_CAPSULES; i++)
+			{
+				const JacoCapsule& capsule = CAPSULES[i];
+				if (capsule.frame == 0)
+				{
+					std::copy(capsule.a, capsule.a + 3, a[i]);
+					std::copy(capsule.b, capsule.b + 3, b[i]);
+				}
+				else
+				{
+					transform(frames[capsule.frame - 1], capsule.a, a[i]);
+					transform(frames[capsule.frame - 1], capsule.b, b[i]);
+				}
+			}
+		}
+
+		// surface distance of every pair
+		void pairClearances(const double q[NUM_JOINTS], double clearances[JacoSelfCollision::NUM_PAIRS])
+		{
+			double a[JacoSelfCollision::NUM_CAPSULES][3], b[JacoSelfCollision::NUM_CAPSULES][3];
+			placeCapsules(q, a, b);
+
+			for (size_t k = 0; k < JacoSelfCollision::NUM_PAIRS; k++)
+			{
+				size_t i = PAIRS[k][0], j = PAIRS[k][1];
+				clearances[k] = segmentDistance(a[i], b[i], a[j], b[j]) - CAPSULES[i].radius - CAPSULES[j].radius;
+			}
+		}
+
+		/**
+		*  LEVER[joint][capsule]: upper bound of the distance of any point of the capsule from the
+		*  axis of joint (0 based), 0 if the joint does not move it. It is the sum of the joint
+		*  offsets between the two frames plus the farthest point of the capsule in its frame.
+		*/
+		struct LeverTable
+		{
+			double lever[NUM_JOINTS][JacoSelfCollision::NUM_CAPSULES];
+
+			LeverTable()
+			{
+				double offsets[NUM_JOINTS];
+				for (size_t j = 0; j < NUM_JOINTS; j++)
+				{
+					JacoFrame origin;
+					double axis;
+					JacoKinematics::jointOrigin(j, origin, axis);
+					offsets[j] = norm(origin.p);
+				}
+
+				for (size_t i = 0; i < JacoSelfCollision::NUM_CAPSULES; i++)
+				{
+					const JacoCapsule& capsule = CAPSULES[i];
+					double extent = std::max(norm(capsule.a), norm(capsule.b)) + capsule.radius;
+
+					for (size_t j = 0; j < NUM_JOINTS; j++)
+					{
+						// joint j moves jaco_link_(j+1) and everything after it
+						if (j + 1 > capsule.frame)
+						{
+							lever[j][i] = 0.0;
+							continue;
+						}
+
+						double reach = extent;
+						for (size_t k = j + 1; k < capsule.frame; k++)
+							reach += offsets[k];
+						lever[j][i] = reach;
+					}
+				}
+			}
+		};
+
+		const LeverTable& levers()
+		{
+			static const LeverTable table;
+			return table;
+		}
+	}
+
+	const JacoCapsule& JacoSelfCollision::capsule(size_t index)
+	{
+		return CAPSULES[index];
+	}
+
+	void JacoSelfCollision::pair(size_t index, size_t& first, size_t& second)
+	{
+		first = PAIRS[index][0];
+		second = PAIRS[index][1];
+	}
+
+	double JacoSelfCollision::clearance(const double q[JacoKinematics::NUM_JOINTS], size_t *closest_pair)
+	{
+		double clearances[NUM_PAIRS];
+		pairClearances(q, clearances);
+
+		size_t closest = std::min_element(clearances, clearances + NUM_PAIRS) - clearances;
+		if (closest_pair)
+			*closest_pair = closest;
+		return clearances[closest];
+	}
+
+	bool JacoSelfCollision::motionClear(const double q0[JacoKinematics::NUM_JOINTS], const double q1[JacoKinematics::NUM_JOINTS],
+					    double margin, double *first_contact)
+	{
+		const LeverTable& table = levers();
+
+		// how fast the clearance of each pair can shrink per unit of the motion [m]
+		double rates[NUM_PAIRS], fastest = 0.0;
+		for (size_t k = 0; k < NUM_PAIRS; k++)
+		{
+			size_t fixed = CAPSULES[PAIRS[k][0]].frame, moving = PAIRS[k][1];
+			rates[k] = 0.0;
+			for (size_t j = fixed; j < NUM_JOINTS; j++)
+				rates[k] += table.lever[j][moving] * fabs(q1[j] - q0[j]);
+			fastest = std::max(fastest, rates[k]);
+		}
+
+		double s = 0.0, q[NUM_JOINTS], clearances[NUM_PAIRS];
+		for (int step = 0; step < MAX_ADVANCEMENT_STEPS; step++)
+		{
+			for (size_t j = 0; j < NUM_JOINTS; j++)
+				q[j] = q0[j] + s * (q1[j] - q0[j]);
+			pairClearances(q, clearances);
+
+			double advance = 1.0;
+			for (size_t k = 0; k < NUM_PAIRS; k++)
+			{
+				if (clearances[k] < margin)
+				{
+					if (first_contact)
+						*first_contact = s;
+					return false;
+				}
+				if (rates[k] > 0.0)
+					advance = std::min(advance, (clearances[k] - margin) / rates[k]);
+			}
+
+			if (s >= 1.0)
+				return true;
+			// never further than the clearance allows, closer than MIN_ADVANCEMENT above the margin is taken as contact
+			if (fastest > 0.0 && advance < MIN_ADVANCEMENT / fastest && s + advance < 1.0)
+			{
+				if (first_contact)
+					*first_contact = s;
+				return false;
+			}
+			s = std::min(1.0, s + advance);
+		}
+
+		// only reached if the motion hugs the margin over more than a metre
+		if (first_contact)
+			*first_contact = s;
+		return false;
+	}
+}
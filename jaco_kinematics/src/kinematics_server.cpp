@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2011  DFKI GmbH, Bremen, Germany
+ *
+ *  This file is free software: you may copy, redistribute and/or modify it
+ *  under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation, either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  This file is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *
+ *  Author: Sankaranarayanan Natarajan / sankar.natarajan@dfki.de
+ *
+ *  FILE --- kinematics_server.cpp
+ *
+ *  PURPOSE ---  Offers JacoKinematicsBatch as the services ~forward_kinematics and ~inverse_kinematics
+ */
+
+#include <vector>
+
+#include <ros/ros.h>
+#include <jaco_kinematics/jaco_kinematics_batch.h>
+#include <jaco_kinematics/BatchForwardKinematics.h>
+#include <jaco_kinematics/BatchInverseKinematics.h>
+
+using namespace kinova;
+
+namespace
+{
+	const size_t NUM_JOINTS = JacoKinematics::NUM_JOINTS;
+	const size_t FRAME_ELEMENTS = JacoKinematicsBatch::FRAME_ELEMENTS;
+
+	/// \brief Storage of frames in structure of arrays, reused between calls.
+	struct FrameArrays
+	{
+		std::vector<double> data;
+		double *rows[FRAME_ELEMENTS];
+
+		void resize(size_t count)
+		{
+			data.resize(FRAME_ELEMENTS * count);
+			for (size_t k = 0; k < FRAME_ELEMENTS; k++)
+				rows[k] = data.empty() ? NULL : &data[k * count];
+		}
+	};
+
+	// pointers to the joints of a flat joint_angles array
+	void jointRows(std::vector<double>& angles, size_t count, double *rows[NUM_JOINTS])
+	{
+		for (size_t j = 0; j < NUM_JOINTS; j++)
+			rows[j] = angles.empty() ? NULL : &angles[j * count];
+	}
+
+	FrameArrays frames;
+
+	bool forwardKinematics(jaco_kinematics::BatchForwardKinematics::Request& request, jaco_kinematics::BatchForwardKinematics::Response& response)
+	{
+		if (request.joint_angles.size() % NUM_JOINTS != 0)
+		{
+			ROS_ERROR("forward_kinematics: joint_angles needs %lu values per configuration, got %lu values",
+				  (unsigned long)NUM_JOINTS, (unsigned long)request.joint_angles.size());
+			return false;
+		}
+
+		size_t count = request.joint_angles.size() / NUM_JOINTS;
+		double *q[NUM_JOINTS];
+		jointRows(request.joint_angles, count, q);
+
+		frames.resize(count);
+		JacoKinematicsBatch::forward(count, q, frames.rows);
+
+		response.x.resize(count);	response.y.resize(count);	response.z.resize(count);
+		response.qx.resize(count);	response.qy.resize(count);	response.qz.resize(count);	response.qw.resize(count);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			JacoFrame frame;
+			for (int k = 0; k < 9; k++)
+				frame.R[k] = frames.rows[k][i];
+
+			double quaternion[4];
+			JacoKinematics::toQuaternion(frame, quaternion);
+
+			response.x[i] = frames.rows[JacoKinematicsBatch::POSITION][i];
+			response.y[i] = frames.rows[JacoKinematicsBatch::POSITION + 1][i];
+			response.z[i] = frames.rows[JacoKinematicsBatch::POSITION + 2][i];
+			response.qx[i] = quaternion[0];
+			response.qy[i] = quaternion[1];
+			response.qz[i] = quaternion[2];
+			response.qw[i] = quaternion[3];
+		}
+		return true;
+	}
+
+	bool inverseKinematics(jaco_kinematics::BatchInverseKinematics::Request& request, jaco_kinematics::BatchInverseKinematics::Response& response)
+	{
+		size_t count = request.x.size();
+		if (request.y.size() != count || request.z.size() != count || request.qx.size() != count ||
+		    request.qy.size() != count || request.qz.size() != count || request.qw.size() != count)
+		{
+			ROS_ERROR("inverse_kinematics: x, y, z, qx, qy, qz and qw need the same length");
+			return false;
+		}
+
+		if (!request.seed.empty() && request.seed.size() != NUM_JOINTS * count)
+		{
+			ROS_ERROR("inverse_kinematics: seed needs %lu values per pose or none", (unsigned long)NUM_JOINTS);
+			return false;
+		}
+
+		frames.resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			double position[3] = { request.x[i], request.y[i], request.z[i] };
+			double quaternion[4] = { request.qx[i], request.qy[i], request.qz[i], request.qw[i] };
+			JacoFrame frame;
+			JacoKinematics::fromQuaternion(position, quaternion, frame);
+
+			for (int k = 0; k < 9; k++)
+				frames.rows[k][i] = frame.R[k];
+			for (int k = 0; k < 3; k++)
+				frames.rows[JacoKinematicsBatch::POSITION + k][i] = frame.p[k];
+		}
+
+		double *seed[NUM_JOINTS], *q[NUM_JOINTS];
+		jointRows(request.seed, count, seed);
+		response.joint_angles.assign(NUM_JOINTS * count, 0.0);
+		jointRows(response.joint_angles, count, q);
+		response.solution_count.resize(count);
+
+		JacoKinematicsBatch::inverse(count, frames.rows, request.seed.empty() ? NULL : seed, q, count ? &response.solution_count[0] : NULL);
+		return true;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	ros::init(argc, argv, "jaco_kinematics_server");
+	ros::NodeHandle pn("~");
+
+	// a single spinner thread, so the buffers of FrameArrays can be shared
+	ros::ServiceServer forward_server = pn.advertiseService("forward_kinematics", forwardKinematics);
+	ros::ServiceServer inverse_server = pn.advertiseService("inverse_kinematics", inverseKinematics);
+
+	ros::spin();
+	return 0;
+}